@@ -0,0 +1,152 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+ * Benchmark for the cell interfaces of VariantArrayCellIterator
+ * Reads all the attributes of the cells in a column interval of an array through operator*() (one cell at a time,
+ * no copies) and through fill_batch() with prefetching (cells copied into batches by a background thread). Every
+ * cell is consumed by summing the bytes of its fields, so both interfaces must produce the same checksum
+ */
+
+#include <iostream>
+#include <getopt.h>
+#include "variant_storage_manager.h"
+#include "timer.h"
+
+uint64_t checksum_field(const void* ptr, const size_t num_bytes)
+{
+  auto checksum = 0ull;
+  auto bytes = reinterpret_cast<const uint8_t*>(ptr);
+  for(auto i=0ull;i<num_bytes;++i)
+    checksum += bytes[i];
+  return checksum;
+}
+
+uint64_t run_cell_iterator(VariantArrayCellIterator* iter, const unsigned num_attributes, uint64_t& num_cells)
+{
+  auto checksum = 0ull;
+  num_cells = 0ull;
+  for(;!(iter->end());++(*iter))
+  {
+    auto& cell = **iter;
+    checksum += cell.get_begin_column() + cell.get_row();
+    for(auto i=0u;i<num_attributes;++i)
+      checksum += checksum_field(cell.get_field_ptr_for_query_idx<uint8_t>(i), cell.get_field_size_in_bytes(i));
+    ++num_cells;
+  }
+  return checksum;
+}
+
+uint64_t run_batch_iterator(VariantArrayCellIterator* iter, const unsigned num_attributes, uint64_t& num_cells)
+{
+  auto checksum = 0ull;
+  num_cells = 0ull;
+  VariantCellBatch batch;
+  batch.initialize(num_attributes, -1);
+  while(iter->fill_batch(batch) > 0u)
+  {
+    for(auto j=0ull;j<batch.size();++j)
+      checksum += batch.get_columns()[j] + batch.get_rows()[j];
+    for(auto i=0u;i<num_attributes;++i)
+      checksum += checksum_field(batch.get_values(i), batch.get_offsets(i)[batch.size()]);
+    num_cells += batch.size();
+  }
+  return checksum;
+}
+
+int main(int argc, char *argv[])
+{
+  static struct option long_options[] =
+  {
+    {"batch-size",1,0,'b'},
+    {"prefetch-depth",1,0,'d'},
+    {"segment-size",1,0,'s'},
+    {0,0,0,0},
+  };
+  size_t batch_size = 1024u;
+  unsigned prefetch_depth = 2u;
+  unsigned segment_size = 10u*1024u*1024u;
+  int c;
+  while((c=getopt_long(argc, argv, "b:d:s:", long_options, NULL)) >= 0)
+  {
+    switch(c)
+    {
+      case 'b':
+        batch_size = strtoull(optarg, 0, 10);
+        break;
+      case 'd':
+        prefetch_depth = strtoul(optarg, 0, 10);
+        break;
+      case 's':
+        segment_size = strtoul(optarg, 0, 10);
+        break;
+      default:
+        std::cerr << "Unknown command line argument\n";
+        return -1;
+    }
+  }
+  if(optind + 4 > argc || batch_size == 0u || prefetch_depth == 0u)
+  {
+    std::cerr << "Usage: "<<argv[0]<<" [-b <batch_size>] [-d <prefetch_depth>] [-s <segment_size>] <workspace> <array> <column_begin> <column_end>\n";
+    return -1;
+  }
+  std::string workspace = argv[optind];
+  std::string array_name = argv[optind+1];
+  auto column_begin = strtoll(argv[optind+2], 0, 10);
+  auto column_end = strtoll(argv[optind+3], 0, 10);
+  VariantStorageManager sm(workspace, segment_size);
+  auto ad = sm.open_array(array_name, "r");
+  if(ad < 0)
+  {
+    std::cerr << "Could not open array "<<workspace<<'/'<<array_name<<"\n";
+    return -1;
+  }
+  VariantArraySchema schema;
+  sm.get_array_schema(ad, &schema);
+  std::vector<int> attribute_ids(schema.attribute_num());
+  for(auto i=0u;i<attribute_ids.size();++i)
+    attribute_ids[i] = i;
+  std::vector<int64_t> ranges = { schema.dim_domains()[0].first, schema.dim_domains()[0].second, column_begin, column_end };
+  uint64_t num_cells[2];
+  uint64_t checksums[2];
+  Timer timers[2];
+  for(auto i=0u;i<2u;++i)
+  {
+    timers[i].start();
+    auto iter = sm.begin(ad, ranges, attribute_ids);
+    if(i == 1u)
+      iter->start_prefetch(prefetch_depth, batch_size, -1);
+    checksums[i] = (i == 0u) ? run_cell_iterator(iter, attribute_ids.size(), num_cells[i])
+      : run_batch_iterator(iter, attribute_ids.size(), num_cells[i]);
+    delete iter;
+    timers[i].stop();
+  }
+  std::cerr << "#cells "<<num_cells[0]<<"\n";
+  timers[0].print("operator*", std::cerr);
+  timers[1].print("fill_batch with prefetch", std::cerr);
+  if(checksums[1] != checksums[0])
+  {
+    std::cerr << "Checksum mismatch "<<checksums[0]<<" "<<checksums[1]<<"\n";
+    return -1;
+  }
+  return 0;
+}
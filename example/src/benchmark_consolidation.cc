@@ -0,0 +1,127 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+ * Benchmark for fragment consolidation (VariantStorageManager::consolidate_array())
+ * Times a column interval query on an array with many fragments (for example, after several incremental loads),
+ * consolidates the array and times the same query again. The #variants must be the same.
+ * NOTE: the array is modified - run on a copy of the workspace if the fragments must be retained
+ */
+
+#include <iostream>
+#include <getopt.h>
+#include "query_variants.h"
+#include "timer.h"
+
+//Returns average wall-clock time per query, #variants in the last query
+double time_queries(const std::string& workspace, const std::string& array_name, const FileBasedVidMapper& vid_mapper,
+    const uint64_t begin, const uint64_t length, const unsigned num_iterations, uint64_t& num_variants)
+{
+  VariantStorageManager sm(workspace);
+  VariantQueryProcessor qp(&sm, array_name);
+  std::cerr << "#fragments "<<sm.get_num_fragments(qp.get_array_descriptor())<<"\n";
+  VariantQueryConfig query_config;
+  query_config.set_attributes_to_query(std::vector<std::string>{"REF", "ALT", "PL"});
+  query_config.add_column_interval_to_query(begin, begin+length-1ull);
+  qp.do_query_bookkeeping(qp.get_array_schema(), query_config, vid_mapper, true);
+  GTProfileStats stats;
+  VariantPool variant_pool;
+  std::vector<Variant> variants;
+  auto total_wall_clock_time = 0.0;
+  for(auto i=0u;i<num_iterations;++i)
+  {
+    variant_pool.release(variants);
+    Timer timer;
+    timer.start();
+    qp.gt_get_column_interval(qp.get_array_descriptor(), query_config, 0u, variants, 0, &stats, &variant_pool);
+    timer.stop();
+    total_wall_clock_time += timer.get_last_interval_wall_clock_time();
+  }
+  num_variants = variants.size();
+  return total_wall_clock_time/num_iterations;
+}
+
+int main(int argc, char *argv[])
+{
+  static struct option long_options[] =
+  {
+    {"vid-mapping-file",1,0,'V'},
+    {"length",1,0,'l'},
+    {"num-iterations",1,0,'n'},
+    {0,0,0,0},
+  };
+  uint64_t length = 1000000ull;
+  unsigned num_iterations = 5u;
+  std::string vid_mapping_file = "";
+  int c;
+  while((c=getopt_long(argc, argv, "V:l:n:", long_options, NULL)) >= 0)
+  {
+    switch(c)
+    {
+      case 'V':
+        vid_mapping_file = std::move(std::string(optarg));
+        break;
+      case 'l':
+        length = strtoull(optarg, 0, 10);
+        break;
+      case 'n':
+        num_iterations = strtoul(optarg, 0, 10);
+        break;
+      default:
+        std::cerr << "Unknown command line argument\n";
+        return -1;
+    }
+  }
+  if(optind + 3 > argc || vid_mapping_file.length() == 0u || length == 0ull || num_iterations == 0u)
+  {
+    std::cerr << "Usage: "<<argv[0]<<" -V <vid_mapping_file> [-l <interval_length>] [-n <num_iterations>] <workspace> <array> <begin>\n";
+    return -1;
+  }
+  std::string workspace = argv[optind];
+  std::string array_name = argv[optind+1];
+  uint64_t begin = strtoull(argv[optind+2], 0, 10);
+  FileBasedVidMapper vid_mapper(vid_mapping_file);
+  uint64_t num_variants_before = 0ull;
+  auto time_before = time_queries(workspace, array_name, vid_mapper, begin, length, num_iterations, num_variants_before);
+  Timer consolidation_timer;
+  {
+    VariantStorageManager sm(workspace);
+    consolidation_timer.start();
+    if(sm.consolidate_array(array_name) != TILEDB_OK)
+    {
+      std::cerr << "Failed to consolidate array "<<array_name<<"\n";
+      return -1;
+    }
+    consolidation_timer.stop();
+  }
+  uint64_t num_variants_after = 0ull;
+  auto time_after = time_queries(workspace, array_name, vid_mapper, begin, length, num_iterations, num_variants_after);
+  consolidation_timer.print("Consolidation", std::cerr);
+  std::cerr << "Average wall-clock time per query - before consolidation "<<time_before
+    <<" s after consolidation "<<time_after<<" s\n";
+  if(num_variants_before != num_variants_after)
+  {
+    std::cerr << "#variants mismatch - before "<<num_variants_before<<" after "<<num_variants_after<<"\n";
+    return -1;
+  }
+  return 0;
+}
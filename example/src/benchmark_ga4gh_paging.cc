@@ -0,0 +1,137 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+ * Benchmark for paged GA4GH queries (VariantQueryProcessor::gt_get_column_interval() with GA4GHPagingInfo)
+ * Pages through a large interval (default 1 Mb) with a small page size and reports the time taken by the
+ * pages at the start and the end of the interval - with the page token resuming at the last column of the
+ * previous page, both should be about the same. The total #variants is checked against an un-paged query
+ */
+
+#include <iostream>
+#include <getopt.h>
+#include "query_variants.h"
+#include "timer.h"
+
+void query(VariantQueryProcessor& qp, const VariantQueryConfig& query_config, std::vector<Variant>& variants,
+    GA4GHPagingInfo* paging_info, GTProfileStats& stats, VariantPool* variant_pool=0)
+{
+  qp.gt_get_column_interval(qp.get_array_descriptor(), query_config, 0u, variants, paging_info, &stats, variant_pool);
+}
+
+int main(int argc, char *argv[])
+{
+  static struct option long_options[] =
+  {
+    {"page-size",1,0,'p'},
+    {"vid-mapping-file",1,0,'V'},
+    {"length",1,0,'l'},
+    {0,0,0,0},
+  };
+  unsigned page_size = 10u;
+  uint64_t length = 1000000ull;
+  std::string vid_mapping_file = "";
+  int c;
+  while((c=getopt_long(argc, argv, "p:V:l:", long_options, NULL)) >= 0)
+  {
+    switch(c)
+    {
+      case 'p':
+        page_size = strtoul(optarg, 0, 10);
+        break;
+      case 'V':
+        vid_mapping_file = std::move(std::string(optarg));
+        break;
+      case 'l':
+        length = strtoull(optarg, 0, 10);
+        break;
+      default:
+        std::cerr << "Unknown command line argument\n";
+        return -1;
+    }
+  }
+  if(optind + 3 > argc || vid_mapping_file.length() == 0u || page_size == 0u || length == 0ull)
+  {
+    std::cerr << "Usage: "<<argv[0]<<" -V <vid_mapping_file> [-p <page_size>] [-l <interval_length>] <workspace> <array> <begin>\n";
+    return -1;
+  }
+  std::string workspace = argv[optind];
+  std::string array_name = argv[optind+1];
+  uint64_t begin = strtoull(argv[optind+2], 0, 10);
+  FileBasedVidMapper vid_mapper(vid_mapping_file);
+  VariantStorageManager sm(workspace);
+  VariantQueryProcessor qp(&sm, array_name);
+  VariantQueryConfig query_config;
+  query_config.set_attributes_to_query(std::vector<std::string>{"REF", "ALT", "PL"});
+  query_config.add_column_interval_to_query(begin, begin+length-1ull);
+  qp.do_query_bookkeeping(qp.get_array_schema(), query_config, vid_mapper, true);
+  GTProfileStats stats;
+  //Un-paged query
+  std::vector<Variant> variants;
+  Timer unpaged_timer;
+  unpaged_timer.start();
+  query(qp, query_config, variants, 0, stats);
+  unpaged_timer.stop();
+  auto num_unpaged_variants = variants.size();
+  //Paged query - time per page is recorded
+  GA4GHPagingInfo paging_info;
+  paging_info.set_page_size(page_size);
+  //Pages are handed back to the pool - allocations should be (almost) 0 after the first few pages
+  VariantPool variant_pool;
+  variants.clear();
+  std::vector<double> page_times;
+  uint64_t num_paged_variants = 0ull;
+  Timer paged_timer;
+  paged_timer.start();
+  do
+  {
+    variant_pool.release(variants);
+    Timer page_timer;
+    page_timer.start();
+    query(qp, query_config, variants, &paging_info, stats, &variant_pool);
+    page_timer.stop();
+    page_times.push_back(page_timer.get_last_interval_wall_clock_time());
+    num_paged_variants += variants.size();
+  } while(!paging_info.is_query_completed());
+  paged_timer.stop();
+  unpaged_timer.print("Un-paged query", std::cerr);
+  paged_timer.print("Paged query", std::cerr);
+  variant_pool.print_stats(std::cerr);
+  //Average time of the first and last 10% pages
+  auto num_pages_in_sample = std::max<size_t>(1u, page_times.size()/10u);
+  auto first_pages_time = 0.0;
+  auto last_pages_time = 0.0;
+  for(auto i=0ull;i<num_pages_in_sample;++i)
+  {
+    first_pages_time += page_times[i];
+    last_pages_time += page_times[page_times.size()-1u-i];
+  }
+  std::cerr << "#pages "<<page_times.size()<<" page size "<<page_size
+    <<" average wall-clock time per page - first 10% "<<first_pages_time/num_pages_in_sample
+    <<" s last 10% "<<last_pages_time/num_pages_in_sample<<" s\n";
+  if(num_paged_variants != num_unpaged_variants)
+  {
+    std::cerr << "#variants mismatch - paged "<<num_paged_variants<<" un-paged "<<num_unpaged_variants<<"\n";
+    return -1;
+  }
+  return 0;
+}
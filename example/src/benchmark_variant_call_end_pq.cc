@@ -0,0 +1,193 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+ * Microbenchmark for the overlapping cell path in VariantQueryProcessor::scan_handle_cell()
+ * Simulates a deletion-dense region - at every position, a fraction of the rows have a new cell that
+ * overlaps the (long) deletion currently in the END priority queue. The call has to be removed from
+ * the queue and re-inserted with the new END.
+ * Compares the old drain-and-refill over std::priority_queue with VariantCallEndPQ::remove()
+ */
+
+#include <iostream>
+#include <queue>
+#include <random>
+#include <getopt.h>
+#include "variant.h"
+#include "timer.h"
+
+struct EndCmpVariantCallStruct
+{
+  bool operator()(const VariantCall* x, const VariantCall* y) { return x->get_column_end() > y->get_column_end(); }
+};
+typedef std::priority_queue<VariantCall*, std::vector<VariantCall*>, EndCmpVariantCallStruct> StdVariantCallEndPQ;
+
+//Cells - <column, row, END>
+typedef std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> SimulatedCells;
+
+void generate_cells(SimulatedCells& cells, const uint64_t num_rows, const uint64_t num_positions,
+    const double overlap_fraction, const uint64_t max_deletion_length)
+{
+  std::mt19937_64 generator(0ull);
+  std::uniform_real_distribution<double> fraction_distribution(0.0, 1.0);
+  std::uniform_int_distribution<uint64_t> length_distribution(1ull, max_deletion_length);
+  std::vector<uint64_t> curr_END(num_rows, 0ull);
+  for(auto column=0ull;column<num_positions;++column)
+    for(auto row=0ull;row<num_rows;++row)
+    {
+      //Row has no interval at this column or a new cell overlaps the current interval
+      if(curr_END[row] < column || (column == 0ull) || fraction_distribution(generator) < overlap_fraction)
+      {
+        curr_END[row] = column + length_distribution(generator);
+        cells.emplace_back(column, row, curr_END[row]);
+      }
+    }
+}
+
+uint64_t run_std_pq(const SimulatedCells& cells, std::vector<VariantCall>& calls)
+{
+  StdVariantCallEndPQ end_pq;
+  std::vector<VariantCall*> tmp_pq_buffer(calls.size());
+  uint64_t checksum = 0ull;
+  for(const auto& cell : cells)
+  {
+    auto column = std::get<0>(cell);
+    auto& curr_call = calls[std::get<1>(cell)];
+    //Intervals that ended before this column
+    while(!end_pq.empty() && end_pq.top()->get_column_end() < column)
+    {
+      checksum += end_pq.top()->get_column_end();
+      end_pq.top()->mark_valid(false);
+      end_pq.pop();
+    }
+    if(curr_call.is_valid())
+    {
+      //Cycle through priority queue and remove this call
+      auto num_entries_in_tmp_pq_buffer = 0ull;
+      while(!end_pq.empty())
+      {
+        auto top_call = end_pq.top();
+        end_pq.pop();
+        if(top_call == &curr_call)
+          break;
+        tmp_pq_buffer[num_entries_in_tmp_pq_buffer++] = top_call;
+      }
+      for(auto i=0ull;i<num_entries_in_tmp_pq_buffer;++i)
+        end_pq.push(tmp_pq_buffer[i]);
+    }
+    curr_call.set_column_interval(column, std::get<2>(cell));
+    curr_call.mark_valid(true);
+    end_pq.push(&curr_call);
+  }
+  for(;!end_pq.empty();end_pq.pop())
+    checksum += end_pq.top()->get_column_end();
+  return checksum;
+}
+
+uint64_t run_indexed_pq(const SimulatedCells& cells, std::vector<VariantCall>& calls)
+{
+  VariantCallEndPQ end_pq;
+  uint64_t checksum = 0ull;
+  for(const auto& cell : cells)
+  {
+    auto column = std::get<0>(cell);
+    auto call_idx = std::get<1>(cell);
+    auto& curr_call = calls[call_idx];
+    //Intervals that ended before this column
+    while(!end_pq.empty() && end_pq.top()->get_column_end() < column)
+    {
+      checksum += end_pq.top()->get_column_end();
+      end_pq.top()->mark_valid(false);
+      end_pq.pop();
+    }
+    if(curr_call.is_valid())
+      end_pq.remove(call_idx);
+    curr_call.set_column_interval(column, std::get<2>(cell));
+    curr_call.mark_valid(true);
+    end_pq.push(&curr_call, call_idx);
+  }
+  for(;!end_pq.empty();end_pq.pop())
+    checksum += end_pq.top()->get_column_end();
+  return checksum;
+}
+
+int main(int argc, char *argv[])
+{
+  static struct option long_options[] =
+  {
+    {"num-rows",1,0,'r'},
+    {"num-positions",1,0,'n'},
+    {"overlap-fraction",1,0,'f'},
+    {"max-deletion-length",1,0,'l'},
+    {0,0,0,0},
+  };
+  uint64_t num_rows = 5000ull;
+  uint64_t num_positions = 50ull;
+  double overlap_fraction = 0.1;
+  uint64_t max_deletion_length = 1000ull;
+  int c;
+  while((c=getopt_long(argc, argv, "r:n:f:l:", long_options, NULL)) >= 0)
+  {
+    switch(c)
+    {
+      case 'r':
+        num_rows = strtoull(optarg, 0, 10);
+        break;
+      case 'n':
+        num_positions = strtoull(optarg, 0, 10);
+        break;
+      case 'f':
+        overlap_fraction = strtod(optarg, 0);
+        break;
+      case 'l':
+        max_deletion_length = strtoull(optarg, 0, 10);
+        break;
+      default:
+        std::cerr << "Usage: "<<argv[0]<<" [-r <num_rows>] [-n <num_positions>] [-f <overlap_fraction>] [-l <max_deletion_length>]\n";
+        return -1;
+    }
+  }
+  SimulatedCells cells;
+  generate_cells(cells, num_rows, num_positions, overlap_fraction, max_deletion_length);
+  std::cerr << "#rows "<<num_rows<<" #positions "<<num_positions<<" #cells "<<cells.size()<<"\n";
+  std::vector<VariantCall> calls;
+  for(auto i=0ull;i<num_rows;++i)
+    calls.emplace_back(VariantCall(i));
+  Timer std_pq_timer;
+  std_pq_timer.start();
+  auto std_pq_checksum = run_std_pq(cells, calls);
+  std_pq_timer.stop();
+  for(auto& call : calls)
+    call.mark_valid(false);
+  Timer indexed_pq_timer;
+  indexed_pq_timer.start();
+  auto indexed_pq_checksum = run_indexed_pq(cells, calls);
+  indexed_pq_timer.stop();
+  std_pq_timer.print("std::priority_queue drain and refill", std::cerr);
+  indexed_pq_timer.print("VariantCallEndPQ remove", std::cerr);
+  if(std_pq_checksum != indexed_pq_checksum)
+  {
+    std::cerr << "Checksum mismatch "<<std_pq_checksum<<" "<<indexed_pq_checksum<<"\n";
+    return -1;
+  }
+  return 0;
+}
@@ -25,6 +25,26 @@
 #include "genomicsdb_bcf_generator.h"
 #include <mpi.h>
 
+/*
+ * Writes VCF text to stdout - header lines are dropped while skip_header is set (the stream resumed from
+ * a checkpoint starts with the header again)
+ */
+static void write_vcf_text(const uint8_t* data, const size_t num_bytes, bool& skip_header, bool& at_line_begin)
+{
+  auto i = 0ull;
+  for(;skip_header && i<num_bytes;++i)
+  {
+    if(at_line_begin && data[i] != '#')
+    {
+      skip_header = false;
+      break;
+    }
+    at_line_begin = (data[i] == '\n');
+  }
+  if(i < num_bytes)
+    fwrite(data+i, 1u, num_bytes-i, stdout);
+}
+
 int main(int argc, char *argv[]) {
   //Initialize MPI environment
   auto rc = MPI_Init(0, 0);
@@ -43,6 +63,7 @@ int main(int argc, char *argv[]) {
     {"output-format",1,0,'O'},
     {"json-config",1,0,'j'},
     {"loader-json-config",1,0,'l'},
+    {"checkpoint-every-page",0,0,'c'},
     {0,0,0,0},
   };
   int c;
@@ -50,10 +71,14 @@ int main(int argc, char *argv[]) {
   std::string output_format = "";
   std::string json_config_file = "";
   std::string loader_json_config_file = "";
-  while((c=getopt_long(argc, argv, "j:l:p:r:O:", long_options, NULL)) >= 0)
+  auto checkpoint_every_page = false;
+  while((c=getopt_long(argc, argv, "j:l:p:r:O:c", long_options, NULL)) >= 0)
   {
     switch(c)
     {
+      case 'c':
+        checkpoint_every_page = true;
+        break;
       case 'p':
         page_size = strtoull(optarg, 0, 10);
         break;
@@ -76,14 +101,39 @@ int main(int argc, char *argv[]) {
   }
   std::vector<uint8_t> buffer(page_size > 0u ? page_size : 100u); 
   assert(json_config_file.length() > 0u && loader_json_config_file.length() > 0u);
-  GenomicsDBBCFGenerator bcf_reader(loader_json_config_file, json_config_file, my_world_mpi_rank, page_size, std::max<size_t>(page_size, 1024u),
-      output_format.c_str());
-  while(!(bcf_reader.end()))
+  //Headers of resumed streams are skipped in the text output
+  if(checkpoint_every_page && !(output_format.empty() || output_format[0] == 'v'))
+  {
+    std::cerr << "Checkpointing is tested only with VCF text output\n";
+    exit(-1);
+  }
+  auto bcf_reader = new GenomicsDBBCFGenerator(loader_json_config_file, json_config_file, "", 0, 0, my_world_mpi_rank,
+      page_size, std::max<size_t>(page_size, 1024u), output_format.c_str());
+  std::vector<uint8_t> checkpoint;
+  auto skip_header = false;
+  auto at_line_begin = true;
+  while(!(bcf_reader->end()))
   {
-    auto num_bytes_read = bcf_reader.read_and_advance(&(buffer[0]), 0u, buffer.size());
+    auto num_bytes_read = bcf_reader->read_and_advance(&(buffer[0]), 0u, buffer.size());
     if(num_bytes_read > 0u)
-      fwrite(&(buffer[0]), 1u, num_bytes_read, stdout);
+      write_vcf_text(&(buffer[0]), num_bytes_read, skip_header, at_line_begin);
+    //Stop and resume from a checkpoint - the output must be the same as that of an uninterrupted stream
+    if(checkpoint_every_page && !(bcf_reader->end()))
+    {
+      //The checkpoint is taken after the bytes produced but not read yet
+      auto& read_batch = bcf_reader->get_read_batch();
+      if(read_batch.get_num_remaining_bytes() > 0u)
+        write_vcf_text(read_batch.get_pointer_at_read_position(), read_batch.get_num_remaining_bytes(),
+            skip_header, at_line_begin);
+      bcf_reader->get_checkpoint(checkpoint);
+      delete bcf_reader;
+      bcf_reader = new GenomicsDBBCFGenerator(loader_json_config_file, json_config_file, "", 0, 0, my_world_mpi_rank,
+          page_size, std::max<size_t>(page_size, 1024u), output_format.c_str(), false, true, &checkpoint);
+      skip_header = true;
+      at_line_begin = true;
+    }
   }
+  delete bcf_reader;
   MPI_Finalize();
   return 0;
 }
@@ -0,0 +1,143 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+ * Test for the query result cache (VariantQueryResultCache)
+ * Queries a column interval twice through the same VariantQueryProcessor (miss, then hit with the same
+ * Variants), loads more data into the array with the loader JSON passed through -l and queries again - the
+ * cached result must not be returned and the Variants must match those of a query without the cache.
+ * NOTE: the array is modified by the load
+ */
+
+#include <iostream>
+#include <getopt.h>
+#include "query_variants.h"
+#include "tiledb_loader.h"
+
+#define RESULT_CACHE_SIZE (64ull*1024ull*1024ull)
+
+//Returns serialized Variants of the first column interval in query_config
+std::vector<uint8_t> query_and_serialize(const VariantQueryProcessor& qp, const VariantQueryConfig& query_config)
+{
+  GTProfileStats stats;
+  std::vector<Variant> variants;
+  qp.gt_get_column_interval(qp.get_array_descriptor(), query_config, 0u, variants, 0, &stats);
+  std::vector<uint8_t> buffer;
+  uint64_t offset = 0ull;
+  for(const auto& variant : variants)
+    variant.binary_serialize(buffer, offset);
+  buffer.resize(offset);
+  return buffer;
+}
+
+bool check_cache_stats(const VariantQueryProcessor& qp, const uint64_t num_hits, const uint64_t num_misses,
+    const std::string& step)
+{
+  const auto& cache = qp.get_result_cache();
+  if(cache.get_num_hits() == num_hits && cache.get_num_misses() == num_misses)
+    return true;
+  std::cerr << step << ": expected "<<num_hits<<" hits and "<<num_misses<<" misses, got "
+    << cache.get_num_hits() << " hits and " << cache.get_num_misses() << " misses\n";
+  return false;
+}
+
+int main(int argc, char *argv[])
+{
+  static struct option long_options[] =
+  {
+    {"vid-mapping-file",1,0,'V'},
+    {"loader-json-config",1,0,'l'},
+    {0,0,0,0},
+  };
+  std::string vid_mapping_file = "";
+  std::string loader_json_config_file = "";
+  int c;
+  while((c=getopt_long(argc, argv, "V:l:", long_options, NULL)) >= 0)
+  {
+    switch(c)
+    {
+      case 'V':
+        vid_mapping_file = std::move(std::string(optarg));
+        break;
+      case 'l':
+        loader_json_config_file = std::move(std::string(optarg));
+        break;
+      default:
+        std::cerr << "Unknown command line argument\n";
+        return -1;
+    }
+  }
+  if(optind + 4 > argc || vid_mapping_file.length() == 0u || loader_json_config_file.length() == 0u)
+  {
+    std::cerr << "Usage: "<<argv[0]<<" -V <vid_mapping_file> -l <loader_json_config_file> <workspace> <array> <begin> <end>\n";
+    return -1;
+  }
+  std::string workspace = argv[optind];
+  std::string array_name = argv[optind+1];
+  uint64_t begin = strtoull(argv[optind+2], 0, 10);
+  uint64_t end = strtoull(argv[optind+3], 0, 10);
+  FileBasedVidMapper vid_mapper(vid_mapping_file);
+  VariantQueryConfig query_config;
+  query_config.set_attributes_to_query(std::vector<std::string>{"REF", "ALT", "GT", "PL"});
+  query_config.add_column_interval_to_query(begin, end);
+  query_config.set_result_cache_size(RESULT_CACHE_SIZE);
+  VariantStorageManager sm(workspace);
+  VariantQueryProcessor qp(&sm, array_name);
+  qp.do_query_bookkeeping(qp.get_array_schema(), query_config, vid_mapper, true);
+  auto before_load = query_and_serialize(qp, query_config);
+  if(!check_cache_stats(qp, 0u, 1u, "First query"))
+    return -1;
+  if(query_and_serialize(qp, query_config) != before_load)
+  {
+    std::cerr << "Variants served from the cache differ from the queried Variants\n";
+    return -1;
+  }
+  if(!check_cache_stats(qp, 1u, 1u, "Repeated query"))
+    return -1;
+#ifdef HTSDIR
+  {
+    VCF2TileDBLoader loader(loader_json_config_file, 0);
+    loader.read_all();
+  }
+#endif
+  auto after_load = query_and_serialize(qp, query_config);
+  if(!check_cache_stats(qp, 1u, 2u, "Query after load"))
+    return -1;
+  //Reference - new processor, no cache
+  VariantStorageManager reference_sm(workspace);
+  VariantQueryProcessor reference_qp(&reference_sm, array_name);
+  VariantQueryConfig reference_query_config;
+  reference_query_config.set_attributes_to_query(std::vector<std::string>{"REF", "ALT", "GT", "PL"});
+  reference_query_config.add_column_interval_to_query(begin, end);
+  reference_qp.do_query_bookkeeping(reference_qp.get_array_schema(), reference_query_config, vid_mapper, true);
+  if(after_load != query_and_serialize(reference_qp, reference_query_config))
+  {
+    std::cerr << "Variants after the load differ from those of a query without the cache\n";
+    return -1;
+  }
+  if(after_load == before_load)
+  {
+    std::cerr << "The load did not change the Variants in ["<<begin<<", "<<end<<"] - cache invalidation is not tested\n";
+    return -1;
+  }
+  return 0;
+}
@@ -30,7 +30,16 @@
 #include "variant.h"
 #include "variant_operations.h"
 #include "variant_cell.h"
+#include "variant_query_result_cache.h"
+#include "variant_pool.h"
 #include "vid_mapper.h"
+#include "histogram.h"
+#include <mutex>
+
+//Resolution of the cell count histogram used by VariantQueryProcessor::balance_column_intervals()
+#define DEFAULT_BALANCE_COLUMN_INTERVALS_NUM_BINS_PER_PART 1024u
+//Max #bytes of out-of-order output held by a thread in VariantQueryProcessor::scan_and_operate_parallel()
+#define DEFAULT_MAX_PARKED_BYTES_PER_THREAD (64ull*1024ull*1024ull)
 
 enum GTSchemaVersionEnum
 {
@@ -74,6 +83,9 @@ class GTProfileStats {
       GT_NUM_ATTR_CELLS_ACCESSED,//#attribute cells accessed in the query
       GT_NUM_PQ_FLUSHES_DUE_TO_OVERLAPPING_CELLS,//#times PQ gets flushed due to overlapping cells in the input
       GT_NUM_OPERATOR_INVOCATIONS, //#times operator gets invoked
+      GT_NUM_CELLS_REJECTED_BY_FILTER, //#cells dropped by the per-call filter before any field is decoded
+      GT_NUM_VARIANT_ALLOCATIONS, //#Variant objects allocated by interval queries (not obtained from a VariantPool)
+      GT_NUM_VARIANT_CALL_ALLOCATIONS, //#VariantCall objects allocated by interval queries
       GT_NUM_STATS
     };
     GTProfileStats();
@@ -151,11 +163,16 @@ class VariantQueryProcessorScanState
       invalidate();
       m_done = false;
       m_num_calls_with_deletions = 0;
+      m_end_pq.clear();
+      m_variant.disable_active_calls_tracking();
+      m_variant.reset_for_new_interval();
     }
     void invalidate()
     {
       m_iter = 0;
       m_current_start_position = -1ll;
+      m_cell_batch.clear();
+      m_cell_batch_idx = 0ull;
     }
     /*
      * Set state
@@ -168,8 +185,15 @@ class VariantQueryProcessorScanState
     }
     VariantCallEndPQ& get_end_pq() { return m_end_pq; }
     Variant& get_variant() { return m_variant; }
+    VariantCellBatch& get_cell_batch() { return m_cell_batch; }
+    uint64_t& get_cell_batch_idx() { return m_cell_batch_idx; }
     uint64_t get_num_calls_with_deletions() const { return m_num_calls_with_deletions; }
     /*void set_num_calls_with_deletions(const uint64_t val) { m_num_calls_with_deletions = val; }*/
+    /*
+     * True if a scan stopped due to a full buffer and will continue in the next call to scan_and_operate()
+     * m_iter may be NULL if the array had no more cells (restored from a checkpoint)
+     */
+    bool in_progress() const { return m_current_start_position >= 0; }
   private:
     bool m_done;
     VariantArrayCellIterator* m_iter;
@@ -177,6 +201,9 @@ class VariantQueryProcessorScanState
     uint64_t m_num_calls_with_deletions;
     VariantCallEndPQ m_end_pq;
     Variant m_variant;
+    //Cells fetched from m_iter, but not yet processed - used when cells are fetched in batches
+    VariantCellBatch m_cell_batch;
+    uint64_t m_cell_batch_idx;
     GTProfileStats m_stats;
 };
 
@@ -192,6 +219,14 @@ class VariantQueryProcessor {
      * with.
      */
     VariantQueryProcessor(VariantStorageManager* storage_manager, const std::string& array_name);
+    /*
+     * Query over a set of arrays with the same schema - the column or row partitions of a workspace. All the
+     * arrays are opened and queries with get_array_descriptor() read the cells of all the partitions, merged in
+     * column major order. A single process can then scan the whole genome (column partitions) or produce
+     * one Variant per position over all the samples (row partitions). With
+     * VariantQueryConfig::scan_partitions_in_threads(), every partition is scanned on its own thread
+     */
+    VariantQueryProcessor(VariantStorageManager* storage_manager, const std::vector<std::string>& array_names);
     /*
      * This constructor is useful when there is no VariantStorageManager. This happens when loading and querying are 
      * combined and the data does not exist on disk as TileDB arrays
@@ -211,24 +246,83 @@ class VariantQueryProcessor {
         VariantQueryConfig& query_config, const VidMapper& vid_mapper, const bool require_alleles) const;
     /*
      * Equivalent of gt_get_column, but for interval
+     * If variant_pool is non-NULL, Variant and VariantCall objects are obtained from it - callers that issue many
+     * queries should hand the variants back to the pool once they are done with them
      */
     void gt_get_column_interval(
         const int ad,
         const VariantQueryConfig& query_config, unsigned column_interval_idx,
-        std::vector<Variant>& variants, GA4GHPagingInfo* paging_info=0, GTProfileStats* stats=0) const;
+        std::vector<Variant>& variants, GA4GHPagingInfo* paging_info=0, GTProfileStats* stats=0,
+        VariantPool* variant_pool=0) const;
     /*
      * Scans column interval, aligns intervals and runs operate
      */
     void scan_and_operate(const int ad, const VariantQueryConfig& query_config,
         SingleVariantOperatorBase& variant_operator,
         unsigned column_interval_idx=0u, bool handle_spanning_deletions=false, VariantQueryProcessorScanState* scan_state=0) const;
+    /*
+     * Scans column intervals [begin_column_interval_idx, end_column_interval_idx) using multiple threads. Each
+     * interval is scanned with its own iterator and Variant object.
+     * #threads == variant_operators.size(). Thread i uses variant_operators[i] which must write its output to
+     * output_buffers[i]. The contents of the buffers are passed to output_writer in column interval order, so
+     * the output is identical to calling scan_and_operate() for each interval in sequence.
+     * Output of an interval that can't be written yet is held in memory - a thread that would hold more than
+     * max_parked_bytes_per_thread bytes waits till all previous intervals are written
+     */
+    void scan_and_operate_parallel(const int ad, const VariantQueryConfig& query_config,
+        const std::vector<SingleVariantOperatorBase*>& variant_operators, const std::vector<RWBuffer*>& output_buffers,
+        ScanOutputWriterBase& output_writer,
+        const unsigned begin_column_interval_idx, const unsigned end_column_interval_idx,
+        bool handle_spanning_deletions=false,
+        const size_t max_parked_bytes_per_thread=DEFAULT_MAX_PARKED_BYTES_PER_THREAD) const;
+    /*
+     * Splits column interval column_interval_idx into at most num_splits sub-intervals (appended to sub_intervals)
+     * so that a single large interval can be scanned by multiple threads. Split points are placed only at
+     * columns where some cell begins. scan_and_operate() starts a new gVCF interval at such columns anyway and the
+     * calls spanning the split point are rebuilt by the left sweep (gt_get_column()) at the start of the next
+     * sub-interval - hence, scanning the sub-intervals one after the other produces the same output as scanning
+     * the whole interval
+     */
+    void split_column_interval(const int ad, const VariantQueryConfig& query_config,
+        const unsigned column_interval_idx, const unsigned num_splits, std::vector<ColumnRange>& sub_intervals) const;
+    /*
+     * split_query_config is a copy of query_config, with every column interval replaced by its sub-intervals.
+     * If query_config.balance_column_intervals() is set, the intervals are instead split into num_splits pieces
+     * with roughly the same number of cells by balance_column_intervals()
+     */
+    void split_column_intervals(const int ad, const VariantQueryConfig& query_config,
+        const unsigned num_splits, VariantQueryConfig& split_query_config) const;
+    /*
+     * Cost based planner - splits the (sorted) column intervals of query_config into num_parts contiguous pieces
+     * with roughly the same number of cells, so that MPI ranks or threads scanning different pieces do similar
+     * amounts of work. The #cells beginning in each part of the queried columns is estimated using a
+     * UniformHistogram over the queried columns - filled from the sidecar tile index if the array has one, else by
+     * counting cells in a scan of the intervals. As in split_column_interval(), intervals are split only at
+     * columns where some cell begins. parts[i] holds the column ranges of the i-th piece - some pieces may be
+     * empty if the array has too few cells
+     */
+    void balance_column_intervals(const int ad, const VariantQueryConfig& query_config, const unsigned num_parts,
+        std::vector<std::vector<ColumnRange>>& parts) const;
+    /*
+     * Same as above, with the #cells taken from histogram - filled by fill_cell_count_histogram()
+     */
+    void balance_column_intervals(const int ad, const VariantQueryConfig& query_config, const UniformHistogram& histogram,
+        const unsigned num_parts, std::vector<std::vector<ColumnRange>>& parts) const;
+    /*
+     * Counts the cells beginning in the queried columns. The columns of the (sorted) column intervals are laid out
+     * one interval after the other, so histogram must span [0, query_config.get_num_queried_columns()). Only the
+     * queried columns in [begin_offset, end_offset) are counted - MPI ranks can count disjoint pieces and sum up
+     * their histograms. Cells are estimated from the sidecar tile index if the array has one, else counted in a scan
+     */
+    void fill_cell_count_histogram(const int ad, const VariantQueryConfig& query_config, UniformHistogram& histogram,
+        const uint64_t begin_offset=0ull, const uint64_t end_offset=UINT64_MAX) const;
     /*
      * Deal with next cell in forward iteration in a scan
      * */
     bool scan_handle_cell(const VariantQueryConfig& query_config, unsigned column_interval_idx,
         Variant& variant, SingleVariantOperatorBase& variant_operator,
         const BufferVariantCell& cell,
-        VariantCallEndPQ& end_pq, std::vector<VariantCall*>& tmp_pq_buffer,
+        VariantCallEndPQ& end_pq,
         int64_t& current_start_position, int64_t& next_start_position,
         uint64_t& num_calls_with_deletions, bool handle_spanning_deletions,
         GTProfileStats* stats_ptr) const;
@@ -256,6 +350,21 @@ class VariantQueryProcessor {
      */
     void binary_deserialize(Variant& variant, const VariantQueryConfig& query_config,
         const std::vector<uint8_t>& buffer, uint64_t& offset) const;
+    void binary_deserialize(VariantCall& call, const VariantQueryConfig& query_config,
+        const std::vector<uint8_t>& buffer, uint64_t& offset) const;
+    /*
+     * Checkpoint of a scan that returned because the operator's buffer was full (see scan_and_operate()) - the
+     * current start position, the calls in the END PQ with their fields, the #calls with deletions and the
+     * position of the iterator expressed as a column. Appended to buffer at offset
+     */
+    void checkpoint_scan_state(VariantQueryProcessorScanState& scan_state,
+        std::vector<uint8_t>& buffer, uint64_t& offset) const;
+    /*
+     * Rebuilds scan_state from a checkpoint - scan_and_operate() with the same query_config and column interval
+     * resumes the scan from the checkpoint. The iterator is re-created at the checkpointed column
+     */
+    void restore_scan_state(const int ad, const VariantQueryConfig& query_config, const unsigned column_interval_idx,
+        const std::vector<uint8_t>& buffer, uint64_t& offset, VariantQueryProcessorScanState& scan_state) const;
     /*
      * Function that, given an enum value from KnownVariantFieldsEnum
      * returns the schema idx for the given array 
@@ -268,6 +377,11 @@ class VariantQueryProcessor {
       return m_schema_idx_to_known_variant_field_enum_LUT.get_schema_idx_for_known_field_enum(enumIdx);
     } 
     int get_array_descriptor() const { return m_ad; }
+    /*
+     * Descriptors of the arrays read through get_array_descriptor() - a single array unless the processor was
+     * created over multiple partitions
+     */
+    const std::vector<int>& get_partition_array_descriptors() const { return m_partition_ads; }
     const VariantArraySchema& get_array_schema() const { return *m_array_schema; }
     /**
      * A function that obtains cell attribute idxs for queried attribute names in the queryConfig object
@@ -277,6 +391,17 @@ class VariantQueryProcessor {
      * Return VariantStorageManager object
      */
     const VariantStorageManager* get_storage_manager() const { return m_storage_manager; }
+    /*
+     * Sidecar tile index of the array, 0 if not available
+     */
+    const VariantArrayTileIndex* get_tile_index(const int ad) const
+    {
+      return (m_storage_manager && !is_merged_array_descriptor(ad)) ? m_storage_manager->get_tile_index(ad) : 0;
+    }
+    /*
+     * Cache of gt_get_column_interval() results - enabled by VariantQueryConfig::set_result_cache_size()
+     */
+    const VariantQueryResultCache& get_result_cache() const { return m_result_cache; }
   private:
     /*initialize all known info about variants*/
     void initialize_known(const VariantArraySchema& array_schema);
@@ -292,6 +417,22 @@ class VariantQueryProcessor {
     void register_field_creators(const VariantArraySchema& array_schema);
     /*Wrapper for initialize functions - assumes m_array_schema is initialized correctly*/
     void initialize();
+    /*
+     * True if ad refers to the merged partitions - the sidecar tile indexes of the partitions are not merged
+     */
+    inline bool is_merged_array_descriptor(const int ad) const
+    {
+      return (ad == m_ad && m_partition_ads.size() > 1u);
+    }
+    /*
+     * Queries read every fragment of an array - prints a warning for arrays which should be consolidated.
+     * Every array is checked once per process
+     */
+    void warn_if_many_fragments() const;
+    /*
+     * Max interval length over the arrays read through ad, -1 if unknown for any of them
+     */
+    int64_t get_max_interval_length(const int ad) const;
     /**
      * Initialized field length info
      */
@@ -310,12 +451,35 @@ class VariantQueryProcessor {
         ) const;
     /** 
      * Initializes forward iterators for joint genotyping for column col. 
+     * The iterator is over cells with co-ordinates in [column, end_column]
+     * If planning_schema_idxs is specified, only those attributes (query idx i of the cells is
+     * (*planning_schema_idxs)[i]) and the co-ordinates are read - for scans that plan queries
      * Returns the number of attributes used in joint genotyping.
      */
     unsigned int gt_initialize_forward_iter(
         const int ad,
         const VariantQueryConfig& query_config, const int64_t column,
-        VariantArrayCellIterator*& forward_iter) const;
+        VariantArrayCellIterator*& forward_iter, const int64_t end_column=INT64_MAX,
+        const std::vector<int>* planning_schema_idxs=0) const;
+    /*
+     * Starts reading ahead batches of cell_batch_size cells in the background if prefetch is enabled
+     * in query_config - forward_iter must then be consumed only through fill_batch()
+     */
+    void gt_start_prefetch(const VariantQueryConfig& query_config, VariantArrayCellIterator* forward_iter,
+        const size_t cell_batch_size) const;
+    /*
+     * End column for the forward iterator of a scan over the column interval - the prefetch thread reads ahead
+     * prefetch_depth batches, so with prefetching the iterator must stop at the end of the interval.
+     * INT64_MAX otherwise (a scan stops at the first cell beyond the interval)
+     */
+    int64_t get_forward_iter_end_column(const VariantQueryConfig& query_config, const unsigned column_interval_idx,
+        const size_t cell_batch_size) const;
+    /*
+     * Begin column of the first cell in [column, end_column] (ignoring cell copies at END), -1 if none.
+     * Only cells with variants are considered if query_config.split_at_variant_cells() is set
+     */
+    int64_t get_first_cell_begin_column_at_or_after(const int ad, const VariantQueryConfig& query_config,
+        const int64_t column, const int64_t end_column=INT64_MAX) const;
     /*
      * Fill data from tile for attribute query_idx into curr_call
      * @param curr_call  VariantCall object in which data will be stored
@@ -339,6 +503,12 @@ class VariantQueryProcessor {
      */
     void fill_field_prep(std::unique_ptr<VariantFieldBase>& field_ptr, const VariantQueryConfig& query_config, const unsigned query_idx,
         unsigned& length_descriptor, unsigned& num_elements) const;
+    /*
+     * Key for the query result cache - array and its fragments, column interval, queried rows and attributes,
+     * page size and token
+     */
+    std::string build_result_cache_key(const int ad, const VariantQueryConfig& query_config,
+        const unsigned column_interval_idx, const GA4GHPagingInfo* paging_info) const;
     /*
      * VariantStorage manager
      */
@@ -355,15 +525,25 @@ class VariantQueryProcessor {
      * Factory object that creates variant fields as and when needed
      */
     VariantFieldFactory m_field_factory;
+    /*
+     * Query result cache - queries are const operations
+     */
+    mutable VariantQueryResultCache m_result_cache;
     /*
      * Array descriptor and schema
      */
     int m_ad;
+    //Descriptors of the partitions merged under m_ad - m_ad is the first partition
+    std::vector<int> m_partition_ads;
     VariantArraySchema* m_array_schema;
     //Mapping from std::type_index to VariantFieldCreator pointers, used when schema loaded to set creators for each attribute
     static std::unordered_map<std::type_index, std::shared_ptr<VariantFieldCreatorBase>> m_type_index_to_creator;
     //Flag to check whether static members are initialized
     static bool m_are_static_members_initialized; 
+    //Paths (workspace/array) of the arrays whose #fragments has been checked by warn_if_many_fragments() -
+    //every array is checked once per process
+    static std::set<std::string> m_arrays_checked_for_fragments;
+    static std::mutex m_arrays_checked_for_fragments_mutex;
     //Function that initializes static members
     static void initialize_static_members();
 };
@@ -247,6 +247,10 @@ class VariantCall
      * Do not copy the fields themselves
      */
     void deep_copy_simple_members(const VariantCall& src);
+    /*
+     * Exchanges contents (including field objects) with other - no allocations
+     */
+    void swap(VariantCall& other);
   private:
     /*
      * Performs move from other object
@@ -279,6 +283,7 @@ class VariantCall
 };
 
 class GA4GHPagingInfo;
+class VariantPool;
 /*
  * Class equivalent to GAVariant in GA4GH API. Stores info about 1 position/interval
  */
@@ -295,16 +300,48 @@ class Variant
       public:
         ValidVariantCallIter(IteratorTy x, IteratorTy end, 
             uint64_t call_idx_in_variant) 
-          : m_iter_position(x), m_end(end), m_call_idx_in_variant(call_idx_in_variant)
+          : m_iter_position(x), m_begin(x), m_end(end), m_call_idx_in_variant(call_idx_in_variant),
+          m_active_call_idx_ptr(0), m_active_call_idx_end(0)
         { 
           //If iter points to invalid Call, move forward
           if(m_iter_position != m_end && !((*m_iter_position).is_valid()))
             operator++();
         }
+        /*
+         * Iterate only over the calls whose idxs are in [active_call_idx_ptr, active_call_idx_end)
+         * begin must point to the first element of the calls vector
+         */
+        ValidVariantCallIter(IteratorTy begin, IteratorTy end,
+            const uint64_t* active_call_idx_ptr, const uint64_t* active_call_idx_end)
+          : m_iter_position(end), m_begin(begin), m_end(end), m_call_idx_in_variant(0ull),
+          m_active_call_idx_ptr(active_call_idx_ptr), m_active_call_idx_end(active_call_idx_end)
+        {
+          if(m_active_call_idx_ptr != m_active_call_idx_end)
+          {
+            m_call_idx_in_variant = *m_active_call_idx_ptr;
+            m_iter_position = m_begin + m_call_idx_in_variant;
+            if(!((*m_iter_position).is_valid()))
+              operator++();
+          }
+        }
         bool operator!=(const ValidVariantCallIter& other) const { return m_iter_position != other.m_iter_position; }
         VariantCallTy& operator*() const { return *m_iter_position; }
         const ValidVariantCallIter& operator++()
         {
+          if(m_active_call_idx_ptr)
+          {
+            //Increment till end of active call idxs or next valid record
+            for(++m_active_call_idx_ptr;m_active_call_idx_ptr != m_active_call_idx_end
+                && !((*(m_begin + *m_active_call_idx_ptr)).is_valid());++m_active_call_idx_ptr);
+            if(m_active_call_idx_ptr == m_active_call_idx_end)
+              m_iter_position = m_end;
+            else
+            {
+              m_call_idx_in_variant = *m_active_call_idx_ptr;
+              m_iter_position = m_begin + m_call_idx_in_variant;
+            }
+            return *this;
+          }
           ++m_iter_position;
           ++m_call_idx_in_variant;
           //Increment till end or next valid record
@@ -314,8 +351,12 @@ class Variant
         uint64_t get_call_idx_in_variant() const { return m_call_idx_in_variant; } 
       private:
         IteratorTy m_iter_position;
+        IteratorTy m_begin;
         IteratorTy m_end;
         uint64_t m_call_idx_in_variant;
+        //Non-null if only active calls are traversed
+        const uint64_t* m_active_call_idx_ptr;
+        const uint64_t* m_active_call_idx_end;
     };
     using const_valid_calls_iterator = ValidVariantCallIter<const VariantCall, std::vector<VariantCall>::const_iterator>;
     using valid_calls_iterator = ValidVariantCallIter<VariantCall, std::vector<VariantCall>::iterator>;
@@ -326,6 +367,8 @@ class Variant
     Variant()
     {
       m_query_config = 0;
+      m_track_active_calls = false;
+      m_num_sorted_active_calls = 0ull;
       m_col_begin = m_col_end = UNDEFINED_NUM_ROWS_VALUE;
       clear();
     }
@@ -336,6 +379,8 @@ class Variant
     Variant(const VariantQueryConfig* query_config)
     {
       m_query_config = query_config;
+      m_track_active_calls = false;
+      m_num_sorted_active_calls = 0ull;
       m_col_begin = m_col_end = UNDEFINED_NUM_ROWS_VALUE;
       clear();
     }
@@ -427,12 +472,50 @@ class Variant
      */
     void move_calls_to_separate_variants(const VariantQueryConfig& query_config,
         std::vector<Variant>& variants, std::vector<uint64_t>& query_row_idx_in_order,
-        GA4GHCallInfoToVariantIdx& call_info_2_variant, GA4GHPagingInfo* paging_info=0);
+        GA4GHCallInfoToVariantIdx& call_info_2_variant, GA4GHPagingInfo* paging_info=0,
+        VariantPool* variant_pool=0);
+    /*
+     * Active call tracking - when enabled, the caller informs the Variant about calls that become valid
+     * (add_active_call()) and the valid calls iterators traverse only the active calls instead of
+     * the whole m_calls vector. The scan keeps the active set equal to the contents of the END priority queue,
+     * so per-position cost scales with the number of overlapping calls rather than the number of rows queried
+     */
+    void enable_active_calls_tracking();
+    void disable_active_calls_tracking();
+    bool is_tracking_active_calls() const { return m_track_active_calls; }
+    /*
+     * Call call_idx became valid - may be invoked multiple times for the same call
+     */
+    void add_active_call(const uint64_t call_idx)
+    {
+      if(m_track_active_calls)
+      {
+        assert(call_idx < m_calls.size());
+        m_active_call_idxs.push_back(call_idx);
+      }
+    }
+    /*
+     * Drop invalid calls from the active set and restore sorted order (call idx order == row order)
+     * Must be invoked before iterating, after the set of valid calls has changed
+     */
+    void update_active_calls();
+    inline uint64_t get_num_active_calls() const { return m_active_call_idxs.size(); }
+    inline const std::vector<uint64_t>& get_active_call_idxs() const { return m_active_call_idxs; }
     /*Non-const iterators for iterating over valid calls*/
-    valid_calls_iterator begin() { return valid_calls_iterator(m_calls.begin(), m_calls.end(), 0ull); }
+    valid_calls_iterator begin()
+    {
+      return m_track_active_calls
+        ? valid_calls_iterator(m_calls.begin(), m_calls.end(), m_active_call_idxs.data(), m_active_call_idxs.data()+m_active_call_idxs.size())
+        : valid_calls_iterator(m_calls.begin(), m_calls.end(), 0ull);
+    }
     valid_calls_iterator end() { return valid_calls_iterator(m_calls.end(), m_calls.end(), m_calls.size()); }
     /*const iterators for iterating over valid calls*/
-    const_valid_calls_iterator begin() const { return const_valid_calls_iterator(m_calls.begin(), m_calls.end(), 0ull); }
+    const_valid_calls_iterator begin() const
+    {
+      return m_track_active_calls
+        ? const_valid_calls_iterator(m_calls.begin(), m_calls.end(), m_active_call_idxs.data(), m_active_call_idxs.data()+m_active_call_idxs.size())
+        : const_valid_calls_iterator(m_calls.begin(), m_calls.end(), 0ull);
+    }
     const_valid_calls_iterator end() const { return const_valid_calls_iterator(m_calls.end(), m_calls.end(), m_calls.size()); }
     /*
      * Set call field idx call_field_idx for call call_idx
@@ -545,6 +628,13 @@ class Variant
      * Member data elements - check clear, copy, move_in functions while adding new members
      */
     std::vector<VariantCall> m_calls;
+    /*
+     * Active call tracking - sorted idxs of valid calls in [0, m_num_sorted_active_calls), unsorted
+     * idxs added since the last update_active_calls() after that
+     */
+    bool m_track_active_calls;
+    std::vector<uint64_t> m_active_call_idxs;
+    uint64_t m_num_sorted_active_calls;
     const VariantQueryConfig* m_query_config;
     uint64_t m_col_begin;
     uint64_t m_col_end;
@@ -702,11 +792,64 @@ if(paging_info && newly_inserted) \
 
 //Priority queue ordered by END position of intervals for VariantCall objects
 //Ensures that interval with the smallest end is at the top of the PQ/min-heap
-struct EndCmpVariantCallStruct
+/*
+ * Indexed min-heap of VariantCall objects ordered by END. Each entry is identified by the idx of the
+ * call in its Variant (query row idx), which allows a call to be removed or its END changed in O(log n)
+ * without draining the heap
+ */
+class VariantCallEndPQ
 {
-  bool operator()(const VariantCall* x, const VariantCall* y) { return x->get_column_end() > y->get_column_end(); }
+  public:
+    VariantCallEndPQ() { }
+    inline bool empty() const { return m_heap.empty(); }
+    inline size_t size() const { return m_heap.size(); }
+    inline VariantCall* top() const
+    {
+      assert(!m_heap.empty());
+      return m_heap[0u].first;
+    }
+    inline uint64_t top_call_idx() const
+    {
+      assert(!m_heap.empty());
+      return m_heap[0u].second;
+    }
+    inline bool contains(const uint64_t call_idx) const
+    {
+      return call_idx < m_heap_position.size() && m_heap_position[call_idx] != UNDEFINED_HEAP_POSITION;
+    }
+    /*
+     * If call_idx is in the heap already, its entry is replaced and moved to the position of its new END
+     */
+    void push(VariantCall* call, const uint64_t call_idx);
+    void pop() { remove_at(0u); }
+    /*
+     * Remove call with idx call_idx from the heap, no-op if absent
+     */
+    void remove(const uint64_t call_idx);
+    /*
+     * END of call call_idx was modified - restore heap order (decrease/increase key)
+     */
+    void update(const uint64_t call_idx);
+    void clear();
+  private:
+    void remove_at(const size_t heap_position);
+    void sift_up(size_t heap_position);
+    void sift_down(size_t heap_position);
+    inline bool is_less(const size_t i, const size_t j) const
+    { return m_heap[i].first->get_column_end() < m_heap[j].first->get_column_end(); }
+    inline void swap_entries(const size_t i, const size_t j)
+    {
+      std::swap(m_heap[i], m_heap[j]);
+      m_heap_position[m_heap[i].second] = i;
+      m_heap_position[m_heap[j].second] = j;
+    }
+  private:
+    static const uint64_t UNDEFINED_HEAP_POSITION = UINT64_MAX;
+    //<call, call idx> pairs
+    std::vector<std::pair<VariantCall*, uint64_t>> m_heap;
+    //Position in m_heap for every call idx
+    std::vector<uint64_t> m_heap_position;
 };
-typedef std::priority_queue<VariantCall*, std::vector<VariantCall*>, EndCmpVariantCallStruct> VariantCallEndPQ;
 
 /*
  * Function that checks whether a ptr is NULL or not
@@ -771,7 +914,8 @@ const VariantFieldTy* get_known_field(const VariantCall& curr_call, const Varian
  * Move call to variants vector - create new Variant if necessary
  */
 bool move_call_to_variant_vector(const VariantQueryConfig& query_config, VariantCall& to_move_call,
-    std::vector<Variant>& variants, GA4GHCallInfoToVariantIdx& call_info_2_variant, bool stop_inserting_new_variants);
+    std::vector<Variant>& variants, GA4GHCallInfoToVariantIdx& call_info_2_variant, bool stop_inserting_new_variants,
+    VariantPool* variant_pool=0);
 
 enum VariantOutputFormatEnum
 {
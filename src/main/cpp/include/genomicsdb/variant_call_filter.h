@@ -0,0 +1,126 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to 
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of 
+ * the Software, and to permit persons to whom the Software is furnished to do so, 
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS 
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR 
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef VARIANT_CALL_FILTER_H
+#define VARIANT_CALL_FILTER_H
+
+#include "headers.h"
+#include "gt_common.h"
+
+class BufferVariantCell;
+
+//Exceptions thrown
+class VariantCallFilterException : public std::exception {
+  public:
+    VariantCallFilterException(const std::string m="") : msg_("VariantCallFilterException : "+m) { ; }
+    ~VariantCallFilterException() { ; }
+    // ACCESSORS
+    /** Returns the exception message. */
+    const char* what() const noexcept { return msg_.c_str(); }
+  private:
+    std::string msg_;
+};
+
+/*
+ * Per-call filter evaluated on the raw cell data, before any VariantFieldBase object is filled
+ * Expression - clauses of the form "<field> <op> <number>" joined by "&&", op is one of ==, !=, <, <=, >, >=
+ * Example: "GQ >= 20 && DP >= 10 && GT > 0"
+ * For multi-element fields, a clause holds if any element satisfies it - "GT > 0" selects calls with a
+ * non-reference allele. Missing values never satisfy a clause.
+ * Fields are bound to query idxs by VariantQueryProcessor::do_query_bookkeeping()
+ */
+class VariantCallFilter
+{
+  public:
+    enum ComparisonOpEnum
+    {
+      FILTER_OP_EQ=0,
+      FILTER_OP_NE,
+      FILTER_OP_LT,
+      FILTER_OP_LE,
+      FILTER_OP_GT,
+      FILTER_OP_GE
+    };
+    enum FieldTypeEnum
+    {
+      FILTER_FIELD_TYPE_INT=0,
+      FILTER_FIELD_TYPE_UNSIGNED,
+      FILTER_FIELD_TYPE_INT64,
+      FILTER_FIELD_TYPE_UINT64,
+      FILTER_FIELD_TYPE_FLOAT,
+      FILTER_FIELD_TYPE_DOUBLE,
+      FILTER_FIELD_TYPE_UNDEFINED
+    };
+  private:
+    class FilterClause
+    {
+      public:
+        FilterClause(const std::string& field_name, const ComparisonOpEnum op, const double value)
+          : m_field_name(field_name)
+        {
+          m_op = op;
+          m_value = value;
+          m_query_idx = UNDEFINED_ATTRIBUTE_IDX_VALUE;
+          m_field_type = FILTER_FIELD_TYPE_UNDEFINED;
+        }
+        std::string m_field_name;
+        ComparisonOpEnum m_op;
+        double m_value;
+        unsigned m_query_idx;
+        FieldTypeEnum m_field_type;
+    };
+  public:
+    VariantCallFilter() { clear(); }
+    void clear()
+    {
+      m_expression.clear();
+      m_clauses.clear();
+    }
+    /*
+     * Parses expression, throws VariantCallFilterException if malformed. Empty expression - no filtering
+     */
+    void parse(const std::string& expression);
+    inline const std::string& get_expression() const { return m_expression; }
+    inline bool empty() const { return m_clauses.empty(); }
+    inline unsigned get_num_clauses() const { return m_clauses.size(); }
+    inline const std::string& get_field_name(const unsigned clause_idx) const
+    {
+      assert(clause_idx < m_clauses.size());
+      return m_clauses[clause_idx].m_field_name;
+    }
+    /*
+     * Binds the clause to the queried field - must be called after the query fields are re-ordered
+     */
+    void bind_field(const unsigned clause_idx, const unsigned query_idx, const std::type_index& type);
+    /*
+     * Returns true if the cell passes all clauses
+     */
+    bool evaluate(const BufferVariantCell& cell) const;
+  private:
+    template<class T>
+    bool evaluate_clause(const FilterClause& clause, const BufferVariantCell& cell) const;
+  private:
+    std::string m_expression;
+    std::vector<FilterClause> m_clauses;
+};
+
+#endif
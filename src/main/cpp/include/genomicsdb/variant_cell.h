@@ -134,4 +134,85 @@ class BufferVariantCell
     int64_t m_begin_column_idx;
 };
 
+/*
+ * Batch of cells stored as struct-of-arrays - prefetching VariantArrayCellIterators hand out cells in batches
+ * Co-ordinates and END values are stored in separate arrays. Every queried attribute has
+ * an offsets array and a values array - data for cell i of attribute q lies in
+ * [offsets(q)[i], offsets(q)[i+1]) of values(q)
+ */
+class VariantCellBatch
+{
+  public:
+    VariantCellBatch()
+    {
+      m_END_query_idx = -1;
+    }
+    /*
+     * END_query_idx - query idx of the END attribute, -1 if END is not queried
+     */
+    void initialize(const unsigned num_queried_attributes, const int END_query_idx);
+    /*
+     * Removes all cells, memory is retained
+     */
+    void clear();
+    inline size_t size() const { return m_rows.size(); }
+    inline unsigned get_num_queried_attributes() const { return m_offsets.size(); }
+    inline int get_END_query_idx() const { return m_END_query_idx; }
+    inline const int64_t* get_rows() const { return m_rows.data(); }
+    inline const int64_t* get_columns() const { return m_columns.data(); }
+    /*
+     * Valid only if END is a queried attribute
+     */
+    inline const int64_t* get_END_values() const
+    {
+      assert(m_END_query_idx >= 0);
+      return m_END_values.data();
+    }
+    inline const uint64_t* get_offsets(const unsigned query_idx) const
+    {
+      assert(query_idx < m_offsets.size());
+      return m_offsets[query_idx].data();
+    }
+    inline const uint8_t* get_values(const unsigned query_idx) const
+    {
+      assert(query_idx < m_values.size());
+      return m_values[query_idx].data();
+    }
+    template<typename T=void>
+    inline const T* get_field_ptr(const unsigned query_idx, const size_t cell_idx) const
+    {
+      assert(cell_idx < size());
+      return reinterpret_cast<const T*>(m_values[query_idx].data()+m_offsets[query_idx][cell_idx]);
+    }
+    inline size_t get_field_size_in_bytes(const unsigned query_idx, const size_t cell_idx) const
+    {
+      assert(cell_idx < size());
+      return m_offsets[query_idx][cell_idx+1u] - m_offsets[query_idx][cell_idx];
+    }
+    /*
+     * Point cell to the data of cell cell_idx in this batch - no copies
+     */
+    void set_cell(BufferVariantCell& cell, const size_t cell_idx) const;
+    /*
+     * Used by iterators while filling the batch - coordinates must be added first, followed by
+     * all the attributes in query idx order
+     */
+    inline void add_coordinates(const int64_t row, const int64_t column)
+    {
+      m_rows.push_back(row);
+      m_columns.push_back(column);
+    }
+    void add_field(const unsigned query_idx, const void* ptr, const size_t num_bytes);
+    void swap(VariantCellBatch& other);
+  private:
+    int m_END_query_idx;
+    //Co-ordinates
+    std::vector<int64_t> m_rows;
+    std::vector<int64_t> m_columns;
+    std::vector<int64_t> m_END_values;
+    //Per attribute data
+    std::vector<std::vector<uint64_t>> m_offsets;
+    std::vector<std::vector<uint8_t>> m_values;
+};
+
 #endif
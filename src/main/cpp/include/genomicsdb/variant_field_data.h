@@ -100,7 +100,14 @@ class VariantFieldBase
       m_valid = false;
     }
     virtual ~VariantFieldBase() = default;
-    virtual void copy_data_from_tile(const BufferVariantCell::FieldsIter&  attr_iter) = 0;
+    void copy_data_from_tile(const BufferVariantCell::FieldsIter&  attr_iter)
+    {
+      copy_data_from_buffer(attr_iter.operator*<char>(), attr_iter.get_field_length(), attr_iter.is_variable_length_field());
+    }
+    /*
+     * base_ptr points to the field data in a cell (after the length field for variable length fields)
+     */
+    virtual void copy_data_from_buffer(const char* base_ptr, const int num_elements, const bool is_variable_length_field) = 0;
     virtual void clear() { ; }
     virtual void print(std::ostream& fptr) const  = 0;
     virtual void print_csv(std::ostream& fptr) const  = 0;
@@ -155,13 +162,12 @@ class VariantFieldData : public VariantFieldBase
       : VariantFieldBase()
     { m_subclass_type = VARIANT_FIELD_DATA; }
     virtual ~VariantFieldData() = default;
-    virtual void copy_data_from_tile(const BufferVariantCell::FieldsIter&  attr_iter)
+    virtual void copy_data_from_buffer(const char* base_ptr, const int num_elements, const bool is_variable_length_field)
     {
-      auto base_ptr = attr_iter.operator*<char>(); //const char*
       uint64_t offset = 0ull;
-      //Set length descriptor to BCF_VL_FIXED as attr_iter will return pointer to data directly
-      //attr_iter will have consumed the length field internally
-      binary_deserialize(base_ptr, offset, BCF_VL_FIXED, attr_iter.get_field_length());
+      //Set length descriptor to BCF_VL_FIXED as base_ptr points to data directly
+      //the length field has been consumed already
+      binary_deserialize(base_ptr, offset, BCF_VL_FIXED, num_elements);
     }
     virtual void binary_deserialize(const char* buffer, uint64_t& offset, unsigned length_descriptor, unsigned num_elements)
     {
@@ -221,13 +227,12 @@ class VariantFieldData<std::string> : public VariantFieldBase
     { m_subclass_type = VARIANT_FIELD_STRING; }
     virtual ~VariantFieldData() = default;
     virtual void clear() { m_data.clear(); }
-    virtual void copy_data_from_tile(const BufferVariantCell::FieldsIter&  attr_iter)
+    virtual void copy_data_from_buffer(const char* base_ptr, const int num_elements, const bool is_variable_length_field)
     {
-      auto base_ptr = attr_iter.operator*<char>(); //const char*
       uint64_t offset = 0ull;
-      //Set length descriptor to BCF_VL_FIXED as attr_iter will return pointer to data directly
-      //attr_iter will have consumed the length field internally
-      binary_deserialize(base_ptr, offset, BCF_VL_FIXED, attr_iter.get_field_length());
+      //Set length descriptor to BCF_VL_FIXED as base_ptr points to data directly
+      //the length field has been consumed already
+      binary_deserialize(base_ptr, offset, BCF_VL_FIXED, num_elements);
     }
     virtual void binary_deserialize(const char* buffer, uint64_t& offset, unsigned length_descriptor, unsigned num_elements)
     {
@@ -320,14 +325,13 @@ class VariantFieldPrimitiveVectorData : public VariantFieldBase
     }
     virtual ~VariantFieldPrimitiveVectorData() = default;
     virtual void clear() { m_data.clear(); }
-    virtual void copy_data_from_tile(const BufferVariantCell::FieldsIter&  attr_iter)
+    virtual void copy_data_from_buffer(const char* base_ptr, const int num_elements, const bool is_variable_length_field)
     {
-      auto base_ptr = attr_iter.operator*<char>(); //const char*
       uint64_t offset = 0ull;
-      //Set length descriptor to BCF_VL_FIXED as attr_iter will return pointer to data directly
-      //attr_iter will have consumed the length field internally
-      binary_deserialize(base_ptr, offset, BCF_VL_FIXED, attr_iter.get_field_length());
-      m_length_descriptor = attr_iter.is_variable_length_field() ? BCF_VL_VAR : BCF_VL_FIXED;
+      //Set length descriptor to BCF_VL_FIXED as base_ptr points to data directly
+      //the length field has been consumed already
+      binary_deserialize(base_ptr, offset, BCF_VL_FIXED, num_elements);
+      m_length_descriptor = is_variable_length_field ? BCF_VL_VAR : BCF_VL_FIXED;
     }
     virtual void binary_deserialize(const char* buffer, uint64_t& offset, unsigned length_descriptor, unsigned num_elements)
     {
@@ -474,13 +478,12 @@ class VariantFieldALTData : public VariantFieldBase
         s.clear();
       m_data.clear();
     }
-    virtual void copy_data_from_tile(const BufferVariantCell::FieldsIter&  attr_iter)
+    virtual void copy_data_from_buffer(const char* base_ptr, const int num_elements, const bool is_variable_length_field)
     {
-      auto base_ptr = attr_iter.operator*<char>(); //const char*
       uint64_t offset = 0ull;
-      //Set length descriptor to BCF_VL_FIXED as attr_iter will return pointer to data directly
-      //attr_iter will have consumed the length field internally
-      binary_deserialize(base_ptr, offset, BCF_VL_FIXED, attr_iter.get_field_length());
+      //Set length descriptor to BCF_VL_FIXED as base_ptr points to data directly
+      //the length field has been consumed already
+      binary_deserialize(base_ptr, offset, BCF_VL_FIXED, num_elements);
     }
     virtual void binary_deserialize(const char* buffer, uint64_t& offset, unsigned length_descriptor, unsigned num_elements)
     {
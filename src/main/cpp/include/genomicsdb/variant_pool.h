@@ -0,0 +1,100 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to 
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of 
+ * the Software, and to permit persons to whom the Software is furnished to do so, 
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS 
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR 
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef VARIANT_POOL_H
+#define VARIANT_POOL_H
+
+#include "headers.h"
+#include "variant.h"
+
+//Objects beyond these limits are freed on release() - a single large query (e.g. the left sweep over
+//100k rows) must not pin its memory in the pool
+#define DEFAULT_MAX_NUM_POOLED_VARIANTS 16384u
+#define DEFAULT_MAX_NUM_POOLED_CALLS 16384u
+
+/*
+ * Pool of Variant and VariantCall objects reused across gt_get_column_interval() calls. Variants returned by a
+ * query are handed back through release() once the caller is done with them - the VariantCall objects retain
+ * their field objects, so a query in steady state allocates (almost) nothing.
+ * Pooled calls are valid only for queries over the same attributes - see set_query_config(). The pool is not
+ * thread safe, use one pool per thread
+ */
+class VariantPool
+{
+  public:
+    VariantPool(const size_t max_num_pooled_variants=DEFAULT_MAX_NUM_POOLED_VARIANTS,
+        const size_t max_num_pooled_calls=DEFAULT_MAX_NUM_POOLED_CALLS)
+    {
+      m_max_num_pooled_variants = max_num_pooled_variants;
+      m_max_num_pooled_calls = max_num_pooled_calls;
+      reset_stats();
+    }
+    /*
+     * Must be called before objects are obtained for a query - pooled calls are dropped if the
+     * queried attributes differ from those of the previous query
+     */
+    void set_query_config(const VariantQueryConfig& query_config);
+    /*
+     * Appends a Variant with no calls to variants
+     */
+    void append_variant(std::vector<Variant>& variants);
+    /*
+     * Appends num_calls calls to variant - the calls are invalid and may hold field objects
+     */
+    void append_calls(Variant& variant, const uint64_t num_calls);
+    /*
+     * Moves to_move_call to the end of variant's calls. to_move_call is refilled with the field objects of a
+     * pooled call (if available), so that the caller can reuse it without allocating fields
+     */
+    void move_call_to_variant(Variant& variant, VariantCall& to_move_call);
+    /*
+     * Takes back all calls of variant - variant is no longer associated with any query
+     */
+    void release(Variant& variant);
+    /*
+     * Takes back all Variants (and their calls) in variants, variants is empty on return
+     */
+    void release(std::vector<Variant>& variants);
+    inline size_t get_num_pooled_variants() const { return m_variants.size(); }
+    inline size_t get_num_pooled_calls() const { return m_calls.size(); }
+    //Stats
+    void reset_stats();
+    inline uint64_t get_num_variant_allocations() const { return m_num_variant_allocations; }
+    inline uint64_t get_num_call_allocations() const { return m_num_call_allocations; }
+    inline uint64_t get_num_variant_reuses() const { return m_num_variant_reuses; }
+    inline uint64_t get_num_call_reuses() const { return m_num_call_reuses; }
+    void print_stats(std::ostream& fptr) const;
+  private:
+    //Schema idxs of the queried attributes of the calls in the pool
+    std::vector<int> m_query_attributes_schema_idxs;
+    size_t m_max_num_pooled_variants;
+    size_t m_max_num_pooled_calls;
+    std::vector<Variant> m_variants;
+    std::vector<VariantCall> m_calls;
+    //Stats
+    uint64_t m_num_variant_allocations;
+    uint64_t m_num_call_allocations;
+    uint64_t m_num_variant_reuses;
+    uint64_t m_num_call_reuses;
+};
+
+#endif
@@ -27,6 +27,10 @@
 #include "lut.h"
 #include "known_field_info.h"
 #include "vid_mapper.h"
+#include "variant_call_filter.h"
+
+//Column intervals separated by at most this many columns are served by a single scan
+#define DEFAULT_COALESCE_COLUMN_INTERVALS_MAX_GAP 100000ull
 
 //Out of bounds query exception
 class OutOfBoundsQueryException : public std::exception {
@@ -63,11 +67,14 @@ class VariantQueryConfig
           m_length_descriptor = BCF_VL_FIXED;
           m_num_elements = 1u;
           m_VCF_field_combine_operation = VCFFieldCombineOperationEnum::VCF_FIELD_COMBINE_OPERATION_UNKNOWN_OPERATION; 
+          m_is_filter_only = false;
         }
         int m_schema_idx;
         int m_length_descriptor;
         int m_num_elements;
         int m_VCF_field_combine_operation;
+        //Fetched only for the per-call filter - not part of the query output
+        bool m_is_filter_only;
         std::string m_name;
     };
   public:
@@ -80,6 +87,18 @@ class VariantQueryConfig
       m_num_rows_in_array = UNDEFINED_NUM_ROWS_VALUE;
       m_smallest_row_idx = 0;
       m_first_normal_field_query_idx = UNDEFINED_ATTRIBUTE_IDX_VALUE;
+      m_num_parallel_column_intervals = 1u;
+      m_split_column_intervals = false;
+      m_split_at_variant_cells = false;
+      m_balance_column_intervals = false;
+      m_cell_batch_size = 0u;
+      m_prefetch_depth = 0u;
+      m_read_buffer_budget = 0u;
+      m_scan_partitions_in_threads = false;
+      m_coalesce_column_intervals = false;
+      m_coalesce_column_intervals_max_gap = DEFAULT_COALESCE_COLUMN_INTERVALS_MAX_GAP;
+      m_result_cache_size = 0u;
+      m_sites_only = false;
     }
     void clear()
     {
@@ -93,6 +112,14 @@ class VariantQueryConfig
      * Function that specifies which attributes to query from each cell
      */
     void set_attributes_to_query(const std::vector<std::string>& attributeNames);
+    /**
+     * Removes all queried attributes
+     */
+    void clear_attributes_to_query()
+    {
+      m_query_attributes_info_vec.clear();
+      m_query_attribute_name_to_query_idx.clear();
+    }
     /**
      * Function used by query processor to add extra attributes to query
      */
@@ -143,6 +170,19 @@ class VariantQueryConfig
       assert(idx < m_query_attributes_info_vec.size());
       return m_query_attributes_info_vec[idx].m_name;
     }
+    /**
+     * Attributes added only for evaluating the per-call filter - operators must not output them
+     */
+    inline void set_filter_only_for_query_idx(unsigned idx)
+    {
+      assert(idx < m_query_attributes_info_vec.size());
+      m_query_attributes_info_vec[idx].m_is_filter_only = true;
+    }
+    inline bool is_filter_only_query_idx(unsigned idx) const
+    {
+      assert(idx < m_query_attributes_info_vec.size());
+      return m_query_attributes_info_vec[idx].m_is_filter_only;
+    }
     /**
      * Get number of attributes in query
      */
@@ -257,6 +297,12 @@ class VariantQueryConfig
      */
     inline bool query_all_rows() const { return m_query_all_rows; }
     inline const std::vector<int64_t>& get_rows_to_query() const { return m_query_rows; }
+    /*
+     * Disjoint blocks of contiguous queried rows, in ascending order. If there are more than
+     * max_num_blocks blocks, blocks separated by the smallest gaps are merged
+     * Pre-requisite: query bookkeeping should be done before calling this function
+     */
+    void get_query_row_blocks(std::vector<RowRange>& row_blocks, const unsigned max_num_blocks) const;
     /**
      * If all rows are queried, return m_num_rows_in_array (set by QueryProcessor)
      * Else return size of m_query_rows vector
@@ -311,6 +357,13 @@ class VariantQueryConfig
      * Function that sets the interval as the only interval to be queried
      */
     void set_column_interval_to_query(const int64_t colBegin, const int64_t colEnd);
+    /*
+     * Replaces the queried intervals - the intervals are queried in the given order (no sorting)
+     */
+    void set_column_intervals_to_query(const std::vector<ColumnRange>& column_intervals)
+    {
+      m_query_column_intervals = column_intervals;
+    }
     /**
      * Returns number of ranges queried
      */
@@ -325,6 +378,93 @@ class VariantQueryConfig
     }
     inline uint64_t get_column_begin(unsigned idx) const { return get_column_interval(idx).first; }
     inline uint64_t get_column_end(unsigned idx) const { return get_column_interval(idx).second; }
+    /*
+     * Total #columns in the queried column intervals
+     */
+    uint64_t get_num_queried_columns() const;
+    /*
+     * Number of column intervals that can be scanned concurrently (by different threads)
+     */
+    inline void set_num_parallel_column_intervals(const unsigned val) { m_num_parallel_column_intervals = std::max(1u, val); }
+    inline unsigned get_num_parallel_column_intervals() const { return m_num_parallel_column_intervals; }
+    /*
+     * If true, each queried column interval is split into get_num_parallel_column_intervals() sub-intervals
+     * which are scanned concurrently
+     */
+    inline void set_split_column_intervals(const bool val) { m_split_column_intervals = val; }
+    inline bool split_column_intervals() const { return m_split_column_intervals; }
+    /*
+     * If true, column intervals are split only where a cell with a variant (not only <NON_REF> in ALT) begins.
+     * The record at such a column is never merged with the previous record (GQ bands in BroadCombinedGVCFOperator)
+     */
+    inline void set_split_at_variant_cells(const bool val) { m_split_at_variant_cells = val; }
+    inline bool split_at_variant_cells() const { return m_split_at_variant_cells; }
+    /*
+     * If true, column intervals are split among threads (see split_column_intervals()) and MPI ranks (gt_mpi_gather)
+     * into pieces with roughly the same number of cells rather than columns - see
+     * VariantQueryProcessor::balance_column_intervals()
+     */
+    inline void set_balance_column_intervals(const bool val) { m_balance_column_intervals = val; }
+    inline bool balance_column_intervals() const { return m_balance_column_intervals; }
+    /*
+     * #cells in every batch read ahead by the prefetch thread (see set_prefetch_depth()) - ignored if prefetch
+     * is disabled
+     */
+    inline void set_cell_batch_size(const unsigned val) { m_cell_batch_size = val; }
+    inline unsigned get_cell_batch_size() const { return m_cell_batch_size; }
+    /*
+     * If non-0 (and the cell batch size is non-0), scans read ahead up to this many batches of cells from the
+     * array in a background thread
+     */
+    inline void set_prefetch_depth(const unsigned val) { m_prefetch_depth = val; }
+    inline unsigned get_prefetch_depth() const { return m_prefetch_depth; }
+    /*
+     * If non-0, the read buffers of a forward scan iterator are sized per attribute from the schema and the cell
+     * sizes seen in earlier scans to total about this many bytes, else every buffer has the segment size.
+     * A target rather than a cap - buffers have a minimum size (see VariantStorageManager::begin())
+     */
+    inline void set_read_buffer_budget(const size_t val) { m_read_buffer_budget = val; }
+    inline size_t get_read_buffer_budget() const { return m_read_buffer_budget; }
+    /*
+     * When a VariantQueryProcessor queries multiple partitions (see its constructor), every partition is scanned
+     * on its own thread and the cells are merged by column - meant for row partitions, whose cells interleave
+     */
+    inline void set_scan_partitions_in_threads(const bool val) { m_scan_partitions_in_threads = val; }
+    inline bool scan_partitions_in_threads() const { return m_scan_partitions_in_threads; }
+    /*
+     * If true, nearby column intervals are served by a single forward scan - see coalesce_column_intervals()
+     */
+    inline void set_coalesce_column_intervals(const bool val) { m_coalesce_column_intervals = val; }
+    inline bool coalesce_column_intervals() const { return m_coalesce_column_intervals; }
+    inline void set_coalesce_column_intervals_max_gap(const uint64_t val) { m_coalesce_column_intervals_max_gap = val; }
+    inline uint64_t get_coalesce_column_intervals_max_gap() const { return m_coalesce_column_intervals_max_gap; }
+    /*
+     * Sorts the queried column intervals and merges overlapping/adjacent intervals - the result is stored
+     * in target_intervals. Target intervals separated by at most get_coalesce_column_intervals_max_gap() columns
+     * are grouped into a single scan interval. coalesced_query_config is a copy of this object, with the
+     * scan intervals as the queried intervals
+     */
+    void coalesce_column_intervals(VariantQueryConfig& coalesced_query_config,
+        std::vector<ColumnRange>& target_intervals) const;
+    /*
+     * Byte budget of the query result cache in VariantQueryProcessor, 0 - results are not cached
+     */
+    inline void set_result_cache_size(const size_t val) { m_result_cache_size = val; }
+    inline size_t get_result_cache_size() const { return m_result_cache_size; }
+    /*
+     * Per-call filter expression - see VariantCallFilter. Calls that fail the filter are dropped in
+     * VariantQueryProcessor::gt_fill_row() before any field is decoded
+     */
+    inline void set_call_filter_expression(const std::string& expression) { m_call_filter.parse(expression); }
+    inline const std::string& get_call_filter_expression() const { return m_call_filter.get_expression(); }
+    inline VariantCallFilter& get_call_filter() { return m_call_filter; }
+    inline const VariantCallFilter& get_call_filter() const { return m_call_filter; }
+    /*
+     * Sites-only queries fetch END, REF, ALT, QUAL and INFO fields only - per-call FORMAT fields are
+     * never read from TileDB. See VariantQueryProcessor::do_query_bookkeeping()
+     */
+    inline void set_sites_only(const bool val) { m_sites_only = val; }
+    inline bool sites_only() const { return m_sites_only; }
   private:
     /*
      * Function to invalid TileDB array row idx -> query row idx mapping
@@ -351,6 +491,28 @@ class VariantQueryConfig
     int64_t m_smallest_row_idx;
     /*Column ranges to query*/
     std::vector<ColumnRange> m_query_column_intervals;
+    /*#column intervals scanned in parallel*/
+    unsigned m_num_parallel_column_intervals;
+    /*Split each column interval for parallel scans*/
+    bool m_split_column_intervals;
+    /*Split column intervals only at cells with variants*/
+    bool m_split_at_variant_cells;
+    /*Cost based split of column intervals*/
+    bool m_balance_column_intervals;
+    /*#cells fetched per batch in scans, 0 - cell at a time*/
+    unsigned m_cell_batch_size;
+    unsigned m_prefetch_depth;
+    size_t m_read_buffer_budget;
+    bool m_scan_partitions_in_threads;
+    /*Serve nearby column intervals from a single scan*/
+    bool m_coalesce_column_intervals;
+    uint64_t m_coalesce_column_intervals_max_gap;
+    /*Query result cache budget in bytes*/
+    size_t m_result_cache_size;
+    /*Per-call filter, bound to query idxs during bookkeeping*/
+    VariantCallFilter m_call_filter;
+    /*Skip FORMAT fields*/
+    bool m_sites_only;
 };
 
 #endif
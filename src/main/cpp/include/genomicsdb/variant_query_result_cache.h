@@ -0,0 +1,99 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to 
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of 
+ * the Software, and to permit persons to whom the Software is furnished to do so, 
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS 
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR 
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef VARIANT_QUERY_RESULT_CACHE_H
+#define VARIANT_QUERY_RESULT_CACHE_H
+
+#include "headers.h"
+#include "variant.h"
+#include <list>
+
+/*
+ * Memory bounded LRU cache of query results. Values are Variants in the binary_serialize() format along with
+ * the state of the GA4GH paging info object after the query (if the query was paged). Keys are built by
+ * VariantQueryProcessor from the array, column interval, queried rows and attributes (and page token)
+ * The cache is safe to use from multiple threads
+ */
+class VariantQueryResultCache
+{
+  public:
+    VariantQueryResultCache(const size_t max_num_bytes=0u)
+    {
+      m_max_num_bytes = max_num_bytes;
+      m_num_bytes = 0ull;
+      m_num_hits = 0ull;
+      m_num_misses = 0ull;
+      m_num_evictions = 0ull;
+    }
+    /*
+     * Entries are evicted if the cache is larger than the new budget, 0 disables the cache
+     */
+    void set_max_num_bytes(const size_t max_num_bytes);
+    /*
+     * Getters and stats are read in the same critical section as the one used by lookup() and insert()
+     */
+    size_t get_max_num_bytes() const;
+    size_t get_num_bytes() const;
+    size_t size() const;
+    /*
+     * On a hit, copies the value into serialized_variants (and paging_info, if non-NULL) and returns true
+     */
+    bool lookup(const std::string& key, std::vector<uint8_t>& serialized_variants, GA4GHPagingInfo* paging_info);
+    /*
+     * Values larger than the budget are not cached
+     */
+    void insert(const std::string& key, const uint8_t* serialized_variants, const size_t num_bytes,
+        const GA4GHPagingInfo* paging_info);
+    void clear();
+    /*
+     * Stats
+     */
+    uint64_t get_num_hits() const;
+    uint64_t get_num_misses() const;
+    uint64_t get_num_evictions() const;
+    void reset_stats();
+    void print_stats(std::ostream& fptr) const;
+  private:
+    struct CacheEntry
+    {
+      std::string m_key;
+      std::vector<uint8_t> m_serialized_variants;
+      GA4GHPagingInfo m_paging_info;
+    };
+    static size_t get_entry_size(const CacheEntry& entry)
+    {
+      return sizeof(CacheEntry) + entry.m_key.length() + entry.m_serialized_variants.size();
+    }
+    //Evicts least recently used entries till the cache size <= max_num_bytes
+    void evict(const size_t max_num_bytes);
+  private:
+    size_t m_max_num_bytes;
+    size_t m_num_bytes;
+    //Most recently used entry at the front
+    std::list<CacheEntry> m_lru_list;
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator> m_key_to_entry;
+    uint64_t m_num_hits;
+    uint64_t m_num_misses;
+    uint64_t m_num_evictions;
+};
+
+#endif
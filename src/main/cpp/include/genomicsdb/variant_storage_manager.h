@@ -28,6 +28,12 @@
 #include "variant_cell.h"
 #include "c_api.h"
 #include "timer.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+class Histogram;
 
 //Exceptions thrown 
 class VariantStorageManagerException : public std::exception {
@@ -41,16 +47,97 @@ class VariantStorageManagerException : public std::exception {
     std::string msg_;
 };
 
+/*
+ * Orders TileDB iterators by the co-ordinates of their current cells - column major order
+ * Used as a min-heap comparator, hence "greater than"
+ */
+class TileDBIteratorColumnMajorCompare
+{
+  public:
+    TileDBIteratorColumnMajorCompare(const std::vector<std::pair<int64_t, int64_t>>* coords=0) : m_coords(coords) { ; }
+    bool operator()(const unsigned a, const unsigned b) const
+    {
+      auto& a_coords = (*m_coords)[a];
+      auto& b_coords = (*m_coords)[b];
+      return (a_coords.second > b_coords.second) || (a_coords.second == b_coords.second && a_coords.first > b_coords.first);
+    }
+  private:
+    //[row, column] of the current cell of every iterator
+    const std::vector<std::pair<int64_t, int64_t>>* m_coords;
+};
+
+/*
+ * Observed average #bytes per cell of every attribute of an array - recorded by iterators over the array and
+ * used to size the read buffers of later iterators. Also totals the read stats of all the iterators over the
+ * array, printed once when the array is closed (DO_PROFILING). Safe to use from multiple threads
+ */
+class VariantArrayReadStats
+{
+  public:
+    VariantArrayReadStats(const unsigned num_attributes)
+      : m_num_cells(num_attributes, 0ull), m_num_bytes(num_attributes, 0ull), m_num_refills(num_attributes, 0ull)
+    {
+      m_num_iterators = 0ull;
+      m_num_buffer_bytes = 0ull;
+    }
+    void update(const int schema_idx, const uint64_t num_cells, const uint64_t num_bytes, const uint64_t num_refills=0ull);
+    //Called once per iterator with the total size of its read buffers
+    void add_iterator(const uint64_t num_buffer_bytes);
+    //Returns 0 if no cells of the attribute have been read yet
+    double get_average_cell_size(const int schema_idx) const;
+    void print(const std::string& array_name, const VariantArraySchema& schema, std::ostream& fptr) const;
+  private:
+    std::vector<uint64_t> m_num_cells;
+    std::vector<uint64_t> m_num_bytes;
+    std::vector<uint64_t> m_num_refills;
+    uint64_t m_num_iterators;
+    uint64_t m_num_buffer_bytes;
+};
+
+/*
+ * Forward iterator over cells in column major order
+ * The iterator may be over multiple subarrays (ranges) with disjoint row blocks (for example, when a subset of
+ * rows is queried), and over multiple arrays with the same schema (for example, the column partitions of
+ * a workspace). A TileDB iterator is created for each (array, subarray) pair and the cells from the iterators
+ * are merged in column major order
+ */
 class VariantArrayCellIterator
 {
   public:
     VariantArrayCellIterator(TileDB_CTX* tiledb_ctx, const VariantArraySchema& variant_array_schema,
-        const std::string& array_path, const int64_t* range, const std::vector<int>& attribute_ids, const size_t buffer_size);
+        const std::string& array_path, const int64_t* ranges, const unsigned num_ranges,
+        const std::vector<int>& attribute_ids, const size_t buffer_size,
+        const size_t buffer_budget=0u, const std::shared_ptr<VariantArrayReadStats>& read_stats=nullptr);
+    /*
+     * One TileDB iterator per entry of iterator_array_paths - iterator i reads the subarray at ranges+4*i of the
+     * array at iterator_array_paths[i]. The TileDB iterators of different arrays are initialized (and read their
+     * first tiles) in parallel
+     */
+    VariantArrayCellIterator(TileDB_CTX* tiledb_ctx, const VariantArraySchema& variant_array_schema,
+        const std::vector<std::string>& iterator_array_paths, const int64_t* ranges,
+        const std::vector<int>& attribute_ids, const size_t buffer_size,
+        const size_t buffer_budget=0u, const std::shared_ptr<VariantArrayReadStats>& read_stats=nullptr);
+    /*
+     * Merges the cells of iterators over different arrays with the same schema (for example, row partitions)
+     * in column major order. Every iterator in array_iterators is scanned on its own thread, reading ahead
+     * up to prefetch_depth batches of batch_size cells - see start_prefetch()
+     */
+    VariantArrayCellIterator(const VariantArraySchema& variant_array_schema, const std::vector<int>& attribute_ids,
+        std::vector<std::unique_ptr<VariantArrayCellIterator>>&& array_iterators,
+        const unsigned prefetch_depth, const size_t batch_size);
     ~VariantArrayCellIterator()
     {
-      if(m_tiledb_array_iterator)
-        tiledb_array_iterator_finalize(m_tiledb_array_iterator);
-      m_tiledb_array_iterator = 0;
+      stop_prefetch();
+      //Stops the reader threads of the arrays
+      m_array_iterators.clear();
+      //Stats are printed once per array - see VariantArrayReadStats
+      if(m_read_stats)
+        for(auto i=0u;i<m_num_queried_attributes;++i)
+          m_read_stats->update(m_attribute_ids[i], m_num_cells_read, m_num_bytes_read[i], m_num_refills[i]);
+      for(auto i=0u;i<m_tiledb_array_iterators.size();++i)
+        if(m_tiledb_array_iterators[i])
+          tiledb_array_iterator_finalize(m_tiledb_array_iterators[i]);
+      m_tiledb_array_iterators.clear();
 #ifdef DO_PROFILING
       m_tiledb_timer.print("TileDB iterator", std::cerr);
       m_tiledb_to_buffer_cell_timer.print("TileDB to buffer cell", std::cerr);
@@ -60,24 +147,34 @@ class VariantArrayCellIterator
     VariantArrayCellIterator(const VariantArrayCellIterator& other) = delete;
     VariantArrayCellIterator(VariantArrayCellIterator&& other) = delete;
     inline bool end() const {
-      return tiledb_array_iterator_end(m_tiledb_array_iterator);
+      return (m_prefetch_depth > 0u) ? prefetch_end() : end_of_array_iterators();
     }
     inline const VariantArrayCellIterator& operator++()
     {
 #ifdef DO_PROFILING
       m_tiledb_timer.start();
 #endif
-      auto status = tiledb_array_iterator_next(m_tiledb_array_iterator);
-      if(status != TILEDB_OK)
-        throw VariantStorageManagerException("VariantArrayCellIterator increment failed");
+      if(!m_array_iterators.empty())
+        advance_array_iterators();
+      else if(m_tiledb_array_iterators.size() == 1u)
+      {
+        auto status = tiledb_array_iterator_next(m_tiledb_array_iterators[0u]);
+        if(status != TILEDB_OK)
+          throw VariantStorageManagerException("VariantArrayCellIterator increment failed");
+#ifdef DO_PROFILING
+        count_refills(0u);
+#endif
+      }
+      else
+        advance_merged_iterators();
 #ifdef DEBUG
-      if(!end())
+      if(m_array_iterators.empty() && !end_of_array_iterators())
       {
         ++m_num_cells_iterated_over;
         //Co-ordinates
         const uint8_t* field_ptr = 0;
         size_t field_size = 0u;
-        tiledb_array_iterator_get_value(m_tiledb_array_iterator, m_num_queried_attributes,
+        tiledb_array_iterator_get_value(m_tiledb_array_iterators[get_curr_iterator_idx()], m_num_queried_attributes,
             reinterpret_cast<const void**>(&field_ptr), &field_size);
         assert(field_size == m_variant_array_schema->dim_size_in_bytes());
         auto coords_ptr = reinterpret_cast<const int64_t*>(field_ptr);
@@ -92,19 +189,119 @@ class VariantArrayCellIterator
       return *this;
     }
     const BufferVariantCell& operator*();
+    /*
+     * Only for prefetching iterators - swaps the next prefetched batch (struct-of-arrays) into batch, the old
+     * contents of batch are reused by the prefetch thread. Blocks till a batch is ready, returns #cells in batch
+     * (0 at the end). batch must have been initialized with the #attributes queried by this iterator
+     */
+    size_t fill_batch(VariantCellBatch& batch);
+    /*
+     * Starts a background thread which reads ahead from the TileDB iterators into up to prefetch_depth
+     * batches of batch_size cells each, overlapping TileDB I/O and decompression with the consumer's work.
+     * Cells are copied into the batches, as TileDB refills its buffers when the iterator advances - prefetch
+     * pays off only if reading from TileDB is slow (benchmark_cell_batch compares both interfaces on an array).
+     * Once started, cells must be obtained only through fill_batch() and end(); operator*() and operator++()
+     * must not be used. Iterators merging array iterators don't prefetch - the arrays are already read ahead on
+     * their own threads
+     */
+    void start_prefetch(const unsigned prefetch_depth, const size_t batch_size, const int END_query_idx);
+    inline bool is_prefetching() const { return m_prefetch_depth > 0u; }
+    /*
+     * Read stats - #times the TileDB buffer of the attribute was refilled after the initial fill. For variable
+     * length attributes, refills of the values buffer are counted. Refills are counted only with DO_PROFILING
+     */
+    inline uint64_t get_num_refills(const unsigned query_idx) const
+    {
+      assert(query_idx < m_num_refills.size());
+      return m_num_refills[query_idx];
+    }
+  private:
+    /*
+     * Sizes of the buffers of a TileDB iterator - all attributes of a cell are refilled after about the same
+     * #cells. Cell sizes come from the schema for fixed length attributes, and from read_stats (or a guess) for
+     * variable length attributes
+     */
+    void get_adaptive_buffer_sizes(std::vector<size_t>& buffer_sizes, const size_t buffer_budget,
+        const VariantArrayReadStats* read_stats) const;
+    /*
+     * Called every time TileDB iterator iterator_idx moves to a new cell (including its first cell), whether
+     * the cell is dereferenced or not. Within one fill of a TileDB buffer, the values of consecutive cells are
+     * contiguous - a value that does not begin where the value of the previous cell ended was read by a refill
+     */
+    void count_refills(const unsigned iterator_idx);
+    inline bool end_of_array_iterators() const
+    {
+      //Single subarray - no merging required
+      return (m_tiledb_array_iterators.size() == 1u) ? tiledb_array_iterator_end(m_tiledb_array_iterators[0u])
+        : m_iterators_pq.empty();
+    }
+    //Body of the prefetch thread - copies up to max_num_cells cells from the TileDB iterators into batch
+    size_t fill_batch_from_array(VariantCellBatch& batch, const size_t max_num_cells);
+    void prefetch();
+    bool prefetch_end() const;
+    void stop_prefetch();
+    inline unsigned get_curr_iterator_idx() const
+    {
+      return (m_tiledb_array_iterators.size() == 1u) ? 0u : m_iterators_pq.top();
+    }
+    /*
+     * Reads co-ordinates of the current cell of iterator idx and inserts the iterator into the PQ
+     * If the iterator is at its end, it is not inserted
+     */
+    void push_into_iterators_pq(const unsigned idx);
+    void advance_merged_iterators();
+    /*
+     * Array iterators - same as above, but the current cell of array iterator idx is the next cell in its
+     * batch. The batch is refilled from the iterator once all its cells are consumed
+     */
+    void push_array_iterator_into_pq(const unsigned idx);
+    void advance_array_iterators();
   private:
     unsigned m_num_queried_attributes;
     TileDB_CTX* m_tiledb_ctx;
     const VariantArraySchema* m_variant_array_schema;
     BufferVariantCell m_cell;
-    //The actual TileDB array iterator
-    TileDB_ArrayIterator* m_tiledb_array_iterator;
-    //Buffers to hold data
+    //The actual TileDB array iterators - one per (array, subarray) pair
+    std::vector<TileDB_ArrayIterator*> m_tiledb_array_iterators;
+    //Used only when merging iterators over different arrays - every array iterator has its own reader thread.
+    //The PQ then holds array iterator idxs and m_array_batches holds the current batch of every array iterator
+    std::vector<std::unique_ptr<VariantArrayCellIterator>> m_array_iterators;
+    std::vector<VariantCellBatch> m_array_batches;
+    std::vector<size_t> m_array_batch_cell_idxs;
+    size_t m_array_batch_size;
+    //Used only when there are multiple subarrays or array iterators - [row, column] of the current cell of every
+    //iterator and the min-heap of iterators which haven't reached their end
+    std::vector<std::pair<int64_t, int64_t>> m_iterators_coords;
+    std::priority_queue<unsigned, std::vector<unsigned>, TileDBIteratorColumnMajorCompare> m_iterators_pq;
+    //Buffers to hold data - m_num_buffers_per_iterator buffers for each iterator
+    unsigned m_num_buffers_per_iterator;
     std::vector<std::vector<uint8_t>> m_buffers;
     //Pointers to buffers
     std::vector<const void*> m_buffer_pointers;
     //Buffer sizes
     std::vector<size_t> m_buffer_sizes;
+    //Read stats - per query attribute
+    std::vector<int> m_attribute_ids;
+    std::shared_ptr<VariantArrayReadStats> m_read_stats;
+    uint64_t m_num_cells_read;
+    std::vector<uint64_t> m_num_bytes_read;
+    std::vector<uint64_t> m_num_refills;
+    //End of the value of the previous cell of every (TileDB iterator, attribute) - see count_refills()
+    std::vector<const uint8_t*> m_next_field_ptrs;
+    //Prefetch - ring of m_prefetch_depth batches, m_num_prefetched_batches of which (starting at
+    //m_prefetch_head_idx) are ready for the consumer. m_prefetch_depth == 0 if prefetch is disabled
+    unsigned m_prefetch_depth;
+    size_t m_prefetch_batch_size;
+    std::vector<VariantCellBatch> m_prefetch_batches;
+    unsigned m_prefetch_head_idx;
+    unsigned m_num_prefetched_batches;
+    bool m_prefetch_done;
+    bool m_stop_prefetch;
+    //Exception thrown in the prefetch thread - rethrown to the consumer
+    std::exception_ptr m_prefetch_exception;
+    std::thread m_prefetch_thread;
+    mutable std::mutex m_prefetch_mutex;
+    mutable std::condition_variable m_prefetch_cv;
 #ifdef DEBUG
     int64_t m_last_row;
     int64_t m_last_column;
@@ -116,38 +313,152 @@ class VariantArrayCellIterator
 #endif
 };
 
+/*
+ * Optional sidecar index stored in the array directory. Cells are grouped into tiles in the order in which they
+ * are written - one tile per num_cells_per_tile cells, matching the capacity of TileDB tiles. Each entry records
+ * the column range, row range and max END of the cells in the tile. Every load (fragment) appends its tiles
+ * to the index. The index exists only if every cell in the array was indexed, i.e. the array was created with
+ * the index enabled. The index records the #fragments it covers - an index left stale by a load which did not
+ * update it (concurrent load, older binary) is ignored
+ */
+class VariantArrayTileIndex
+{
+  public:
+    VariantArrayTileIndex() { clear(); }
+    void clear();
+    inline bool is_valid() const { return m_is_valid; }
+    inline size_t size() const { return m_tiles.size(); }
+    inline uint64_t get_num_cells_per_tile() const { return m_num_cells_per_tile; }
+    inline void set_num_fragments(const uint64_t num_fragments) { m_num_fragments = num_fragments; }
+    /*
+     * Writes an index with no tiles - for new arrays only, as cells already in an array cannot be indexed
+     */
+    static void create_empty_index_file(const std::string& filename, const uint64_t num_cells_per_tile);
+    /*
+     * Returns false if the file does not exist, is in an older format or covers a #fragments different from
+     * num_fragments (not checked if num_fragments < 0). Throws exception if the file is corrupted
+     */
+    bool read_from_file(const std::string& filename, const int num_fragments);
+    void write_to_file(const std::string& filename) const;
+    /*
+     * Called for every cell written to the array (including cell copies at END positions)
+     */
+    void add_cell(const int64_t row, const int64_t column, const int64_t END);
+    /*
+     * Smallest column >= column where a tile intersecting rows [row_begin, row_end] has data, INT64_MAX if none
+     */
+    int64_t get_first_column_at_or_after(const int64_t column, const int64_t row_begin, const int64_t row_end) const;
+    /*
+     * Max END over all cells which begin at or before column, -1 if no such cells exist. The END of every
+     * cell intersecting column is <= the returned value
+     */
+    int64_t get_max_END_of_cells_beginning_at_or_before(const int64_t column) const;
+    /*
+     * Estimates the begin columns of the cells in [column_begin, column_end] from the tiles intersecting rows
+     * [row_begin, row_end] - the cells of a tile are assumed to be spread uniformly over its column range.
+     * Every estimated begin column c is added to histogram as histogram_offset+c-column_begin
+     */
+    void add_cell_estimates_to_histogram(Histogram& histogram, const int64_t column_begin, const int64_t column_end,
+        const int64_t row_begin, const int64_t row_end, const uint64_t histogram_offset) const;
+  private:
+    //Sorts tiles by column begin and computes the prefix max arrays used in queries
+    void build_search_structures();
+    struct TileInfo
+    {
+      int64_t m_column_begin;
+      int64_t m_column_end;
+      int64_t m_row_begin;
+      int64_t m_row_end;
+      int64_t m_max_END;
+    };
+    struct TileColumnBeginCompare
+    {
+      bool operator()(const TileInfo& a, const TileInfo& b) const { return a.m_column_begin < b.m_column_begin; }
+      bool operator()(const int64_t column, const TileInfo& b) const { return column < b.m_column_begin; }
+    };
+    bool m_is_valid;
+    uint64_t m_num_fragments;
+    uint64_t m_num_cells_per_tile;
+    uint64_t m_num_cells_in_last_tile;
+    std::vector<TileInfo> m_tiles;
+    //Prefix max of column end and max END over tiles sorted by column begin
+    std::vector<int64_t> m_prefix_max_column_end;
+    std::vector<int64_t> m_prefix_max_END;
+};
+
+/*
+ * Writes buffers to a TileDB array in a background thread, so that compression and disk writes overlap with
+ * filling the next set of buffers. At most one set of buffers is in flight - write() blocks till the previous
+ * set has been written
+ */
+class VariantArrayAsyncWriter
+{
+  public:
+    VariantArrayAsyncWriter(TileDB_Array* tiledb_array, const std::string& array_name);
+    ~VariantArrayAsyncWriter()
+    {
+      stop_thread();
+    }
+    //Delete copy and move constructors
+    VariantArrayAsyncWriter(const VariantArrayAsyncWriter& other) = delete;
+    VariantArrayAsyncWriter(VariantArrayAsyncWriter&& other) = delete;
+    /*
+     * Hands over buffers (buffer_offsets[i] bytes of buffer i are valid) to the writer thread and returns the
+     * free set of buffers in their place. buffer_pointers must point to buffers, the offsets are left unmodified
+     */
+    void write(std::vector<std::vector<uint8_t>>& buffers, std::vector<void*>& buffer_pointers,
+        const std::vector<size_t>& buffer_offsets);
+    /*
+     * Waits till the buffers in flight are written and stops the thread. Throws VariantStorageManagerException
+     * if any write failed
+     */
+    void finish();
+  private:
+    void write_loop();
+    void stop_thread();
+  private:
+    TileDB_Array* m_tiledb_array;
+    std::string m_array_name;
+    //Buffers being written or free
+    std::vector<std::vector<uint8_t>> m_buffers;
+    std::vector<void*> m_buffer_pointers;
+    //#valid bytes in every buffer of the write in flight
+    std::vector<size_t> m_buffer_sizes;
+    bool m_has_pending_write;
+    bool m_stop;
+    bool m_write_failed;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
 class VariantArrayInfo
 {
   public:
     VariantArrayInfo(int idx, int mode, const std::string& name, const VariantArraySchema& schema,
-        TileDB_Array* tiledb_array, const std::string& metadata_filename,
-        const size_t buffer_size=10u*1024u*1024u); //10MB buffer
+        TileDB_Array* tiledb_array, const std::string& metadata_filename, const std::string& tile_index_filename,
+        const int num_fragments, const size_t buffer_size=10u*1024u*1024u); //10MB buffer
     //Delete default copy constructor as it is incorrect
     VariantArrayInfo(const VariantArrayInfo& other) = delete;
     //Define move constructor explicitly
     VariantArrayInfo(VariantArrayInfo&& other);
     ~VariantArrayInfo()
     {
-      close_array();
-    }
-    void close_array()
-    {
-      //Flush cells in buffer
-      auto coords_buffer_idx = m_buffers.size()-1u;
-      if((m_mode == TILEDB_ARRAY_WRITE || m_mode == TILEDB_ARRAY_WRITE_UNSORTED)
-          && m_buffer_offsets[coords_buffer_idx] > 0ull)
+      //Destructors must not throw - call close_array() to get write errors
+      try
       {
-        auto status = tiledb_array_write(m_tiledb_array, const_cast<const void**>(&(m_buffer_pointers[0])), &(m_buffer_offsets[0]));
-        if(status != TILEDB_OK)
-          throw VariantStorageManagerException("Error while writing to array "+m_name);
-        memset(&(m_buffer_offsets[0]), 0, m_buffer_offsets.size()*sizeof(size_t));
+        close_array();
+      }
+      catch(const std::exception& e)
+      {
+        std::cerr << e.what() << "\n";
       }
-      if(m_tiledb_array)
-        tiledb_array_finalize(m_tiledb_array);
-      m_tiledb_array = 0;
-      m_name.clear();
-      m_mode = -1;
     }
+    /*
+     * Writes the cells still in the write buffers and waits for the write in flight (if writes are asynchronous).
+     * The array is finalized even if a write fails - the exception of the first failed write is thrown after that
+     */
+    void close_array();
     void set_schema(const VariantArraySchema& schema)
     {
       m_schema = schema;
@@ -155,8 +466,18 @@ class VariantArrayInfo
     }
     const VariantArraySchema& get_schema() const { return m_schema; }
     const std::string& get_array_name() const { return m_name; }
+    /*
+     * Appends a cell in the serialized loader format to the write buffers - the buffers are written to the array
+     * when the next cell may not fit
+     */
     void write_cell(const void* ptr);
+    /*
+     * Full write buffers are written to the array in a background thread while cells are added to a second
+     * set of buffers. Only for arrays opened for writing
+     */
+    void enable_async_writes();
     //Read #valid rows from metadata if available, else set from schema (array domain)
+    //Also reads max interval length if available
     void read_row_bounds_from_metadata();
     /*
      * Update #valid rows in the metadata
@@ -168,6 +489,35 @@ class VariantArrayInfo
     {
       return (m_max_valid_row_idx_in_array - m_schema.dim_domains()[0].first + 1);
     }
+    /*
+     * Max value of (END - begin column) over all cells in the array, -1 if unknown (array loaded by an
+     * older version of GenomicsDB)
+     */
+    inline int64_t get_max_interval_length() const
+    {
+      return m_metadata_contains_max_interval_length ? m_max_interval_length : -1ll;
+    }
+    /*
+     * Returns 0 if the array has no tile index
+     */
+    inline const VariantArrayTileIndex* get_tile_index() const
+    {
+      return m_tile_index.is_valid() ? &m_tile_index : 0;
+    }
+    inline const std::shared_ptr<VariantArrayReadStats>& get_read_stats() const { return m_read_stats; }
+    /*
+     * Columns owned by the array if it is one of several column partitions - cells outside the partition
+     * are copies of cells owned by other partitions
+     */
+    inline void set_column_partition(const ColumnRange& column_partition) { m_column_partition = column_partition; }
+    inline const ColumnRange& get_column_partition() const { return m_column_partition; }
+    //Same for row partitions
+    inline void set_row_partition(const RowRange& row_partition) { m_row_partition = row_partition; }
+    inline const RowRange& get_row_partition() const { return m_row_partition; }
+  private:
+    void write_max_interval_length_to_metadata();
+    //Writes the contents of the write buffers to the array and empties the buffers
+    void flush_write_buffers();
   private:
     int m_idx;
     int m_mode;
@@ -183,9 +533,27 @@ class VariantArrayInfo
     std::vector<void*> m_buffer_pointers;
     //Buffer offsets - byte where next data item needs to be written
     std::vector<size_t> m_buffer_offsets;
+    //Size of every buffer (the segment size) and max over m_buffer_offsets
+    size_t m_buffer_size;
+    size_t m_max_buffer_offset;
     //Max valid row idx in array
     int64_t m_max_valid_row_idx_in_array;
     bool m_metadata_contains_max_valid_row_idx_in_array;
+    //Max interval length - tracked only if the value is known for the cells already in the array
+    int m_END_schema_idx;
+    int64_t m_max_interval_length;
+    bool m_metadata_contains_max_interval_length;
+    bool m_max_interval_length_modified;
+    //Sidecar tile index
+    std::string m_tile_index_filename;
+    VariantArrayTileIndex m_tile_index;
+    bool m_tile_index_modified;
+    //Shared with the iterators over the array
+    std::shared_ptr<VariantArrayReadStats> m_read_stats;
+    //Background writer, null if writes are synchronous
+    std::unique_ptr<VariantArrayAsyncWriter> m_async_writer;
+    ColumnRange m_column_partition;
+    RowRange m_row_partition;
 #ifdef DEBUG
     int64_t m_last_row;
     int64_t m_last_column;
@@ -215,9 +583,38 @@ class VariantStorageManager
      * Wrapper functions around the C-API
      */
     int open_array(const std::string& array_name, const char* mode);
+    /*
+     * Opens a set of arrays, for example the column partitions of a workspace - returns the descriptor of every
+     * array in array_names, -1 for arrays that could not be opened
+     */
+    std::vector<int> open_arrays(const std::vector<std::string>& array_names, const char* mode);
     void close_array(const int ad);
-    int define_array(const VariantArraySchema* variant_array_schema, const size_t num_cells_per_tile=1000u);
-    int define_metadata_schema(const VariantArraySchema* variant_array_schema);
+    /*
+     * If build_tile_index is true, a sidecar tile index is maintained for all the cells written to the array
+     */
+    int define_array(const VariantArraySchema* variant_array_schema, const size_t num_cells_per_tile=1000u,
+        const bool build_tile_index=false);
+    /*
+     * If is_new_array is true, the array has no cells yet and the metadata records max interval length 0
+     */
+    int define_metadata_schema(const VariantArraySchema* variant_array_schema, const bool is_new_array=false);
+    /*
+     * Merges all the fragments of the array into one fragment - the array must not be open. If the array has a
+     * sidecar tile index, the index is rebuilt from a scan of the consolidated array. Returns TILEDB_OK on success
+     */
+    int consolidate_array(const std::string& array_name);
+    /*
+     * #fragments in the array, -1 if the array directory cannot be read. Every load (including appends) adds a
+     * fragment and queries read all the fragments - query time grows with the count till the array is consolidated.
+     * If last_modification_time is non-NULL, it is set to the latest modification time (ns) of the fragments -
+     * a load or a consolidation always changes it
+     */
+    int get_num_fragments(const std::string& array_name, int64_t* last_modification_time=0) const;
+    int get_num_fragments(const int ad, int64_t* last_modification_time=0) const;
+    /*
+     * Return name of the open array
+     */
+    const std::string& get_array_name(const int ad) const;
     /*
      * Load array schema
      */
@@ -228,14 +625,72 @@ class VariantStorageManager
      */
     VariantArrayCellIterator* begin(
         int ad, const int64_t* range, const std::vector<int>& attribute_ids) const ;
+    /*
+     * Forward iterator over multiple subarrays with disjoint row blocks, cells are returned in
+     * column major order. ranges contains 4 values (row begin, row end, column begin, column end) per subarray
+     * If buffer_budget is non-0, the read buffers of the iterator are sized per attribute to total about
+     * buffer_budget bytes (see VariantArrayCellIterator), else every buffer has the segment size. The budget is
+     * a target, not a cap - the share of every subarray is at least 64KB and every buffer is at least 64KB, so
+     * small budgets, many attributes or many subarrays exceed it
+     */
+    VariantArrayCellIterator* begin(
+        int ad, const std::vector<int64_t>& ranges, const std::vector<int>& attribute_ids,
+        const size_t buffer_budget=0u) const ;
+    /*
+     * Forward iterator over the cells of multiple open arrays with the same schema (for example, column partitions)
+     * - cells from all the arrays are merged in column major order. The buffer size/budget is split across the
+     * arrays. Every array is read only within its column partition (see set_column_partition()).
+     * Throws VariantStorageManagerException if the schemas differ
+     */
+    VariantArrayCellIterator* begin(
+        const std::vector<int>& ads, const std::vector<int64_t>& ranges, const std::vector<int>& attribute_ids,
+        const size_t buffer_budget=0u) const ;
+    /*
+     * Same as above, but every array is scanned on its own thread which reads ahead up to prefetch_depth batches
+     * of batch_size cells - suited to row partitions, where the cells of all the arrays are interleaved.
+     * Every array is read only within its row partition (see set_row_partition()), arrays without any rows in
+     * ranges are not read at all. Every array gets its own read buffers - the buffer budget, if non-0, is split
+     * across the arrays that are read
+     */
+    VariantArrayCellIterator* begin_with_array_threads(
+        const std::vector<int>& ads, const std::vector<int64_t>& ranges, const std::vector<int>& attribute_ids,
+        const unsigned prefetch_depth, const size_t batch_size, const size_t buffer_budget=0u) const ;
+    /*
+     * Max #subarrays of an iterator over num_arrays arrays such that the read buffers of the iterator still total
+     * the segment size (or buffer_budget, if non-0) - beyond this, every subarray gets a minimum buffer size
+     * and the total grows with the #subarrays
+     */
+    unsigned get_max_num_subarrays(const unsigned num_arrays, const size_t buffer_budget=0u) const;
     /*
      * Write sorted cell
      */
     void write_cell_sorted(const int ad, const void* ptr);
+    /*
+     * Write to the array in a background thread - see VariantArrayInfo::enable_async_writes()
+     */
+    void enable_async_writes(const int ad);
     /*
      * Return #valid rows in the array
      */
     int64_t get_num_valid_rows_in_array(const int ad) const;
+    /*
+     * Return max (END - begin column) over all cells in the array, -1 if unknown
+     */
+    int64_t get_max_interval_length(const int ad) const;
+    /*
+     * Return sidecar tile index of the array, 0 if the array has no index
+     */
+    const VariantArrayTileIndex* get_tile_index(const int ad) const;
+    /*
+     * Columns owned by the array when it is read together with other column partitions by begin() - the
+     * loader also writes intervals spanning the begin of a partition into the partition. Default: all columns
+     */
+    void set_column_partition(const int ad, const ColumnRange& column_partition);
+    /*
+     * Rows owned by the array when it is read together with other row partitions by begin_with_array_threads().
+     * Default: all rows
+     */
+    void set_row_partition(const int ad, const RowRange& row_partition);
     /*
      * Update row bounds in the metadata
      */
@@ -244,6 +699,18 @@ class VariantStorageManager
      * Return workspace path
      */
     const std::string& get_workspace() const { return m_workspace; }
+  private:
+    /*
+     * Throws VariantStorageManagerException if any of the arrays is not open or its schema differs from the
+     * schema of the first array
+     */
+    void check_compatible_arrays(const std::vector<int>& ads) const;
+    /*
+     * Appends to clipped_ranges the subarrays in ranges (4 values per subarray) intersected with the row and column
+     * partitions of the array - empty intersections are dropped. Returns #subarrays appended
+     */
+    unsigned clip_ranges_to_partition(const int ad, const std::vector<int64_t>& ranges,
+        std::vector<int64_t>& clipped_ranges) const;
   private:
     static const std::unordered_map<std::string, int> m_mode_string_to_int;
     //TileDB context
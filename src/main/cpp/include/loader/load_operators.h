@@ -240,7 +240,6 @@ class LoaderCombinedGVCFOperator : public LoaderOperatorBase
     ColumnRange m_partition;
     //PQ and aux structures
     VariantCallEndPQ m_end_pq;
-    std::vector<VariantCall*> m_tmp_pq_vector;
     //Position trackers
     int64_t m_current_start_position;
     int64_t m_next_start_position;
@@ -60,6 +60,9 @@ class BroadCombinedGVCFOperator : public GA4GHOperator
     virtual ~BroadCombinedGVCFOperator()
     {
       bcf_destroy(m_bcf_out);
+      bcf_destroy(m_pending_bcf_out);
+      free(m_curr_FORMAT_buffer);
+      free(m_pending_FORMAT_buffer);
       clear();
 #ifdef DO_PROFILING
       m_bcf_t_creation_timer.print("bcf_t creation time", std::cerr);
@@ -69,13 +72,40 @@ class BroadCombinedGVCFOperator : public GA4GHOperator
     void switch_contig();
     virtual void operate(Variant& variant, const VariantQueryConfig& query_config);
     inline bool overflow() const { return m_vcf_adapter->overflow(); }
+    /*
+     * Reference block records held back for GQ banding are never merged across column intervals. Scans that
+     * stop because the buffer is full keep the pending record - sub-intervals produced by
+     * VariantQueryProcessor::split_column_intervals() begin at variant cells when GQ bands are used, so the
+     * pending record could not have been extended past the end of a sub-interval either
+     */
+    virtual void end_column_interval(const unsigned interval_idx) { flush_pending_record(); }
+    /*
+     * The pending record is part of the state of a scan that stopped when the buffer filled up
+     */
+    void checkpoint_pending_record(std::vector<uint8_t>& buffer, uint64_t& offset);
+    void restore_pending_record(const std::vector<uint8_t>& buffer, uint64_t& offset);
     bool handle_VCF_field_combine_operation(const Variant& variant,
         const INFO_tuple_type& curr_tuple, void*& result_ptr, unsigned& num_result_elements);
     void handle_INFO_fields(const Variant& variant);
     void handle_FORMAT_fields(const Variant& variant);
     void handle_deletions(Variant& variant, const VariantQueryConfig& query_config);
   private:
+    /*
+     * GQ banding - m_bcf_out is held back as the pending record if it is a reference block, adjacent reference
+     * blocks whose per-sample GQ values fall in the same bands and whose INFO fields (other than END) are
+     * identical extend the pending record
+     */
+    void band_or_handoff_record();
+    void flush_pending_record();
+    //Returns false if line has no GQ values
+    bool get_GQ_band_vector(bcf1_t* line, std::vector<int>& GQ_band_vector);
+    //Per-sample minimum of the FORMAT field in m_bcf_out and the pending record is stored in the pending record
+    void merge_FORMAT_field_minimum(const char* field_name);
+    //INFO fields other than END have the same values - END is set when the pending record is flushed
+    bool have_same_INFO_fields(bcf1_t* line, bcf1_t* other_line) const;
     bool m_use_missing_values_not_vector_end;
+    //No FORMAT fields or samples in the output
+    bool m_sites_only;
     const VariantQueryConfig* m_query_config;
     VCFAdapter* m_vcf_adapter;
     const VidMapper* m_vid_mapper;
@@ -108,10 +138,63 @@ class BroadCombinedGVCFOperator : public GA4GHOperator
     std::vector<int> m_spanning_deletion_remapped_GT;
     //Allowed bases
     static const std::unordered_set<char> m_legal_bases;
+    //GQ band boundaries - empty if banding is disabled
+    std::vector<int> m_GQ_bands;
+    //Pending record - valid if m_pending_column_end >= 0
+    bcf1_t* m_pending_bcf_out;
+    size_t m_pending_bcf_record_size;
+    int64_t m_pending_column_begin;
+    int64_t m_pending_column_end;
+    int64_t m_pending_contig_begin_position;
+    std::vector<int> m_pending_GQ_band_vector;
+    std::vector<int> m_curr_GQ_band_vector;
+    //Buffers for bcf_get_format_int32()
+    int* m_curr_FORMAT_buffer;
+    int m_curr_FORMAT_buffer_size;
+    int* m_pending_FORMAT_buffer;
+    int m_pending_FORMAT_buffer_size;
     //For profiling
     Timer m_bcf_t_creation_timer;
 };
 
+/*
+ * Passes serialized records produced by VariantQueryProcessor::scan_and_operate_parallel() to a VCFAdapter
+ */
+class VCFAdapterScanOutputWriter : public ScanOutputWriterBase
+{
+  public:
+    VCFAdapterScanOutputWriter(VCFAdapter& vcf_adapter) : ScanOutputWriterBase(), m_vcf_adapter(&vcf_adapter) { ; }
+    void write(const uint8_t* data, const size_t num_bytes) { m_vcf_adapter->write_serialized_buffer(data, num_bytes); }
+  private:
+    VCFAdapter* m_vcf_adapter;
+};
+
+/*
+ * One BroadCombinedGVCFOperator per thread for VariantQueryProcessor::scan_and_operate_parallel()
+ * Each operator has its own VCFSerializedBufferAdapter (with its own copy of the header and reference genome
+ * handle) and writes to its own buffer.
+ * NOTE: must be constructed before the header of vcf_adapter is modified by a BroadCombinedGVCFOperator
+ */
+class BroadCombinedGVCFOperatorSet
+{
+  public:
+    BroadCombinedGVCFOperatorSet(const VCFAdapter& vcf_adapter, const VidMapper& id_mapper, const VariantQueryConfig& query_config,
+        const unsigned num_threads,
+        const unsigned max_diploid_alt_alleles_that_can_be_genotyped=MAX_DIPLOID_ALT_ALLELES_THAT_CAN_BE_GENOTYPED,
+        const bool use_missing_values_only_not_vector_end=false);
+    ~BroadCombinedGVCFOperatorSet();
+    //Delete copy and move constructors
+    BroadCombinedGVCFOperatorSet(const BroadCombinedGVCFOperatorSet& other) = delete;
+    BroadCombinedGVCFOperatorSet(BroadCombinedGVCFOperatorSet&& other) = delete;
+    unsigned get_num_threads() const { return m_operators.size(); }
+    const std::vector<SingleVariantOperatorBase*>& get_operators() const { return m_operators; }
+    const std::vector<RWBuffer*>& get_buffers() const { return m_buffers; }
+  private:
+    std::vector<VCFSerializedBufferAdapter*> m_vcf_adapters;
+    std::vector<RWBuffer*> m_buffers;
+    std::vector<SingleVariantOperatorBase*> m_operators;
+};
+
 #endif //ifdef HTSDIR
 
 #endif
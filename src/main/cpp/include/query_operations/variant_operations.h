@@ -25,6 +25,9 @@
 
 #include "variant.h"
 #include "lut.h"
+#include <deque>
+
+class VariantQueryProcessor;
 
 class VariantOperationException : public std::exception {
   public:
@@ -128,6 +131,17 @@ class VariantOperations
     static void do_dummy_genotyping(Variant& variant, std::ostream& output);
 };
 
+/*
+ * Receives the serialized output produced by the per-thread operators in
+ * VariantQueryProcessor::scan_and_operate_parallel(). Data is always handed over in column interval order
+ */
+class ScanOutputWriterBase
+{
+  public:
+    virtual ~ScanOutputWriterBase() { ; }
+    virtual void write(const uint8_t* data, const size_t num_bytes) = 0;
+};
+
 /*
  * Base class for all operations that want to operate on Variant objects created by scan/gt_get_column functions
  */
@@ -155,6 +169,12 @@ class SingleVariantOperatorBase
      * is full. Default implementation: return false
      */
     virtual bool overflow() const { return false; }
+    /*
+     * Called by CoalescedColumnIntervalsOperator before the first and after the last operate() call for
+     * each queried column interval. Default implementation: do nothing
+     */
+    virtual void begin_column_interval(const unsigned interval_idx, const ColumnRange& interval) { ; }
+    virtual void end_column_interval(const unsigned interval_idx) { ; }
   protected:
     //Maintain mapping between alleles in input VariantCalls and merged allele list
     CombineAllelesLUT m_alleles_LUT;
@@ -170,6 +190,60 @@ class SingleVariantOperatorBase
     bool m_is_reference_block_only;
 };
 
+/*
+ * Wraps the operator for scans over coalesced column intervals (see VariantQueryConfig::coalesce_column_intervals()).
+ * The scan also covers the gaps between the queried (target) intervals - Variants are clipped to the
+ * target intervals and passed to the wrapped operator, Variants in the gaps are dropped. The wrapped
+ * operator sees the same sequence of Variants as it would with a separate scan per target interval.
+ * When the wrapped operator overflows, the rest of the current Variant is copied and passed on
+ * once the scan resumes - the same stop/resume contract as the non-coalesced scans
+ */
+class CoalescedColumnIntervalsOperator : public SingleVariantOperatorBase
+{
+  public:
+    CoalescedColumnIntervalsOperator(SingleVariantOperatorBase& variant_operator, const std::vector<ColumnRange>& target_intervals)
+      : SingleVariantOperatorBase(), m_variant_operator(&variant_operator), m_target_intervals(target_intervals)
+    {
+      m_next_target_idx = 0u;
+      m_curr_target_idx = UNDEFINED_TARGET_IDX;
+      m_query_config = 0;
+    }
+    virtual void operate(Variant& variant, const VariantQueryConfig& query_config);
+    virtual bool overflow() const { return m_variant_operator->overflow(); }
+    //Scans cover whole coalesced intervals - the current target ends with the scanned interval
+    virtual void end_column_interval(const unsigned interval_idx) { finalize(); }
+    /*
+     * Must be called after the scans are complete - closes the last target interval
+     */
+    void finalize();
+    /*
+     * Target tracking and the pending Variants - part of the GenomicsDBBCFGenerator checkpoint
+     * Pending Variants are written with Variant::binary_serialize()
+     */
+    void checkpoint_state(std::vector<uint8_t>& buffer, uint64_t& offset) const;
+    void restore_state(const VariantQueryProcessor& query_processor, const VariantQueryConfig& query_config,
+        const std::vector<uint8_t>& buffer, uint64_t& offset);
+  private:
+    void switch_target(const unsigned target_idx);
+    /*
+     * Passes variant to the wrapped operator for targets starting at target_idx
+     * Returns the first target not handled because the wrapped operator overflowed, else UNDEFINED_TARGET_IDX
+     */
+    unsigned operate_on_targets(Variant& variant, unsigned target_idx);
+    //Passes on pending Variants until they are exhausted or the wrapped operator overflows
+    void flush_pending_variants();
+    static const unsigned UNDEFINED_TARGET_IDX = UINT_MAX;
+    SingleVariantOperatorBase* m_variant_operator;
+    std::vector<ColumnRange> m_target_intervals;
+    //Targets before m_next_target_idx end before the current Variant
+    unsigned m_next_target_idx;
+    unsigned m_curr_target_idx;
+    const VariantQueryConfig* m_query_config;
+    //Copies of Variants not fully passed on due to overflow and the first target still to be handled for each
+    std::deque<Variant> m_pending_variants;
+    std::deque<unsigned> m_pending_target_idxs;
+};
+
 class MaxAllelesCountOperator : public SingleVariantOperatorBase
 {
   public:
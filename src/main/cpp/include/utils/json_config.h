@@ -67,6 +67,7 @@ class JSONConfigBase
     void read_from_file(const std::string& filename, const VidMapper* id_mapper=0);
     const std::string& get_workspace(const int rank) const;
     const std::string& get_array_name(const int rank) const;
+    const std::vector<std::string>& get_array_names() const { return m_array_names; }
     ColumnRange get_column_partition(const int rank, const unsigned idx=0u) const;
     RowRange get_row_partition(const int rank, const unsigned idx=0u) const;
     const std::vector<ColumnRange> get_sorted_column_partitions() const { return m_sorted_column_partitions; }
@@ -74,6 +75,11 @@ class JSONConfigBase
     const std::vector<ColumnRange>& get_query_column_ranges(const int rank) const;
     const std::vector<RowRange>& get_query_row_ranges(const int rank) const;
   protected:
+    /*
+     * Appends the intervals in the BED file (columns: contig, 0-based start, exclusive end) to column_ranges
+     */
+    void read_column_ranges_from_bed_file(const std::string& filename, const VidMapper* id_mapper,
+        std::vector<ColumnRange>& column_ranges);
     bool m_single_workspace_path;
     bool m_single_array_name;
     bool m_single_query_column_ranges_vector;
@@ -103,10 +109,37 @@ class JSONLoaderConfig;
 class JSONBasicQueryConfig : public JSONConfigBase
 {
   public:
-    JSONBasicQueryConfig() : JSONConfigBase()  { }
+    JSONBasicQueryConfig() : JSONConfigBase()
+    {
+      m_balance_column_intervals_across_ranks = false;
+      m_merge_array_partitions = false;
+    }
     void read_from_file(const std::string& filename, VariantQueryConfig& query_config, FileBasedVidMapper* id_mapper=0, int rank=0, JSONLoaderConfig* loader_config=0);
     void update_from_loader(JSONLoaderConfig* loader_config, const int rank);
     void subset_query_column_ranges_based_on_partition(const JSONLoaderConfig* loader_config, const int rank);
+    /*
+     * True if "balance_column_intervals" is set and all ranks query the same array - query_config then holds the
+     * column ranges of all ranks and the caller must pick its share with VariantQueryProcessor::balance_column_intervals()
+     */
+    inline bool balance_column_intervals_across_ranks() const { return m_balance_column_intervals_across_ranks; }
+    /*
+     * True if "merge_array_partitions" is set - every rank queries all the arrays in get_array_names() (the column
+     * or row partitions of the workspace) through a single merged iterator, see VariantQueryProcessor
+     */
+    inline bool merge_array_partitions() const { return m_merge_array_partitions; }
+    /*
+     * Column partition of every array in get_array_names() if merge_array_partitions() is set and the partitions
+     * are known (from the loader JSON or "column_partitions" in the query JSON), else empty. read_from_file() throws
+     * RunConfigException if the partitions of only some of the arrays are known
+     */
+    inline const std::vector<ColumnRange>& get_array_column_partitions() const { return m_array_column_partitions; }
+    //Same for row partitions ("row_partitions" in the query JSON)
+    inline const std::vector<RowRange>& get_array_row_partitions() const { return m_array_row_partitions; }
+  private:
+    bool m_balance_column_intervals_across_ranks;
+    bool m_merge_array_partitions;
+    std::vector<ColumnRange> m_array_column_partitions;
+    std::vector<RowRange> m_array_row_partitions;
 };
 
 class JSONLoaderConfig : public JSONConfigBase
@@ -128,6 +161,8 @@ class JSONLoaderConfig : public JSONConfigBase
     inline bool delete_and_create_tiledb_array() const { return m_delete_and_create_tiledb_array; }
     inline size_t get_segment_size() const { return m_segment_size; }
     inline size_t get_num_cells_per_tile() const { return m_num_cells_per_tile; }
+    inline bool build_tile_index() const { return m_build_tile_index; }
+    inline bool async_tiledb_writes() const { return m_async_tiledb_writes; }
     inline const std::string& get_vid_mapping_filename() const { return m_vid_mapping_file; }
     inline const std::string& get_callset_mapping_filename() const { return m_callset_mapping_file; }
     inline RowRange get_row_bounds() const { return RowRange(m_lb_callset_row_idx, m_ub_callset_row_idx); }
@@ -164,6 +199,10 @@ class JSONLoaderConfig : public JSONConfigBase
     size_t m_segment_size;
     //TileDB array #cells/tile
     size_t m_num_cells_per_tile;
+    //Maintain sidecar tile index for new arrays
+    bool m_build_tile_index;
+    //Write to TileDB in a background thread with double buffering
+    bool m_async_tiledb_writes;
     //flag to say whether vid_mapping_file is required or optional
     bool m_vid_mapper_file_required;
 };
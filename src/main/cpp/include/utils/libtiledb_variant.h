@@ -73,7 +73,8 @@ extern "C" void db_query_column_range(std::string workspace,
                                       std::vector<Variant>& variants, 
                                       VariantQueryConfig& query_config,
                                       const VidMapper& vid_mapper,
-                                      GA4GHPagingInfo* paging_info=0);
+                                      GA4GHPagingInfo* paging_info=0,
+                                      VariantPool* variant_pool=0);
 
 extern "C" void db_cleanup();
 
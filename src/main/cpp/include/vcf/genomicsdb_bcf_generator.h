@@ -38,7 +38,8 @@ class GenomicsDBBCFGenerator
         int my_rank=0, size_t buffer_capacity=DEFAULT_COMBINED_VCF_RECORDS_BUFFER_SIZE, size_t tiledb_segment_size=1048576u,
         const char* output_format="bu",
         const bool use_missing_values_only_not_vector_end=false,
-        const bool keep_idx_fields_in_bcf_header=true);
+        const bool keep_idx_fields_in_bcf_header=true,
+        const std::vector<uint8_t>* checkpoint=0);
     GenomicsDBBCFGenerator(const std::string& loader_config_file, const std::string& query_config_file, int my_rank=0,
         size_t buffer_capacity=DEFAULT_COMBINED_VCF_RECORDS_BUFFER_SIZE, size_t tiledb_segment_size=1048576u, const char* output_format="bu",
         const bool use_missing_values_only_not_vector_end=false)
@@ -66,12 +67,33 @@ class GenomicsDBBCFGenerator
     size_t read_and_advance(uint8_t* dst, size_t offset, size_t n);
     uint8_t read_next_byte();
     inline bool end() const { return m_done; }
+    /*
+     * Checkpoint of the scan position right after the last byte produced so far (including bytes in the
+     * read buffer not yet consumed by the caller). Passing the checkpoint to the constructor (with the same
+     * loader and query configs) resumes the scan from that position - the resumed stream starts with the header
+     */
+    void get_checkpoint(std::vector<uint8_t>& buffer);
   private:
+    void restore_checkpoint(const std::vector<uint8_t>& buffer);
     void set_write_buffer();
     void reset_read_buffer();
     void produce_next_batch();
+    /*
+     * Scans the next set of column intervals in parallel and appends the output to the write buffer
+     */
+    void scan_next_column_intervals_in_parallel();
+    /*
+     * Operator passed to scan_and_operate() - wraps m_combined_bcf_operator if column intervals are coalesced
+     */
+    SingleVariantOperatorBase& get_scan_operator()
+    {
+      return m_coalesced_bcf_operator ? static_cast<SingleVariantOperatorBase&>(*m_coalesced_bcf_operator)
+        : static_cast<SingleVariantOperatorBase&>(*m_combined_bcf_operator);
+    }
   private:
     bool m_done;
+    //Also bounds the output held by every thread in parallel scans
+    size_t m_buffer_capacity;
     FileBasedVidMapper m_vid_mapper;
     VariantStorageManager* m_storage_manager;
     VariantQueryProcessor* m_query_processor;
@@ -80,6 +102,10 @@ class GenomicsDBBCFGenerator
     unsigned m_query_column_interval_idx;
     VariantQueryProcessorScanState m_scan_state;
     BroadCombinedGVCFOperator* m_combined_bcf_operator;
+    //Valid only if nearby column intervals are served by a single scan
+    CoalescedColumnIntervalsOperator* m_coalesced_bcf_operator;
+    //Per thread operators, valid only if multiple column intervals are scanned in parallel
+    BroadCombinedGVCFOperatorSet* m_parallel_bcf_operators;
     //If using ping-pong buffering, then multiple buffers exist
     std::vector<RWBuffer> m_buffers;
     CircularBufferController m_buffer_control;
@@ -88,4 +114,23 @@ class GenomicsDBBCFGenerator
 #endif
 };
 
+/*
+ * Appends the output of scan_and_operate_parallel() to a RWBuffer
+ */
+class RWBufferScanOutputWriter : public ScanOutputWriterBase
+{
+  public:
+    RWBufferScanOutputWriter(RWBuffer& buffer) : ScanOutputWriterBase(), m_buffer(&buffer) { ; }
+    void write(const uint8_t* data, const size_t num_bytes)
+    {
+      auto new_size = m_buffer->m_num_valid_bytes + num_bytes;
+      if(new_size > m_buffer->m_buffer.size())
+        m_buffer->m_buffer.resize(std::max<size_t>(new_size, 2u*m_buffer->m_buffer.size()));
+      memcpy(&(m_buffer->m_buffer[m_buffer->m_num_valid_bytes]), data, num_bytes);
+      m_buffer->m_num_valid_bytes = new_size;
+    }
+  private:
+    RWBuffer* m_buffer;
+};
+
 #endif
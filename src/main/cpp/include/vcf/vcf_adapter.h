@@ -91,6 +91,11 @@ class VCFAdapter
         std::string output_filename, std::string output_format="",
         const size_t combined_vcf_records_buffer_size_limit=DEFAULT_COMBINED_VCF_RECORDS_BUFFER_SIZE,
         const bool produce_GT_field=false);
+    /*
+     * Initialize using the configuration of another adapter. The template header is duplicated and the
+     * reference genome is opened again, so the two adapters can be used by different threads
+     */
+    void initialize(const VCFAdapter& other);
     //Allocates header
     bcf_hdr_t* initialize_default_header();
     bcf_hdr_t* get_vcf_header() { return m_template_vcf_hdr; }
@@ -101,6 +106,10 @@ class VCFAdapter
      **/
     virtual void handoff_output_bcf_line(bcf1_t*& line, const size_t bcf_record_size);
     virtual void print_header();
+    /*
+     * Write records serialized by a VCFSerializedBufferAdapter (with the same format) to the output
+     */
+    virtual void write_serialized_buffer(const uint8_t* data, const size_t num_bytes);
     /*
      * Return true in child class if some output causes buffer to be full. Default: return false
      */
@@ -108,6 +117,14 @@ class VCFAdapter
     char get_reference_base_at_position(const char* contig, int pos)
     { return m_reference_genome_info.get_reference_base_at_position(contig, pos); }
     const bool produce_GT_field() const { return m_produce_GT_field; }
+    /*
+     * GQ band boundaries (sorted) - GQ values g and h are in the same band if no boundary b satisfies
+     * min(g,h) < b <= max(g,h). Adjacent reference block records whose per-sample GQ values fall in the same
+     * bands are merged into a single record by BroadCombinedGVCFOperator. Records with different INFO values
+     * (END excluded) are not merged - INFO values are never combined across the band. Empty - no banding
+     */
+    void set_GQ_bands(const std::vector<int>& GQ_bands);
+    const std::vector<int>& get_GQ_bands() const { return m_GQ_bands; }
   protected:
     bool m_open_output;
     //Output file
@@ -116,6 +133,7 @@ class VCFAdapter
     std::string m_vcf_header_filename;
     bcf_hdr_t* m_template_vcf_hdr;
     //Reference genome info
+    std::string m_reference_genome;
     ReferenceGenomeInfo m_reference_genome_info;
     //Output fptr
     htsFile* m_output_fptr;
@@ -124,6 +142,8 @@ class VCFAdapter
     size_t m_combined_vcf_records_buffer_size_limit;
     //GATK CombineGVCF does not produce GT field by default - option to produce GT
     bool m_produce_GT_field;
+    //GQ band boundaries for merging reference block records
+    std::vector<int> m_GQ_bands;
 #ifdef DO_PROFILING
     //Timer
     Timer m_vcf_serialization_timer;
@@ -194,6 +214,12 @@ class VCFSerializedBufferAdapter: public VCFAdapter
       auto write_size = fwrite(&(m_rw_buffer->m_buffer[0]), 1u,  m_rw_buffer->m_num_valid_bytes, m_write_fptr);
       assert(write_size == m_rw_buffer->m_num_valid_bytes);
     }
+    void write_serialized_buffer(const uint8_t* data, const size_t num_bytes)
+    {
+      assert(m_write_fptr);
+      auto write_size = fwrite(data, 1u, num_bytes, m_write_fptr);
+      assert(write_size == num_bytes);
+    }
   private:
     bool m_keep_idx_fields_in_bcf_header;
     RWBuffer* m_rw_buffer;
@@ -26,6 +26,15 @@
 
 using namespace std;
 
+//Max #subarrays (blocks of queried rows) in a forward iterator - nearby blocks are merged beyond this
+#define MAX_NUM_ROW_BLOCKS_IN_FORWARD_ITER 32u
+//#cells per batch for operators that consume batches, if the query does not specify the batch size
+#define DEFAULT_CELL_BATCH_SIZE 1024u
+//#batches read ahead by the thread of every partition when partitions are scanned in threads
+#define DEFAULT_PARTITION_PREFETCH_DEPTH 2u
+//Warn about arrays with more fragments than this - every query reads all the fragments
+#define NUM_FRAGMENTS_WARNING_THRESHOLD 64
+
 #if 0
 //Utility functions
 //Search for cell with given search value
@@ -83,7 +92,10 @@ GTProfileStats::GTProfileStats()
       "GT_NUM_VALID_CELLS_IN_QUERY",//#valid cells actually returned in query 
       "GT_NUM_ATTR_CELLS_ACCESSED",//#attribute cells accessed in the query
       "GT_NUM_PQ_FLUSHES_DUE_TO_OVERLAPPING_CELLS",//#times PQ gets flushed due to overlapping cells in the input
-      "GT_NUM_OPERATOR_INVOCATIONS" //#times operator gets invoked
+      "GT_NUM_OPERATOR_INVOCATIONS", //#times operator gets invoked
+      "GT_NUM_CELLS_REJECTED_BY_FILTER", //#cells dropped by the per-call filter before any field is decoded
+      "GT_NUM_VARIANT_ALLOCATIONS", //#Variant objects allocated by interval queries (not obtained from a VariantPool)
+      "GT_NUM_VARIANT_CALL_ALLOCATIONS" //#VariantCall objects allocated by interval queries
   };
 }
 
@@ -111,6 +123,8 @@ void GTProfileStats::print_stats(std::ostream& fptr) const
 
 //Static members
 bool VariantQueryProcessor::m_are_static_members_initialized = false;
+std::set<std::string> VariantQueryProcessor::m_arrays_checked_for_fragments;
+std::mutex VariantQueryProcessor::m_arrays_checked_for_fragments_mutex;
 unordered_map<type_index, shared_ptr<VariantFieldCreatorBase>> VariantQueryProcessor::m_type_index_to_creator;
 
 //Initialize static members function
@@ -219,10 +233,54 @@ VariantQueryProcessor::VariantQueryProcessor(VariantStorageManager* storage_mana
   m_ad = storage_manager->open_array(array_name, "r");
   if(m_ad < 0)
     throw VariantQueryProcessorException("Could not open array "+array_name+" at workspace: "+storage_manager->get_workspace());
+  m_partition_ads.assign(1u, m_ad);
   m_array_schema = new VariantArraySchema();
   auto status = storage_manager->get_array_schema(m_ad, m_array_schema);
   assert(status == TILEDB_OK);
   initialize();
+  warn_if_many_fragments();
+}
+
+void VariantQueryProcessor::warn_if_many_fragments() const
+{
+  for(auto ad : m_partition_ads)
+  {
+    //Once per array per process - query processors over the same array are created repeatedly by some tools
+    {
+      std::lock_guard<std::mutex> lock(m_arrays_checked_for_fragments_mutex);
+      if(!m_arrays_checked_for_fragments.insert(m_storage_manager->get_workspace()+'/'
+            +m_storage_manager->get_array_name(ad)).second)
+        continue;
+    }
+    auto num_fragments = m_storage_manager->get_num_fragments(ad);
+    if(num_fragments > NUM_FRAGMENTS_WARNING_THRESHOLD)
+      std::cerr << "[GenomicsDB::VariantQueryProcessor] WARNING: array "
+        << m_storage_manager->get_workspace() << '/' << m_storage_manager->get_array_name(ad)
+        << " has " << num_fragments << " fragments - queries will be faster after running consolidate_tiledb_array\n";
+  }
+}
+
+VariantQueryProcessor::VariantQueryProcessor(VariantStorageManager* storage_manager,
+    const std::vector<std::string>& array_names)
+{
+  //initialize static members
+  if(!VariantQueryProcessor::m_are_static_members_initialized)
+    VariantQueryProcessor::initialize_static_members();
+  clear();
+  if(array_names.empty())
+    throw VariantQueryProcessorException("No arrays to query at workspace: "+storage_manager->get_workspace());
+  m_storage_manager = storage_manager;
+  m_partition_ads = storage_manager->open_arrays(array_names, "r");
+  for(auto i=0ull;i<array_names.size();++i)
+    if(m_partition_ads[i] < 0)
+      throw VariantQueryProcessorException("Could not open array "+array_names[i]+" at workspace: "
+          +storage_manager->get_workspace());
+  m_ad = m_partition_ads[0u];
+  m_array_schema = new VariantArraySchema();
+  auto status = storage_manager->get_array_schema(m_ad, m_array_schema);
+  assert(status == TILEDB_OK);
+  initialize();
+  warn_if_many_fragments();
 }
 
 VariantQueryProcessor::VariantQueryProcessor(const VariantArraySchema& array_schema)
@@ -282,6 +340,8 @@ void VariantQueryProcessor::handle_gvcf_ranges(VariantCallEndPQ& end_pq,
     min_end_point = num_calls_with_deletions ? current_start_position : min_end_point;
     //Prepare variant for aligned column interval
     variant.set_column_interval(current_start_position, min_end_point);
+    //Calls may have been added/removed since the last invocation of the operator
+    variant.update_active_calls();
 #ifdef DO_PROFILING
     stats_ptr->m_operator_timer.start();
     stats_ptr->update_stat(GTProfileStats::GT_NUM_OPERATOR_INVOCATIONS, 1u);
@@ -329,11 +389,24 @@ void VariantQueryProcessor::scan_and_operate(
   variant.resize_based_on_query();
   //Number of calls with deletions
   uint64_t num_calls_with_deletions = scan_state ? scan_state->get_num_calls_with_deletions() : 0ull;
-  //Used when deletions have to be treated as intervals and the PQ needs to be emptied
-  std::vector<VariantCall*> tmp_pq_buffer(query_config.get_num_rows_to_query());
+  //Prefetching iterators hand out cells in batches (struct-of-arrays) - batch state is part of the scan state,
+  //since the iterator has already moved past the cells in the batch
+  auto cell_batch_size = query_config.get_cell_batch_size();
+  VariantCellBatch local_cell_batch;
+  uint64_t local_cell_batch_idx = 0ull;
+  VariantCellBatch& cell_batch = scan_state ? scan_state->get_cell_batch() : local_cell_batch;
+  uint64_t& cell_batch_idx = scan_state ? scan_state->get_cell_batch_idx() : local_cell_batch_idx;
+  BufferVariantCell batch_cell(get_array_schema(), query_config);
+  if(cell_batch_size > 0u && cell_batch.get_num_queried_attributes() != query_config.get_num_queried_attributes())
+  {
+    cell_batch.initialize(query_config.get_num_queried_attributes(),
+        query_config.is_defined_query_idx_for_known_field_enum(GVCF_END_IDX)
+        ? query_config.get_query_idx_for_known_field_enum(GVCF_END_IDX) : -1);
+    cell_batch_idx = 0ull;
+  }
   //Forward iterator
   VariantArrayCellIterator* forward_iter = 0;
-  if(scan_state && scan_state->m_iter && scan_state->m_current_start_position >= 0) //resuming a previous scan
+  if(scan_state && scan_state->in_progress()) //resuming a previous scan
   {
     current_start_position = scan_state->m_current_start_position;
     forward_iter = scan_state->m_iter;
@@ -343,6 +416,11 @@ void VariantQueryProcessor::scan_and_operate(
   }
   else //new scan
   {
+    //A reused scan state holds the calls and PQ entries of the previous interval - active call tracking
+    //must be off, else gt_get_column() resets the active calls and the loop below visits no calls
+    end_pq.clear();
+    variant.disable_active_calls_tracking();
+    variant.reset_for_new_interval();
     //Scan only queried interval, not whole array
     if(query_config.get_num_column_intervals() > 0u)
     {
@@ -356,7 +434,7 @@ void VariantQueryProcessor::scan_and_operate(
       for(Variant::valid_calls_iterator iter=variant.begin();iter != variant.end();++iter)
       {
         auto& curr_call = *iter;
-        end_pq.push(&curr_call);
+        end_pq.push(&curr_call, iter.get_call_idx_in_variant());
         if(handle_spanning_deletions && curr_call.contains_deletion())
           ++num_calls_with_deletions;
         assert(end_pq.size() <= query_config.get_num_rows_to_query());
@@ -368,50 +446,115 @@ void VariantQueryProcessor::scan_and_operate(
       //by gt_get_column(). Hence, must start from next column
       start_column = query_config.get_column_begin(column_interval_idx) + 1;
     }
+    //Operators iterate only over calls in the END priority queue
+    variant.enable_active_calls_tracking();
+    cell_batch.clear();
+    cell_batch_idx = 0ull;
     //Initialize forward scan iterators
-    gt_initialize_forward_iter(ad, query_config, start_column, forward_iter);
+    gt_initialize_forward_iter(ad, query_config, start_column, forward_iter,
+        get_forward_iter_end_column(query_config, column_interval_idx, cell_batch_size));
+    gt_start_prefetch(query_config, forward_iter, cell_batch_size);
   }
+  auto use_cell_batches = (forward_iter && forward_iter->is_prefetching()) || cell_batch_idx < cell_batch.size();
   //If uninitialized, store first column idx of forward scan in current_start_position
-  if(current_start_position < 0 && !(forward_iter->end()))
+  if(current_start_position < 0)
   {
-    auto& cell = **forward_iter;
-    //Coordinates are at the start of the cell
-    current_start_position = cell.get_begin_column();
+    if(use_cell_batches)
+    {
+      if(cell_batch_idx >= cell_batch.size() && forward_iter && !(forward_iter->end()))
+      {
+        forward_iter->fill_batch(cell_batch);
+        cell_batch_idx = 0ull;
+      }
+      if(cell_batch_idx < cell_batch.size())
+        current_start_position = cell_batch.get_columns()[cell_batch_idx];
+    }
+    else
+      if(forward_iter && !(forward_iter->end()))
+      {
+        auto& cell = **forward_iter;
+        //Coordinates are at the start of the cell
+        current_start_position = cell.get_begin_column();
+      }
   }
   //Set current column for variant (end is un-important as Calls are used to track end of intervals)
   variant.set_column_interval(current_start_position, current_start_position);
   //Next co-ordinate to consider
   int64_t next_start_position = -1ll;
   auto end_loop = false;
-  for(;!(forward_iter->end()) && !end_loop && (scan_state == 0 || !(variant_operator.overflow()));++(*forward_iter))
+  if(use_cell_batches)
   {
-    auto& cell = **forward_iter;
+    while(!end_loop && (scan_state == 0 || !(variant_operator.overflow())))
+    {
+      if(cell_batch_idx >= cell_batch.size())
+      {
+        if(!forward_iter || forward_iter->end())
+          break;
+        forward_iter->fill_batch(cell_batch);
+        cell_batch_idx = 0ull;
+      }
 #ifdef DO_PROFILING
-    stats_ptr->update_stat(GTProfileStats::GT_NUM_CELLS, 1u);
-    stats_ptr->update_stat(GTProfileStats::GT_NUM_ATTR_CELLS_ACCESSED, query_config.get_num_queried_attributes());
+      stats_ptr->update_stat(GTProfileStats::GT_NUM_CELLS, 1u);
+      stats_ptr->update_stat(GTProfileStats::GT_NUM_ATTR_CELLS_ACCESSED, query_config.get_num_queried_attributes());
 #endif
 #ifdef DUPLICATE_CELL_AT_END
-    //Ignore cell copies at END positions
-    auto cell_column_value = cell.get_begin_column();
-    auto END_v = *(cell.get_field_ptr_for_query_idx<int64_t>(query_config.get_query_idx_for_known_field_enum(GVCF_END_IDX)));
-    if(cell_column_value > END_v)
-      continue;
+      //Ignore cell copies at END positions - no need to look at the other attributes
+      if(cell_batch.get_columns()[cell_batch_idx] > cell_batch.get_END_values()[cell_batch_idx])
+      {
+        ++cell_batch_idx;
+        continue;
+      }
 #endif
-    end_loop = scan_handle_cell(query_config, column_interval_idx, variant, variant_operator, cell,
-        end_pq, tmp_pq_buffer, current_start_position, next_start_position, num_calls_with_deletions, handle_spanning_deletions, stats_ptr);
-    //Do not increment the iterator if buffer overflows in the operator
-    if(scan_state && variant_operator.overflow())
-      break;
+      cell_batch.set_cell(batch_cell, cell_batch_idx);
+      end_loop = scan_handle_cell(query_config, column_interval_idx, variant, variant_operator, batch_cell,
+          end_pq, current_start_position, next_start_position, num_calls_with_deletions, handle_spanning_deletions, stats_ptr);
+      //Same as below - cell is processed again when the scan resumes
+      if(end_loop || (scan_state && variant_operator.overflow()))
+        break;
+      ++cell_batch_idx;
+    }
   }
-  //Loop is over - no more data available from TileDB array
-  if(end_loop || forward_iter->end())
+  else
+    for(;forward_iter && !(forward_iter->end()) && !end_loop && (scan_state == 0 || !(variant_operator.overflow()));++(*forward_iter))
+    {
+      auto& cell = **forward_iter;
+#ifdef DO_PROFILING
+      stats_ptr->update_stat(GTProfileStats::GT_NUM_CELLS, 1u);
+      stats_ptr->update_stat(GTProfileStats::GT_NUM_ATTR_CELLS_ACCESSED, query_config.get_num_queried_attributes());
+#endif
+#ifdef DUPLICATE_CELL_AT_END
+      //Ignore cell copies at END positions
+      auto cell_column_value = cell.get_begin_column();
+      auto END_v = *(cell.get_field_ptr_for_query_idx<int64_t>(query_config.get_query_idx_for_known_field_enum(GVCF_END_IDX)));
+      if(cell_column_value > END_v)
+        continue;
+#endif
+      end_loop = scan_handle_cell(query_config, column_interval_idx, variant, variant_operator, cell,
+          end_pq, current_start_position, next_start_position, num_calls_with_deletions, handle_spanning_deletions, stats_ptr);
+      //Do not increment the iterator if buffer overflows in the operator
+      //Do not increment the iterator if the cell is beyond the queried interval - else if this is the last cell in the array,
+      //the last call to handle_gvcf_ranges() would treat the calls as ending beyond the queried interval
+      if(end_loop || (scan_state && variant_operator.overflow()))
+        break;
+    }
+  //No more data available from TileDB array - iterator is NULL if restored from a checkpoint taken at the end
+  auto no_more_cells = (!forward_iter || forward_iter->end()) && cell_batch_idx >= cell_batch.size();
+  //Loop is over
+  if(end_loop || no_more_cells)
   {
     next_start_position =  (query_config.get_num_column_intervals() > 0u)
       ? query_config.get_column_end(column_interval_idx)+1 //terminate at queried end
       : 0; //else don't bother with next_start_position, forward_iter->end() must be true
+    //An iterator that stops at the end of the interval may have cells beyond it - calls are terminated
+    //at the queried end, as if a cell beyond the interval had been seen
+    auto is_last_call = no_more_cells
+      && get_forward_iter_end_column(query_config, column_interval_idx, cell_batch_size) == INT64_MAX;
     //handle last interval
     handle_gvcf_ranges(end_pq, query_config, variant, variant_operator, current_start_position, next_start_position,
-        forward_iter->end(), num_calls_with_deletions, stats_ptr);
+        is_last_call, num_calls_with_deletions, stats_ptr);
+    //Operators that hold back output (GQ banding) must emit it at the end of the column interval
+    if(!variant_operator.overflow())
+      variant_operator.end_column_interval(column_interval_idx);
     if(!variant_operator.overflow())
       delete forward_iter;
 #ifdef DO_PROFILING
@@ -436,10 +579,456 @@ void VariantQueryProcessor::scan_and_operate(
   }
 }
 
+//Magic bytes at the start of a scan state checkpoint
+#define SCAN_STATE_CHECKPOINT_MAGIC "GDBSCAN1"
+#define SCAN_STATE_CHECKPOINT_MAGIC_LENGTH 8u
+
+void VariantQueryProcessor::checkpoint_scan_state(VariantQueryProcessorScanState& scan_state,
+    std::vector<uint8_t>& buffer, uint64_t& offset) const
+{
+  auto& variant = scan_state.get_variant();
+  auto& end_pq = scan_state.get_end_pq();
+  //Iterator position as a column - the scan stops only at the first cell of a new column (when the operator's
+  //buffer fills up in handle_gvcf_ranges()), so no cell at this column has been processed yet
+  auto iter_at_end = true;
+  int64_t resume_column = -1ll;
+  if(scan_state.in_progress())
+  {
+    auto& cell_batch = scan_state.get_cell_batch();
+    auto& cell_batch_idx = scan_state.get_cell_batch_idx();
+    //A prefetching iterator can't be dereferenced - move its next batch into the scan state
+    if(cell_batch_idx >= cell_batch.size() && scan_state.m_iter && scan_state.m_iter->is_prefetching()
+        && !(scan_state.m_iter->end()))
+    {
+      scan_state.m_iter->fill_batch(cell_batch);
+      cell_batch_idx = 0ull;
+    }
+    if(cell_batch_idx < cell_batch.size())
+    {
+      resume_column = cell_batch.get_columns()[cell_batch_idx];
+      iter_at_end = false;
+    }
+    else
+      if(scan_state.m_iter && !(scan_state.m_iter->end()))
+      {
+        resume_column = (**(scan_state.m_iter)).get_begin_column();
+        iter_at_end = false;
+      }
+  }
+  //magic, done, iter_at_end, current_start_position, #calls with deletions, resume column, #calls in variant, #calls in PQ
+  uint64_t add_size = SCAN_STATE_CHECKPOINT_MAGIC_LENGTH + 2u*sizeof(bool) + 2u*sizeof(int64_t) + 3u*sizeof(uint64_t);
+  RESIZE_BINARY_SERIALIZATION_BUFFER_IF_NEEDED(buffer, offset, add_size);
+  memcpy(&(buffer[offset]), SCAN_STATE_CHECKPOINT_MAGIC, SCAN_STATE_CHECKPOINT_MAGIC_LENGTH);
+  offset += SCAN_STATE_CHECKPOINT_MAGIC_LENGTH;
+  *(reinterpret_cast<bool*>(&(buffer[offset]))) = scan_state.m_done;
+  offset += sizeof(bool);
+  *(reinterpret_cast<bool*>(&(buffer[offset]))) = iter_at_end;
+  offset += sizeof(bool);
+  *(reinterpret_cast<int64_t*>(&(buffer[offset]))) = scan_state.m_current_start_position;
+  offset += sizeof(int64_t);
+  *(reinterpret_cast<uint64_t*>(&(buffer[offset]))) = scan_state.m_num_calls_with_deletions;
+  offset += sizeof(uint64_t);
+  *(reinterpret_cast<int64_t*>(&(buffer[offset]))) = resume_column;
+  offset += sizeof(int64_t);
+  *(reinterpret_cast<uint64_t*>(&(buffer[offset]))) = variant.get_num_calls();
+  offset += sizeof(uint64_t);
+  //Calls in the END PQ, with their query row idx
+  auto num_calls_in_pq = scan_state.in_progress() ? end_pq.size() : 0ull;
+  *(reinterpret_cast<uint64_t*>(&(buffer[offset]))) = num_calls_in_pq;
+  offset += sizeof(uint64_t);
+  for(auto i=0ull;num_calls_in_pq > 0u && i<variant.get_num_calls();++i)
+  {
+    if(!end_pq.contains(i))
+      continue;
+    RESIZE_BINARY_SERIALIZATION_BUFFER_IF_NEEDED(buffer, offset, sizeof(uint64_t));
+    *(reinterpret_cast<uint64_t*>(&(buffer[offset]))) = i;
+    offset += sizeof(uint64_t);
+    variant.get_call(i).binary_serialize(buffer, offset);
+  }
+}
+
+void VariantQueryProcessor::restore_scan_state(const int ad, const VariantQueryConfig& query_config,
+    const unsigned column_interval_idx,
+    const std::vector<uint8_t>& buffer, uint64_t& offset, VariantQueryProcessorScanState& scan_state) const
+{
+  assert(query_config.is_bookkeeping_done());
+  if(offset + SCAN_STATE_CHECKPOINT_MAGIC_LENGTH > buffer.size()
+      || memcmp(&(buffer[offset]), SCAN_STATE_CHECKPOINT_MAGIC, SCAN_STATE_CHECKPOINT_MAGIC_LENGTH) != 0)
+    throw VariantQueryProcessorException("Invalid scan state checkpoint");
+  offset += SCAN_STATE_CHECKPOINT_MAGIC_LENGTH;
+  if(offset + 2u*sizeof(bool) + 2u*sizeof(int64_t) + 3u*sizeof(uint64_t) > buffer.size())
+    throw VariantQueryProcessorException("Truncated scan state checkpoint");
+  auto done = *(reinterpret_cast<const bool*>(&(buffer[offset])));
+  offset += sizeof(bool);
+  auto iter_at_end = *(reinterpret_cast<const bool*>(&(buffer[offset])));
+  offset += sizeof(bool);
+  auto current_start_position = *(reinterpret_cast<const int64_t*>(&(buffer[offset])));
+  offset += sizeof(int64_t);
+  auto num_calls_with_deletions = *(reinterpret_cast<const uint64_t*>(&(buffer[offset])));
+  offset += sizeof(uint64_t);
+  auto resume_column = *(reinterpret_cast<const int64_t*>(&(buffer[offset])));
+  offset += sizeof(int64_t);
+  auto num_calls = *(reinterpret_cast<const uint64_t*>(&(buffer[offset])));
+  offset += sizeof(uint64_t);
+  auto num_calls_in_pq = *(reinterpret_cast<const uint64_t*>(&(buffer[offset])));
+  offset += sizeof(uint64_t);
+  if(num_calls != query_config.get_num_rows_to_query())
+    throw VariantQueryProcessorException("Scan state checkpoint has "+std::to_string(num_calls)
+        +" calls, the query has "+std::to_string(query_config.get_num_rows_to_query())+" rows");
+  //Discard current state
+  if(scan_state.m_iter)
+    delete scan_state.m_iter;
+  scan_state.reset();
+  scan_state.m_done = done;
+  auto& end_pq = scan_state.get_end_pq();
+  end_pq.clear();
+  auto& variant = scan_state.get_variant();
+  variant.set_query_config(&query_config);
+  variant.resize_based_on_query();
+  variant.reset_for_new_interval();
+  variant.enable_active_calls_tracking();
+  if(done || current_start_position < 0)
+    return;
+  for(auto i=0ull;i<num_calls_in_pq;++i)
+  {
+    if(offset + sizeof(uint64_t) > buffer.size())
+      throw VariantQueryProcessorException("Truncated scan state checkpoint");
+    auto query_row_idx = *(reinterpret_cast<const uint64_t*>(&(buffer[offset])));
+    offset += sizeof(uint64_t);
+    if(query_row_idx >= variant.get_num_calls())
+      throw VariantQueryProcessorException("Invalid call idx "+std::to_string(query_row_idx)+" in scan state checkpoint");
+    auto& curr_call = variant.get_call(query_row_idx);
+    binary_deserialize(curr_call, query_config, buffer, offset);
+    end_pq.push(&curr_call, query_row_idx);
+    variant.add_active_call(query_row_idx);
+  }
+  VariantArrayCellIterator* forward_iter = 0;
+  if(!iter_at_end)
+  {
+    gt_initialize_forward_iter(ad, query_config, resume_column, forward_iter,
+        get_forward_iter_end_column(query_config, column_interval_idx, query_config.get_cell_batch_size()));
+    gt_start_prefetch(query_config, forward_iter, query_config.get_cell_batch_size());
+  }
+  scan_state.set_scan_state(forward_iter, current_start_position, num_calls_with_deletions);
+}
+
+void VariantQueryProcessor::scan_and_operate_parallel(const int ad, const VariantQueryConfig& query_config,
+    const std::vector<SingleVariantOperatorBase*>& variant_operators, const std::vector<RWBuffer*>& output_buffers,
+    ScanOutputWriterBase& output_writer,
+    const unsigned begin_column_interval_idx, const unsigned end_column_interval_idx,
+    bool handle_spanning_deletions, const size_t max_parked_bytes_per_thread) const
+{
+  assert(variant_operators.size() > 0u && variant_operators.size() == output_buffers.size());
+  assert(begin_column_interval_idx <= end_column_interval_idx
+      && end_column_interval_idx <= std::max(1u, query_config.get_num_column_intervals()));
+  int num_threads = variant_operators.size();
+  auto num_intervals = end_column_interval_idx - begin_column_interval_idx;
+  //Output of an interval can be written only after the output of all previous intervals is written
+  //The thread handling interval next_interval_to_write streams its output directly to output_writer,
+  //other threads park their output in parked_output till their turn comes. A thread whose parked output
+  //would exceed max_parked_bytes_per_thread stops scanning till its interval becomes next_interval_to_write
+  auto next_interval_to_write = 0u;
+  std::vector<std::vector<uint8_t>> parked_output(num_intervals);
+  std::vector<bool> is_interval_done(num_intervals, false);
+  //Thread which parked the output of an interval and #bytes parked by every thread
+  std::vector<int> parked_output_thread_idx(num_intervals, 0);
+  std::vector<size_t> num_parked_bytes(num_threads, 0u);
+  std::mutex output_mutex;
+  std::condition_variable output_cv;
+#pragma omp parallel for default(shared) schedule(dynamic, 1) num_threads(num_threads)
+  for(auto i=0u;i<num_intervals;++i)
+  {
+#ifdef DISABLE_OPENMP
+    auto thread_idx = 0;
+#else
+    auto thread_idx = omp_get_thread_num();
+#endif
+    auto& variant_operator = *(variant_operators[thread_idx]);
+    auto& buffer = *(output_buffers[thread_idx]);
+    buffer.m_num_valid_bytes = 0u;
+    VariantQueryProcessorScanState scan_state;
+    while(!scan_state.end())
+    {
+      scan_and_operate(ad, query_config, variant_operator, begin_column_interval_idx+i, handle_spanning_deletions, &scan_state);
+      auto write_directly = false;
+      {
+        std::unique_lock<std::mutex> lock(output_mutex);
+        if(next_interval_to_write != i
+            && num_parked_bytes[thread_idx] + buffer.m_num_valid_bytes <= max_parked_bytes_per_thread)
+        {
+          parked_output[i].insert(parked_output[i].end(), buffer.m_buffer.begin(),
+              buffer.m_buffer.begin()+buffer.m_num_valid_bytes);
+          num_parked_bytes[thread_idx] += buffer.m_num_valid_bytes;
+          parked_output_thread_idx[i] = thread_idx;
+          is_interval_done[i] = scan_state.end();
+        }
+        else
+        {
+          //Block till the output of all previous intervals is written
+          while(next_interval_to_write != i)
+            output_cv.wait(lock);
+          write_directly = true;
+        }
+      }
+      if(write_directly)
+      {
+        //Output parked before this interval became the next one to write
+        if(parked_output[i].size() > 0u)
+        {
+          output_writer.write(&(parked_output[i][0]), parked_output[i].size());
+          std::lock_guard<std::mutex> lock(output_mutex);
+          num_parked_bytes[thread_idx] -= parked_output[i].size();
+          std::vector<uint8_t>().swap(parked_output[i]);
+        }
+        if(buffer.m_num_valid_bytes > 0u)
+          output_writer.write(&(buffer.m_buffer[0]), buffer.m_num_valid_bytes);
+        if(scan_state.end())
+        {
+          //Flush completed intervals that were waiting for this one
+          std::lock_guard<std::mutex> lock(output_mutex);
+          ++next_interval_to_write;
+          while(next_interval_to_write < num_intervals && is_interval_done[next_interval_to_write])
+          {
+            auto& curr_output = parked_output[next_interval_to_write];
+            if(curr_output.size() > 0u)
+              output_writer.write(&(curr_output[0]), curr_output.size());
+            num_parked_bytes[parked_output_thread_idx[next_interval_to_write]] -= curr_output.size();
+            std::vector<uint8_t>().swap(curr_output);
+            ++next_interval_to_write;
+          }
+          output_cv.notify_all();
+        }
+      }
+      buffer.m_num_valid_bytes = 0u;
+    }
+  }
+  assert(next_interval_to_write == num_intervals);
+}
+
+void VariantQueryProcessor::split_column_interval(const int ad, const VariantQueryConfig& query_config,
+    const unsigned column_interval_idx, const unsigned num_splits, std::vector<ColumnRange>& sub_intervals) const
+{
+  assert(column_interval_idx < query_config.get_num_column_intervals());
+  auto interval_begin = static_cast<int64_t>(query_config.get_column_begin(column_interval_idx));
+  auto interval_end = static_cast<int64_t>(query_config.get_column_end(column_interval_idx));
+  auto interval_length = interval_end - interval_begin + 1;
+  auto sub_interval_begin = interval_begin;
+  for(auto i=1u;i<num_splits;++i)
+  {
+    auto nominal_split_column = interval_begin + (interval_length*static_cast<int64_t>(i))/num_splits;
+    if(nominal_split_column <= sub_interval_begin)
+      continue;
+    //Split at the first cell beginning at or after the nominal split column. scan_and_operate() starts a new
+    //gVCF interval at the begin column of every cell, so the split does not add any extra interval to the output
+    auto split_column = get_first_cell_begin_column_at_or_after(ad, query_config, nominal_split_column, interval_end);
+    //No cells in the rest of the interval
+    if(split_column < 0)
+      break;
+    if(split_column <= sub_interval_begin)
+      continue;
+    sub_intervals.emplace_back(sub_interval_begin, split_column-1);
+    sub_interval_begin = split_column;
+  }
+  sub_intervals.emplace_back(sub_interval_begin, interval_end);
+}
+
+void VariantQueryProcessor::split_column_intervals(const int ad, const VariantQueryConfig& query_config,
+    const unsigned num_splits, VariantQueryConfig& split_query_config) const
+{
+  assert(query_config.get_num_column_intervals() > 0u);
+  std::vector<ColumnRange> sub_intervals;
+  if(query_config.balance_column_intervals())
+  {
+    std::vector<std::vector<ColumnRange>> parts;
+    balance_column_intervals(ad, query_config, num_splits, parts);
+    for(const auto& part : parts)
+      sub_intervals.insert(sub_intervals.end(), part.begin(), part.end());
+  }
+  else
+    for(auto i=0u;i<query_config.get_num_column_intervals();++i)
+      split_column_interval(ad, query_config, i, num_splits, sub_intervals);
+  split_query_config = query_config;
+  split_query_config.set_column_intervals_to_query(sub_intervals);
+}
+
+void VariantQueryProcessor::fill_cell_count_histogram(const int ad, const VariantQueryConfig& query_config,
+    UniformHistogram& histogram, const uint64_t begin_offset, const uint64_t end_offset) const
+{
+  auto tile_index = get_tile_index(ad);
+  std::vector<RowRange> row_blocks;
+  query_config.get_query_row_blocks(row_blocks, MAX_NUM_ROW_BLOCKS_IN_FORWARD_ITER);
+  //Offset of the current interval in the queried columns
+  auto interval_offset = 0ull;
+  for(auto i=0u;i<query_config.get_num_column_intervals();++i)
+  {
+    auto interval_begin = static_cast<int64_t>(query_config.get_column_begin(i));
+    auto interval_length = query_config.get_column_end(i) - query_config.get_column_begin(i) + 1ull;
+    //Part of the interval within [begin_offset, end_offset)
+    auto count_begin_offset = std::max<uint64_t>(begin_offset, interval_offset);
+    auto count_end_offset = std::min<uint64_t>(end_offset, interval_offset+interval_length);
+    interval_offset += interval_length;
+    if(count_begin_offset >= count_end_offset)
+      continue;
+    auto count_begin_column = interval_begin + static_cast<int64_t>(count_begin_offset - (interval_offset-interval_length));
+    auto count_end_column = count_begin_column + static_cast<int64_t>(count_end_offset - count_begin_offset) - 1;
+    if(tile_index)
+    {
+      if(!row_blocks.empty())
+        tile_index->add_cell_estimates_to_histogram(histogram, count_begin_column, count_end_column,
+            row_blocks.front().first, row_blocks.back().second, count_begin_offset);
+      continue;
+    }
+    //Only the begin columns are needed - the queried attributes are not read
+    VariantArrayCellIterator* forward_iter = 0;
+    std::vector<int> END_schema_idx(1u,
+        query_config.get_schema_idx_for_query_idx(query_config.get_query_idx_for_known_field_enum(GVCF_END_IDX)));
+    gt_initialize_forward_iter(ad, query_config, count_begin_column, forward_iter, count_end_column, &END_schema_idx);
+    for(;!(forward_iter->end());++(*forward_iter))
+    {
+      auto& cell = **forward_iter;
+#ifdef DUPLICATE_CELL_AT_END
+      //Ignore cell copies at END positions
+      auto END_v = *(cell.get_field_ptr_for_query_idx<int64_t>(0u));
+      if(cell.get_begin_column() > END_v)
+        continue;
+#endif
+      if(!query_config.is_queried_array_row_idx(cell.get_row()))
+        continue;
+      histogram.add_value(count_begin_offset + (cell.get_begin_column() - count_begin_column));
+    }
+    delete forward_iter;
+  }
+}
+
+void VariantQueryProcessor::balance_column_intervals(const int ad, const VariantQueryConfig& query_config,
+    const unsigned num_parts, std::vector<std::vector<ColumnRange>>& parts) const
+{
+  auto num_queried_columns = query_config.get_num_queried_columns();
+  if(num_queried_columns == 0ull)
+  {
+    parts.clear();
+    parts.resize(num_parts);
+    return;
+  }
+  UniformHistogram histogram(0ull, num_queried_columns-1ull, std::min<uint64_t>(num_queried_columns,
+        static_cast<uint64_t>(DEFAULT_BALANCE_COLUMN_INTERVALS_NUM_BINS_PER_PART)*num_parts));
+  fill_cell_count_histogram(ad, query_config, histogram);
+  balance_column_intervals(ad, query_config, histogram, num_parts, parts);
+}
+
+void VariantQueryProcessor::balance_column_intervals(const int ad, const VariantQueryConfig& query_config,
+    const UniformHistogram& histogram, const unsigned num_parts, std::vector<std::vector<ColumnRange>>& parts) const
+{
+  assert(num_parts > 0u);
+  parts.clear();
+  parts.resize(num_parts);
+  auto num_intervals = query_config.get_num_column_intervals();
+  auto num_queried_columns = query_config.get_num_queried_columns();
+  if(num_queried_columns == 0ull)
+    return;
+  //Offset of every interval in the queried columns
+  std::vector<uint64_t> interval_offsets(num_intervals);
+  for(auto i=1u;i<num_intervals;++i)
+    interval_offsets[i] = interval_offsets[i-1u] + (query_config.get_column_end(i-1u) - query_config.get_column_begin(i-1u) + 1ull);
+  //Part k begins where the cumulative #cells reaches k/num_parts of the total (interpolated within the bin).
+  //Without any cells, the queried columns are split evenly
+  std::vector<uint64_t> cuts(num_parts-1u);
+  auto num_cells = histogram.get_total();
+  auto bin_idx = 0u;
+  auto num_cells_before_bin = 0ull;
+  for(auto k=1u;k<num_parts;++k)
+  {
+    if(num_cells == 0ull)
+    {
+      cuts[k-1u] = (num_queried_columns/num_parts)*k;
+      continue;
+    }
+    auto target = (num_cells*k)/num_parts;
+    //target < num_cells, so the loop stops at a non-empty bin
+    while(num_cells_before_bin + histogram.get_histogram_value(bin_idx) <= target)
+      num_cells_before_bin += histogram.get_histogram_value(bin_idx++);
+    auto bin_width = histogram.get_hi(bin_idx) - histogram.get_lo(bin_idx) + 1ull;
+    auto offset_in_bin = static_cast<uint64_t>((static_cast<long double>(target - num_cells_before_bin)*bin_width)
+        /histogram.get_histogram_value(bin_idx));
+    cuts[k-1u] = std::min<uint64_t>(histogram.get_lo(bin_idx) + offset_in_bin, num_queried_columns-1ull);
+  }
+  //Map cuts back to columns
+  auto part_idx = 0u;
+  auto cut_idx = 0u;
+  for(auto i=0u;i<num_intervals;++i)
+  {
+    auto interval_begin = static_cast<int64_t>(query_config.get_column_begin(i));
+    auto interval_end = static_cast<int64_t>(query_config.get_column_end(i));
+    auto interval_last_offset = interval_offsets[i] + static_cast<uint64_t>(interval_end - interval_begin);
+    auto sub_interval_begin = interval_begin;
+    for(;cut_idx < cuts.size() && cuts[cut_idx] <= interval_last_offset;++cut_idx)
+    {
+      //Cuts at or before sub_interval_begin (in an earlier interval or overtaken by the previous cut) start
+      //the next part at sub_interval_begin
+      auto split_column = (cuts[cut_idx] > interval_offsets[i])
+        ? interval_begin + static_cast<int64_t>(cuts[cut_idx] - interval_offsets[i]) : interval_begin;
+      if(split_column > sub_interval_begin)
+      {
+        //As in split_column_interval(), split only where a cell begins
+        split_column = get_first_cell_begin_column_at_or_after(ad, query_config, split_column, interval_end);
+        //No cells in the rest of the interval - the next part begins with the next interval
+        if(split_column < 0)
+          break;
+        parts[part_idx].emplace_back(sub_interval_begin, split_column-1);
+        sub_interval_begin = split_column;
+      }
+      ++part_idx;
+    }
+    parts[part_idx].emplace_back(sub_interval_begin, interval_end);
+  }
+}
+
+int64_t VariantQueryProcessor::get_first_cell_begin_column_at_or_after(const int ad, const VariantQueryConfig& query_config,
+    const int64_t column, const int64_t end_column) const
+{
+  //Only END is read - and ALT, to skip reference blocks, if splits must be at variant cells
+  std::vector<int> planning_schema_idxs(1u,
+      query_config.get_schema_idx_for_query_idx(query_config.get_query_idx_for_known_field_enum(GVCF_END_IDX)));
+  auto skip_reference_blocks = query_config.split_at_variant_cells()
+    && query_config.is_defined_query_idx_for_known_field_enum(GVCF_ALT_IDX);
+  if(skip_reference_blocks)
+    planning_schema_idxs.push_back(
+        query_config.get_schema_idx_for_query_idx(query_config.get_query_idx_for_known_field_enum(GVCF_ALT_IDX)));
+  VariantArrayCellIterator* forward_iter = 0;
+  gt_initialize_forward_iter(ad, query_config, column, forward_iter, end_column, &planning_schema_idxs);
+  auto begin_column = -1ll;
+  for(;!(forward_iter->end());++(*forward_iter))
+  {
+    auto& cell = **forward_iter;
+#ifdef DUPLICATE_CELL_AT_END
+    //Ignore cell copies at END positions - scan_and_operate() ignores them too
+    auto END_v = *(cell.get_field_ptr_for_query_idx<int64_t>(0u));
+    if(cell.get_begin_column() > END_v)
+      continue;
+#endif
+    //Cells of rows that are not queried do not start gVCF intervals in scan_and_operate()
+    if(!query_config.is_queried_array_row_idx(cell.get_row()))
+      continue;
+    //ALT of a reference block is only <NON_REF>
+    if(skip_reference_blocks)
+    {
+      auto ALT_ptr = cell.get_field_ptr_for_query_idx<char>(1u);
+      auto ALT_length = cell.get_field_length(1u);
+      if(ALT_length > 0 && ALT_ptr[0] == TILEDB_NON_REF_VARIANT_REPRESENTATION[0]
+          && (ALT_length == 1 || ALT_ptr[1] == '\0'))
+        continue;
+    }
+    begin_column = cell.get_begin_column();
+    break;
+  }
+  delete forward_iter;
+  return begin_column;
+}
+
 bool VariantQueryProcessor::scan_handle_cell(const VariantQueryConfig& query_config, unsigned column_interval_idx,
     Variant& variant, SingleVariantOperatorBase& variant_operator,
     const BufferVariantCell& cell,
-    VariantCallEndPQ& end_pq, std::vector<VariantCall*>& tmp_pq_buffer,
+    VariantCallEndPQ& end_pq,
     int64_t& current_start_position, int64_t& next_start_position,
     uint64_t& num_calls_with_deletions, bool handle_spanning_deletions,
     GTProfileStats* stats_ptr) const
@@ -448,6 +1037,10 @@ bool VariantQueryProcessor::scan_handle_cell(const VariantQueryConfig& query_con
   if(query_config.get_num_column_intervals() > 0u &&
       cell.get_begin_column() > static_cast<int64_t>(query_config.get_column_end(column_interval_idx)))
     return true;
+  //Cells of rows that are not part of the query must not split gVCF intervals - whether such cells are read
+  //at all depends on how the queried rows are grouped into subarrays
+  if(!query_config.is_queried_array_row_idx(cell.get_row()))
+    return false;
   if(cell.get_begin_column() != current_start_position) //have found cell with next gVCF position, handle accumulated values
   {
     next_start_position = cell.get_begin_column();
@@ -464,54 +1057,37 @@ bool VariantQueryProcessor::scan_handle_cell(const VariantQueryConfig& query_con
     //Do not reset variant as some of the Calls that are long intervals might still be valid 
   }
   //Accumulate cells with position == current_start_position
-  //Include only if row is part of query
-  if(query_config.is_queried_array_row_idx(cell.get_row()))
+  auto query_row_idx = query_config.get_query_row_idx_for_array_row_idx(cell.get_row());
+  auto& curr_call = variant.get_call(query_row_idx);
+  //Overlapping intervals for current call - spans across next position
+  //Have to ignore rest of this interval - overwrite with the new info from the cell
+  if(curr_call.is_valid() && static_cast<int64_t>(curr_call.get_column_end()) >= cell.get_begin_column())
   {
-    auto& curr_call = variant.get_call(query_config.get_query_row_idx_for_array_row_idx(cell.get_row()));
-    //Overlapping intervals for current call - spans across next position
-    //Have to ignore rest of this interval - overwrite with the new info from the cell
-    if(curr_call.is_valid() && static_cast<int64_t>(curr_call.get_column_end()) >= cell.get_begin_column())
-    {
-      //Have to cycle through priority queue and remove this call
-      auto found_curr_call = false;
-      auto num_entries_in_tmp_pq_buffer = 0ull;
-      while(!end_pq.empty() && !found_curr_call)
-      {
-        auto top_call = end_pq.top();
-        if(top_call == &curr_call)
-          found_curr_call = true;
-        else
-        {
-          assert(num_entries_in_tmp_pq_buffer < query_config.get_num_rows_to_query());
-          tmp_pq_buffer[num_entries_in_tmp_pq_buffer++] = top_call;
-        }
-        end_pq.pop();
-      }
-      assert(found_curr_call);
-      for(auto i=0ull;i<num_entries_in_tmp_pq_buffer;++i)
-        end_pq.push(tmp_pq_buffer[i]);
-      //Can handle overlapping deletions and reference blocks - if something else, throw error
-      if(!curr_call.contains_deletion() && !curr_call.is_reference_block())
+    //Remove this call from the priority queue - O(log n)
+    assert(end_pq.contains(query_row_idx));
+    end_pq.remove(query_row_idx);
+    //Can handle overlapping deletions and reference blocks - if something else, throw error
+    if(!curr_call.contains_deletion() && !curr_call.is_reference_block())
 	throw VariantQueryProcessorException("Unhandled overlapping variants at columns "+std::to_string(curr_call.get_column_begin())+" and "
 	      + std::to_string(cell.get_begin_column())+" for row "+std::to_string(cell.get_row()));
-      if(curr_call.contains_deletion())
-      {
+    if(curr_call.contains_deletion())
+    {
 	//Reduce #calls with deletions 
 	assert(num_calls_with_deletions > 0u);
 	--num_calls_with_deletions;
-      }
-    }
-    curr_call.reset_for_new_interval();
-    gt_fill_row(variant, cell.get_row(), cell.get_begin_column(), query_config, cell, stats_ptr);
-    //When cells are duplicated at the END, then the VariantCall object need not be valid
-    if(curr_call.is_valid())
-    {
-      end_pq.push(&curr_call);
-      if(handle_spanning_deletions && curr_call.contains_deletion())
-        ++num_calls_with_deletions;
-      assert(end_pq.size() <= query_config.get_num_rows_to_query());
     }
   }
+  curr_call.reset_for_new_interval();
+  gt_fill_row(variant, cell.get_row(), cell.get_begin_column(), query_config, cell, stats_ptr);
+  //When cells are duplicated at the END, then the VariantCall object need not be valid
+  if(curr_call.is_valid())
+  {
+    end_pq.push(&curr_call, query_row_idx);
+    variant.add_active_call(query_row_idx);
+    if(handle_spanning_deletions && curr_call.contains_deletion())
+      ++num_calls_with_deletions;
+    assert(end_pq.size() <= query_config.get_num_rows_to_query());
+  }
   return false;
 }
 
@@ -557,13 +1133,37 @@ void VariantQueryProcessor::iterate_over_cells(
   }
   //Initialize forward scan iterators
   VariantArrayCellIterator* forward_iter = 0;
-  gt_initialize_forward_iter(ad, query_config, start_column, forward_iter);
+  auto cell_batch_size = query_config.get_cell_batch_size() > 0u ? query_config.get_cell_batch_size()
+    : DEFAULT_CELL_BATCH_SIZE;
+  gt_initialize_forward_iter(ad, query_config, start_column, forward_iter,
+      get_forward_iter_end_column(query_config, column_interval_idx, cell_batch_size));
+  gt_start_prefetch(query_config, forward_iter, cell_batch_size);
+  //A prefetching iterator hands out cells in batches
+  VariantCellBatch cell_batch;
+  auto cell_batch_idx = 0ull;
+  BufferVariantCell batch_cell(get_array_schema(), query_config);
+  auto use_cell_batches = forward_iter->is_prefetching();
+  if(use_cell_batches)
+    cell_batch.initialize(query_config.get_num_queried_attributes(), -1);
   //Variant object
   Variant variant(&query_config);
   variant.resize_based_on_query();
-  for(;!(forward_iter->end());++(*forward_iter))
+  while(true)
   {
-    auto& cell = **forward_iter;
+    if(use_cell_batches)
+    {
+      if(cell_batch_idx >= cell_batch.size())
+      {
+        if(forward_iter->fill_batch(cell_batch) == 0u)
+          break;
+        cell_batch_idx = 0ull;
+      }
+      cell_batch.set_cell(batch_cell, cell_batch_idx);
+      ++cell_batch_idx;
+    }
+    else if(forward_iter->end())
+      break;
+    const auto& cell = use_cell_batches ? batch_cell : **forward_iter;
     //If only interval requested and end of interval crossed, exit loop
     if(query_config.get_num_column_intervals() > 0 &&
         cell.get_begin_column() > static_cast<int64_t>(query_config.get_column_end(column_interval_idx)))
@@ -577,6 +1177,8 @@ void VariantQueryProcessor::iterate_over_cells(
       if(curr_call.is_valid())
         variant_operator.operate(curr_call, query_config, get_array_schema());
     }
+    if(!use_cell_batches)
+      ++(*forward_iter);
   }
   delete forward_iter;
 }
@@ -584,7 +1186,41 @@ void VariantQueryProcessor::iterate_over_cells(
 void VariantQueryProcessor::do_query_bookkeeping(const VariantArraySchema& array_schema,
     VariantQueryConfig& query_config, const VidMapper& vid_mapper, const bool alleles_required) const
 {
+  //Sites-only queries - retain END, REF, ALT, QUAL and INFO fields, FORMAT fields are never read
+  if(query_config.sites_only())
+  {
+    std::vector<std::string> site_attributes = { "END", "REF", "ALT" };
+    for(auto i=0u;i<query_config.get_num_queried_attributes();++i)
+    {
+      const auto& field_name = query_config.get_query_attribute_name(i);
+      if(field_name == "END" || field_name == "REF" || field_name == "ALT")
+        continue;
+      const auto* vid_field_info = vid_mapper.get_field_info(field_name);
+      if(field_name == "QUAL" || (vid_field_info && vid_field_info->m_is_vcf_INFO_field))
+        site_attributes.push_back(field_name);
+    }
+    query_config.clear_attributes_to_query();
+    query_config.set_attributes_to_query(site_attributes);
+  }
   obtain_TileDB_attribute_idxs(array_schema, query_config);
+  //Fields used by the per-call filter must be fetched from TileDB - fields not queried by the user
+  //are marked filter-only and are not part of the output
+  auto& call_filter = query_config.get_call_filter();
+  for(auto i=0u;i<call_filter.get_num_clauses();++i)
+  {
+    const auto& field_name = call_filter.get_field_name(i);
+    unsigned query_idx = 0u;
+    if(query_config.get_query_idx_for_name(field_name, query_idx))
+      continue;
+    auto schema_idx = 0u;
+    for(;schema_idx<array_schema.attribute_num();++schema_idx)
+      if(array_schema.attribute_name(schema_idx) == field_name)
+        break;
+    if(schema_idx >= array_schema.attribute_num())
+      throw UnknownQueryAttributeException("Invalid attribute in query filter : "+field_name);
+    query_config.add_attribute_to_query(field_name, schema_idx);
+    query_config.set_filter_only_for_query_idx(query_config.get_num_queried_attributes()-1u);
+  }
   //Add END as a query attribute by default
   unsigned END_schema_idx = 
           m_schema_idx_to_known_variant_field_enum_LUT.get_schema_idx_for_known_field_enum(GVCF_END_IDX);
@@ -654,10 +1290,22 @@ void VariantQueryProcessor::do_query_bookkeeping(const VariantArraySchema& array
       assert(g_known_variant_field_names[known_variant_field_enum] == query_config.get_query_attribute_name(i));
     }
   }
+  //Bind filter clauses to the (re-ordered) query idxs
+  for(auto i=0u;i<call_filter.get_num_clauses();++i)
+  {
+    unsigned query_idx = 0u;
+    if(!query_config.get_query_idx_for_name(call_filter.get_field_name(i), query_idx))
+      throw UnknownQueryAttributeException("Invalid attribute in query filter : "+call_filter.get_field_name(i));
+    call_filter.bind_field(i, query_idx, array_schema.type(query_config.get_schema_idx_for_query_idx(query_idx)));
+  }
   //Set number of rows in the array
   auto& dim_domains = array_schema.dim_domains();
   uint64_t row_num = m_storage_manager ? m_storage_manager->get_num_valid_rows_in_array(m_ad) :   //may read from array metadata
     (dim_domains[0].second - dim_domains[0].first + 1);
+  //Partitions may have been loaded with different #rows
+  if(m_storage_manager)
+    for(auto partition_ad : m_partition_ads)
+      row_num = std::max<uint64_t>(row_num, m_storage_manager->get_num_valid_rows_in_array(partition_ad));
   query_config.set_num_rows_in_array(row_num, static_cast<int64_t>(dim_domains[0].first));
   query_config.setup_array_row_idx_to_query_row_idx_map();
   //Bounds checking for query
@@ -684,13 +1332,42 @@ void VariantQueryProcessor::do_query_bookkeeping(const VariantArraySchema& array
 void VariantQueryProcessor::gt_get_column_interval(
     const int ad,
     const VariantQueryConfig& query_config, unsigned column_interval_idx,
-    vector<Variant>& variants, GA4GHPagingInfo* paging_info, GTProfileStats* stats_ptr) const {
+    vector<Variant>& variants, GA4GHPagingInfo* paging_info, GTProfileStats* stats_ptr,
+    VariantPool* variant_pool) const {
 #ifdef DO_PROFILING
   assert(stats_ptr);
 #endif
   if(paging_info)
     paging_info->init_page_query();
   uint64_t start_variant_idx = variants.size();
+  //Serve from the result cache before any TileDB access
+  std::string cache_key;
+  if(query_config.get_result_cache_size() > 0u)
+  {
+    if(m_result_cache.get_max_num_bytes() != query_config.get_result_cache_size())
+      m_result_cache.set_max_num_bytes(query_config.get_result_cache_size());
+    cache_key = build_result_cache_key(ad, query_config, column_interval_idx, paging_info);
+    vector<uint8_t> serialized_variants;
+    if(m_result_cache.lookup(cache_key, serialized_variants, paging_info))
+    {
+      uint64_t offset = 0ull;
+      while(offset < serialized_variants.size())
+      {
+        variants.emplace_back(&query_config);
+        binary_deserialize(variants.back(), query_config, serialized_variants, offset);
+      }
+      return;
+    }
+  }
+  //Without a caller provided pool, objects are reused only within this query
+  VariantPool local_variant_pool;
+  if(variant_pool == 0)
+    variant_pool = &local_variant_pool;
+  variant_pool->set_query_config(query_config);
+#ifdef DO_PROFILING
+  auto num_variant_allocations_before_query = variant_pool->get_num_variant_allocations();
+  auto num_call_allocations_before_query = variant_pool->get_num_call_allocations();
+#endif
   //Will be used later in the function to produce Variants with one CallSet
   VariantQueryConfig subset_query_config(query_config);
   vector<int64_t> subset_rows = vector<int64_t>(1u, query_config.get_smallest_row_idx_in_array());
@@ -708,6 +1385,7 @@ void VariantQueryProcessor::gt_get_column_interval(
   if(paging_info == 0 || paging_info->get_last_column() <= query_config.get_column_begin(column_interval_idx))
   {
     Variant interval_begin_variant(&query_config);
+    variant_pool->append_calls(interval_begin_variant, query_config.get_num_rows_to_query());
     interval_begin_variant.resize_based_on_query();
     //If cells are duplicated, no claim can be made  on the order in which cells are traversed since
     //the order of END cells has no bearing on the order of begin values
@@ -727,7 +1405,8 @@ void VariantQueryProcessor::gt_get_column_interval(
     //This interval contains many Calls, likely un-aligned (no common start/end). Split this variant 
     //into multiple Variants, each containing calls that are satisfy the GA4GH properties for merging calls
     interval_begin_variant.move_calls_to_separate_variants(query_config, variants, query_row_idx_in_order,
-        call_info_2_variant, paging_info);
+        call_info_2_variant, paging_info, variant_pool);
+    variant_pool->release(interval_begin_variant);
   }
   //If this is not a single position query and paging limit is not hit, need to fetch more cells
   if((query_config.get_column_end(column_interval_idx) >
@@ -737,14 +1416,18 @@ void VariantQueryProcessor::gt_get_column_interval(
     //Get the iterator to the first cell that has column > query_column_start. All cells with column == query_column_start
     //(or intersecting) would have been handled by gt_get_column(). Hence, must start from next column
     uint64_t start_column_forward_sweep = query_config.get_column_interval(column_interval_idx).first+1u;
-    //If paging, continue at the last column that was handled in the previous page
+    //If paging, continue at the last column that was handled in the previous page - the iterator seeks directly
+    //to that column, so the cost of a page doesn't depend on how deep into the interval it is.
+    //Cells at earlier columns can't contribute to this page - GA4GH variants are merged only if their begin
+    //columns match
     start_column_forward_sweep = paging_info ? std::max<uint64_t>(paging_info->get_last_column(), start_column_forward_sweep) 
       : start_column_forward_sweep;
     VariantArrayCellIterator* forward_iter = 0;
-    gt_initialize_forward_iter(ad, query_config, query_config.get_column_interval(column_interval_idx).first+1, forward_iter);
+    gt_initialize_forward_iter(ad, query_config, start_column_forward_sweep, forward_iter);
     //Used to store single call variants  - one variant per cell
     //Multiple variants could be merged later on
     Variant tmp_variant(&subset_query_config);
+    variant_pool->append_calls(tmp_variant, 1u);
     tmp_variant.resize_based_on_query();
 #if VERBOSE>0
     std::cerr << "[query_variants:gt_get_column_interval] Fetching columns from " << query_config.get_column_begin(column_interval_idx) + 1;
@@ -752,12 +1435,10 @@ void VariantQueryProcessor::gt_get_column_interval(
 #endif
     //Used for paging
     auto last_column_idx = start_column_forward_sweep;
-    //Num handled variants - if beginning from same column as end of last page, get from paging info
-    //else, reset to 0
-    auto num_last_column_variants_handled_after_curr_page = paging_info ? 
-      (paging_info->get_last_column() == last_column_idx) ? paging_info->get_num_handled_variants_in_last_column() : 0u
-      : 0u;
-    num_last_column_variants_handled_after_curr_page = 0u;
+    //Variants at the last column of the previous page are re-built from all the cells at that column (a variant
+    //may contain calls from any row), hence counting starts at 0 - the first
+    //get_num_handled_variants_in_last_column() variants are removed by shift_left_variants()
+    auto num_last_column_variants_handled_after_curr_page = 0u;
     auto curr_column_idx = start_column_forward_sweep;
     auto curr_row_idx = 0ull;
     bool stop_inserting_new_variants = false;
@@ -794,7 +1475,7 @@ void VariantQueryProcessor::gt_get_column_interval(
         {
           //Move call to variants vector, creating new Variant if necessary
           auto newly_inserted = move_call_to_variant_vector(subset_query_config, tmp_variant.get_call(0), variants, call_info_2_variant,
-              stop_inserting_new_variants);
+              stop_inserting_new_variants, variant_pool);
           //Check if page limit hit
           PAGE_END_CHECK_LOGIC
         }
@@ -805,7 +1486,14 @@ void VariantQueryProcessor::gt_get_column_interval(
     std::cerr << "[query_variants:gt_get_column_interval] Fetching columns complete " << std::endl;
 #endif
     delete forward_iter;
+    variant_pool->release(tmp_variant);
   }
+#ifdef DO_PROFILING
+  stats_ptr->update_stat(GTProfileStats::GT_NUM_VARIANT_ALLOCATIONS,
+      variant_pool->get_num_variant_allocations() - num_variant_allocations_before_query);
+  stats_ptr->update_stat(GTProfileStats::GT_NUM_VARIANT_CALL_ALLOCATIONS,
+      variant_pool->get_num_call_allocations() - num_call_allocations_before_query);
+#endif
   if(paging_info)
   {
     //Exited loop without hitting page limit - only reason, end of query
@@ -832,11 +1520,51 @@ void VariantQueryProcessor::gt_get_column_interval(
     }
   if(paging_info)
     paging_info->serialize_page_end(m_array_schema->array_name());
+  if(!cache_key.empty())
+  {
+    vector<uint8_t> serialized_variants(1024u); //resized by serialization functions if necessary
+    uint64_t serialized_length = 0ull;
+    for(auto i=start_variant_idx;i<variants.size();++i)
+      variants[i].binary_serialize(serialized_variants, serialized_length);
+    m_result_cache.insert(cache_key, serialized_length ? &(serialized_variants[0]) : 0, serialized_length, paging_info);
+  }
 #if VERBOSE>0
   std::cerr << "[query_variants:gt_get_column_interval] query complete " << std::endl;
 #endif
 }
 
+std::string VariantQueryProcessor::build_result_cache_key(const int ad, const VariantQueryConfig& query_config,
+    const unsigned column_interval_idx, const GA4GHPagingInfo* paging_info) const
+{
+  std::string key = (m_storage_manager ? m_storage_manager->get_workspace() : "") + '/' + m_array_schema->array_name()
+    + '|';
+  //Loads and consolidations change the fragments of the array(s) - cached results of older fragments never match
+  if(m_storage_manager)
+  {
+    std::vector<int> read_ads = is_merged_array_descriptor(ad) ? m_partition_ads : std::vector<int>(1u, ad);
+    for(auto read_ad : read_ads)
+    {
+      int64_t last_modification_time = 0;
+      auto num_fragments = m_storage_manager->get_num_fragments(read_ad, &last_modification_time);
+      key += std::to_string(num_fragments) + ':' + std::to_string(last_modification_time) + ',';
+    }
+  }
+  key += '|' + std::to_string(query_config.get_column_begin(column_interval_idx))
+    + '-' + std::to_string(query_config.get_column_end(column_interval_idx)) + '|';
+  //Rows as blocks of contiguous row idxs
+  std::vector<RowRange> row_blocks;
+  query_config.get_query_row_blocks(row_blocks, UINT_MAX);
+  for(const auto& row_block : row_blocks)
+    key += std::to_string(row_block.first) + '-' + std::to_string(row_block.second) + ',';
+  key += '|';
+  for(auto i=0u;i<query_config.get_num_queried_attributes();++i)
+    key += query_config.get_query_attribute_name(i) + ',';
+  key += '|' + query_config.get_call_filter_expression();
+  if(paging_info)
+    key += '|' + std::to_string(paging_info->get_page_size()) + '|' + paging_info->get_page_end_token();
+  return key;
+}
+
 void VariantQueryProcessor::gt_get_column(
     const int ad,
     const VariantQueryConfig& query_config, unsigned column_interval_idx,
@@ -862,14 +1590,26 @@ void VariantQueryProcessor::gt_get_column(
 #ifdef DUPLICATE_CELL_AT_END
   //If cells are duplicated at the end, we only need a forward iterator starting at col
   //i.e. start at the smallest cell with co-ordinate >= col
+  //If the max interval length (L) in the array is known, then any cell intersecting col has its END copy
+  //at a column <= col+L - the sweep can stop there instead of scanning till a cell is found for every row
+  auto max_interval_length = get_max_interval_length(ad);
+  auto sweep_end_column = (max_interval_length >= 0 && static_cast<int64_t>(col) <= INT64_MAX-max_interval_length)
+    ? static_cast<int64_t>(col)+max_interval_length : INT64_MAX;
+  //With the sidecar tile index, the END of every cell intersecting col is <= max END of the tiles beginning at or
+  //before col. If the bound is < col, no cell intersects col and the sweep is skipped
+  auto tile_index = get_tile_index(ad);
+  if(tile_index)
+    sweep_end_column = std::min(sweep_end_column, tile_index->get_max_END_of_cells_beginning_at_or_before(col));
   VariantArrayCellIterator* cell_iter = 0;
-  gt_initialize_forward_iter(ad, query_config, query_config.get_column_interval(column_interval_idx).first, cell_iter);
+  if(sweep_end_column >= static_cast<int64_t>(col))
+    gt_initialize_forward_iter(ad, query_config, query_config.get_column_interval(column_interval_idx).first, cell_iter,
+        sweep_end_column);
 #endif //ifdef DUPLICATE_CELL_AT_END
   // Indicates how many rows have been filled.
   uint64_t filled_rows = 0;
   uint64_t num_valid_rows = 0;
   // Fill the genotyping column
-  while(!(cell_iter->end()) && filled_rows < query_config.get_num_rows_to_query()) {
+  while(cell_iter && !(cell_iter->end()) && filled_rows < query_config.get_num_rows_to_query()) {
 #ifdef DO_PROFILING
     stats_ptr->update_stat(GTProfileStats::GT_NUM_CELLS, 1u);
     stats_ptr->update_stat(GTProfileStats::GT_NUM_CELLS_IN_LEFT_SWEEP, 1u);
@@ -953,6 +1693,28 @@ void VariantQueryProcessor::fill_field(std::unique_ptr<VariantFieldBase>& field_
   field_ptr->copy_data_from_tile(attr_iter);
 }
 
+void VariantQueryProcessor::binary_deserialize(VariantCall& curr_call, const VariantQueryConfig& query_config,
+    const vector<uint8_t>& buffer, uint64_t& offset) const
+{
+  curr_call.binary_deserialize_header(buffer, offset);
+  //Fields
+  assert(query_config.get_num_queried_attributes() == curr_call.get_num_fields());
+  for(auto j=0u;j<curr_call.get_num_fields();++j)
+  {
+    //check if field is valid
+    auto is_valid_field = *(reinterpret_cast<const bool*>(&(buffer[offset])));
+    offset += sizeof(bool);
+    if(is_valid_field)
+    {
+      auto& field_ptr = curr_call.get_field(j); 
+      unsigned length_descriptor = BCF_VL_FIXED;
+      unsigned num_elements = 1u;
+      fill_field_prep(field_ptr, query_config, j, length_descriptor, num_elements);
+      field_ptr->binary_deserialize(reinterpret_cast<const char*>(&(buffer[0])), offset, length_descriptor, num_elements);
+    }
+  }
+}
+
 void VariantQueryProcessor::binary_deserialize(Variant& variant, const VariantQueryConfig& query_config,
     const vector<uint8_t>& buffer, uint64_t& offset) const
 {
@@ -961,26 +1723,7 @@ void VariantQueryProcessor::binary_deserialize(Variant& variant, const VariantQu
   variant.binary_deserialize_header(buffer, offset, query_config.get_num_queried_attributes());
   //VariantCall info
   for(auto i=0ull;i<variant.get_num_calls();++i)
-  {
-    auto& curr_call = variant.get_call(i);
-    curr_call.binary_deserialize_header(buffer, offset);
-    //Fields
-    assert(query_config.get_num_queried_attributes() == curr_call.get_num_fields());
-    for(auto j=0u;j<curr_call.get_num_fields();++j)
-    {
-      //check if field is valid
-      auto is_valid_field = *(reinterpret_cast<const bool*>(&(buffer[offset])));
-      offset += sizeof(bool);
-      if(is_valid_field)
-      {
-        auto& field_ptr = curr_call.get_field(j); 
-        unsigned length_descriptor = BCF_VL_FIXED;
-        unsigned num_elements = 1u;
-        fill_field_prep(field_ptr, query_config, j, length_descriptor, num_elements);
-        field_ptr->binary_deserialize(reinterpret_cast<const char*>(&(buffer[0])), offset, length_descriptor, num_elements);
-      }
-    }
-  }
+    binary_deserialize(variant.get_call(i), query_config, buffer, offset);
   //Common fields in the Variant object
   for(auto i=0u;i<variant.get_num_common_fields();++i)
   {
@@ -1051,6 +1794,16 @@ void VariantQueryProcessor::gt_fill_row(
     curr_call.mark_valid(false);
     return;
   }
+  //Predicate pushdown - calls rejected by the filter are dropped before any field is decoded
+  const auto& call_filter = query_config.get_call_filter();
+  if(!call_filter.empty() && !call_filter.evaluate(cell))
+  {
+#ifdef DO_PROFILING
+    stats_ptr->update_stat(GTProfileStats::GT_NUM_CELLS_REJECTED_BY_FILTER, 1u);
+#endif
+    curr_call.mark_valid(false);
+    return;
+  }
   curr_call.mark_valid(true);   //contains valid data for this query
 #ifdef DO_PROFILING
   stats_ptr->update_stat(GTProfileStats::GT_NUM_VALID_CELLS_IN_QUERY, 1u);
@@ -1111,18 +1864,88 @@ inline
 unsigned int VariantQueryProcessor::gt_initialize_forward_iter(
     const int ad,
     const VariantQueryConfig& query_config, const int64_t column,
-    VariantArrayCellIterator*& forward_iter) const {
+    VariantArrayCellIterator*& forward_iter, const int64_t end_column, const std::vector<int>* planning_schema_idxs) const {
   assert(query_config.is_bookkeeping_done());
   //Num attributes in query
   unsigned num_queried_attributes = query_config.get_num_queried_attributes();
   //Assign forward iterator
-  vector<int64_t> query_range = { query_config.get_smallest_row_idx_in_array(),
-    static_cast<int64_t>(query_config.get_num_rows_in_array()+query_config.get_smallest_row_idx_in_array()-1),
-    column, INT64_MAX };
-  forward_iter = get_storage_manager()->begin(ad, &(query_range[0]), query_config.get_query_attributes_schema_idxs());
+  //One subarray per block of queried rows - tiles containing only rows that are not queried are never read.
+  //The subarrays share the read buffers of the iterator, so the #blocks is limited by the buffer size too
+  auto num_arrays_per_iterator = (is_merged_array_descriptor(ad) && !query_config.scan_partitions_in_threads())
+    ? static_cast<unsigned>(m_partition_ads.size()) : 1u;
+  std::vector<RowRange> row_blocks;
+  query_config.get_query_row_blocks(row_blocks, std::min(MAX_NUM_ROW_BLOCKS_IN_FORWARD_ITER,
+        get_storage_manager()->get_max_num_subarrays(num_arrays_per_iterator, query_config.get_read_buffer_budget())));
+  //Jump to the first tile with data for the queried rows - if there is no such tile in the range, the
+  //iterator is left as is (it will not find any cells)
+  auto begin_column = column;
+  auto tile_index = get_tile_index(ad);
+  if(tile_index && !row_blocks.empty())
+  {
+    auto first_column = tile_index->get_first_column_at_or_after(column, row_blocks.front().first, row_blocks.back().second);
+    if(first_column <= end_column)
+      begin_column = first_column;
+  }
+  vector<int64_t> query_ranges(4u*row_blocks.size());
+  for(auto i=0ull;i<row_blocks.size();++i)
+  {
+    query_ranges[4u*i] = row_blocks[i].first;
+    query_ranges[4u*i+1u] = row_blocks[i].second;
+    query_ranges[4u*i+2u] = begin_column;
+    query_ranges[4u*i+3u] = end_column;
+  }
+  const auto& attribute_schema_idxs = planning_schema_idxs ? *planning_schema_idxs
+    : query_config.get_query_attributes_schema_idxs();
+  if(is_merged_array_descriptor(ad) && query_config.scan_partitions_in_threads())
+    forward_iter = get_storage_manager()->begin_with_array_threads(m_partition_ads, query_ranges,
+        attribute_schema_idxs,
+        query_config.get_prefetch_depth() > 0u ? query_config.get_prefetch_depth() : DEFAULT_PARTITION_PREFETCH_DEPTH,
+        query_config.get_cell_batch_size() > 0u ? query_config.get_cell_batch_size() : DEFAULT_CELL_BATCH_SIZE,
+        query_config.get_read_buffer_budget());
+  else if(is_merged_array_descriptor(ad))
+    forward_iter = get_storage_manager()->begin(m_partition_ads, query_ranges,
+        attribute_schema_idxs, query_config.get_read_buffer_budget());
+  else
+    forward_iter = get_storage_manager()->begin(ad, query_ranges, attribute_schema_idxs,
+        query_config.get_read_buffer_budget());
   return num_queried_attributes - 1;
 }
 
+int64_t VariantQueryProcessor::get_max_interval_length(const int ad) const
+{
+  if(!is_merged_array_descriptor(ad))
+    return get_storage_manager()->get_max_interval_length(ad);
+  auto max_interval_length = 0ll;
+  for(auto partition_ad : m_partition_ads)
+  {
+    auto curr_max_interval_length = get_storage_manager()->get_max_interval_length(partition_ad);
+    if(curr_max_interval_length < 0)
+      return -1ll;
+    max_interval_length = std::max<int64_t>(max_interval_length, curr_max_interval_length);
+  }
+  return max_interval_length;
+}
+
+void VariantQueryProcessor::gt_start_prefetch(const VariantQueryConfig& query_config,
+    VariantArrayCellIterator* forward_iter, const size_t cell_batch_size) const
+{
+  if(forward_iter == 0 || cell_batch_size == 0u || query_config.get_prefetch_depth() == 0u)
+    return;
+  forward_iter->start_prefetch(query_config.get_prefetch_depth(), cell_batch_size,
+      query_config.is_defined_query_idx_for_known_field_enum(GVCF_END_IDX)
+      ? query_config.get_query_idx_for_known_field_enum(GVCF_END_IDX) : -1);
+}
+
+int64_t VariantQueryProcessor::get_forward_iter_end_column(const VariantQueryConfig& query_config,
+    const unsigned column_interval_idx, const size_t cell_batch_size) const
+{
+  //Same conditions as gt_start_prefetch()
+  if(column_interval_idx >= query_config.get_num_column_intervals() || cell_batch_size == 0u
+      || query_config.get_prefetch_depth() == 0u)
+    return INT64_MAX;
+  return query_config.get_column_end(column_interval_idx);
+}
+
 void VariantQueryProcessor::clear()
 {
   m_schema_idx_to_known_variant_field_enum_LUT.reset_luts();
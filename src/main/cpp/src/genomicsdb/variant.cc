@@ -21,6 +21,7 @@
 */
 
 #include "variant.h"
+#include "variant_pool.h"
 
 auto json_indent_unit = "    ";
 
@@ -270,8 +271,7 @@ void VariantCall::print_Cotton_JSON(std::ostream& fptr, unsigned field_idx) cons
 {
   if(m_is_initialized && m_is_valid)
   {
-    assert(field_idx < m_fields.size());
-    auto& field = m_fields[field_idx];
+    auto& field = get_field(field_idx);
     if(field.get() && field->is_valid())  //non null, valid field
       field->print_Cotton_JSON(fptr);
     else
@@ -306,7 +306,7 @@ void VariantCall::copy_simple_members(const VariantCall& other)
 void VariantCall::move_in(VariantCall& other)
 {
   copy_simple_members(other);
-  m_fields.resize(other.get_all_fields().size());
+  resize(other.get_all_fields().size());
   unsigned idx = 0u;
   for(auto& other_field : other.get_all_fields())
   {
@@ -314,6 +314,18 @@ void VariantCall::move_in(VariantCall& other)
     ++idx;
   }
 }
+void VariantCall::swap(VariantCall& other)
+{
+  std::swap(m_is_valid, other.m_is_valid);
+  std::swap(m_is_initialized, other.m_is_initialized);
+  std::swap(m_contains_deletion, other.m_contains_deletion);
+  std::swap(m_is_reference_block, other.m_is_reference_block);
+  std::swap(m_row_idx, other.m_row_idx);
+  m_fields.swap(other.m_fields);
+  std::swap(m_col_begin, other.m_col_begin);
+  std::swap(m_col_end, other.m_col_end);
+}
+
 /*
  * Creates copy of Call object
  */
@@ -404,12 +416,147 @@ void VariantCall::binary_deserialize_header(const std::vector<uint8_t>& buffer,
   resize(num_fields);
 }
 
+//VariantCallEndPQ functions
+const uint64_t VariantCallEndPQ::UNDEFINED_HEAP_POSITION;
+
+void VariantCallEndPQ::push(VariantCall* call, const uint64_t call_idx)
+{
+  //Already in the heap - replace the entry and restore heap order, never add a second entry for call_idx
+  if(contains(call_idx))
+  {
+    m_heap[m_heap_position[call_idx]].first = call;
+    update(call_idx);
+    return;
+  }
+  if(call_idx >= m_heap_position.size())
+    m_heap_position.resize(call_idx+1u, UNDEFINED_HEAP_POSITION);
+  m_heap_position[call_idx] = m_heap.size();
+  m_heap.emplace_back(call, call_idx);
+  sift_up(m_heap.size()-1u);
+}
+
+void VariantCallEndPQ::remove(const uint64_t call_idx)
+{
+  if(contains(call_idx))
+    remove_at(m_heap_position[call_idx]);
+}
+
+void VariantCallEndPQ::update(const uint64_t call_idx)
+{
+  assert(contains(call_idx));
+  auto heap_position = m_heap_position[call_idx];
+  sift_up(heap_position);
+  //If the element moved up, sift_down does nothing
+  sift_down(m_heap_position[call_idx]);
+}
+
+void VariantCallEndPQ::clear()
+{
+  m_heap.clear();
+  m_heap_position.clear();
+}
+
+void VariantCallEndPQ::remove_at(const size_t heap_position)
+{
+  assert(heap_position < m_heap.size());
+  auto last_position = m_heap.size()-1u;
+  if(heap_position != last_position)
+    swap_entries(heap_position, last_position);
+  m_heap_position[m_heap[last_position].second] = UNDEFINED_HEAP_POSITION;
+  m_heap.pop_back();
+  //Element moved from the end of the heap may have to go either way
+  if(heap_position < m_heap.size())
+  {
+    sift_up(heap_position);
+    sift_down(heap_position);
+  }
+}
+
+void VariantCallEndPQ::sift_up(size_t heap_position)
+{
+  while(heap_position > 0u)
+  {
+    auto parent = (heap_position-1u)/2u;
+    if(!is_less(heap_position, parent))
+      break;
+    swap_entries(heap_position, parent);
+    heap_position = parent;
+  }
+}
+
+void VariantCallEndPQ::sift_down(size_t heap_position)
+{
+  auto heap_size = m_heap.size();
+  while(true)
+  {
+    auto smallest = heap_position;
+    auto left = 2u*heap_position+1u;
+    auto right = left+1u;
+    if(left < heap_size && is_less(left, smallest))
+      smallest = left;
+    if(right < heap_size && is_less(right, smallest))
+      smallest = right;
+    if(smallest == heap_position)
+      break;
+    swap_entries(heap_position, smallest);
+    heap_position = smallest;
+  }
+}
+
 //Variant functions
 //FIXME: still assumes that Calls are allocated once and re-used across queries, need not be true
 void Variant::reset_for_new_interval()
 {
   for(auto& call : m_calls)
     call.reset_for_new_interval();
+  m_active_call_idxs.clear();
+  m_num_sorted_active_calls = 0ull;
+}
+
+void Variant::enable_active_calls_tracking()
+{
+  m_track_active_calls = true;
+  //Initialize with currently valid calls
+  m_active_call_idxs.clear();
+  for(auto i=0ull;i<m_calls.size();++i)
+    if(m_calls[i].is_valid())
+      m_active_call_idxs.push_back(i);
+  m_num_sorted_active_calls = m_active_call_idxs.size();
+}
+
+void Variant::disable_active_calls_tracking()
+{
+  m_track_active_calls = false;
+  m_active_call_idxs.clear();
+  m_num_sorted_active_calls = 0ull;
+}
+
+void Variant::update_active_calls()
+{
+  if(!m_track_active_calls)
+    return;
+  //Remove calls that are no longer valid - order of remaining elements is preserved
+  auto num_sorted = 0ull;
+  auto num_retained = 0ull;
+  for(auto i=0ull;i<m_active_call_idxs.size();++i)
+  {
+    auto call_idx = m_active_call_idxs[i];
+    if(m_calls[call_idx].is_valid())
+    {
+      m_active_call_idxs[num_retained++] = call_idx;
+      if(i < m_num_sorted_active_calls)
+        ++num_sorted;
+    }
+  }
+  m_active_call_idxs.resize(num_retained);
+  //Merge newly added calls with the sorted prefix - the same call may have been added again
+  if(num_sorted < num_retained)
+  {
+    std::sort(m_active_call_idxs.begin()+num_sorted, m_active_call_idxs.end());
+    std::inplace_merge(m_active_call_idxs.begin(), m_active_call_idxs.begin()+num_sorted, m_active_call_idxs.end());
+    m_active_call_idxs.erase(std::unique(m_active_call_idxs.begin(), m_active_call_idxs.end()), m_active_call_idxs.end());
+  }
+  m_num_sorted_active_calls = m_active_call_idxs.size();
 }
 
 void Variant::resize_based_on_query()
@@ -758,7 +905,8 @@ void Variant::get_column_sorted_call_idx_vec(std::vector<uint64_t>& query_row_id
 }
 
 void Variant::move_calls_to_separate_variants(const VariantQueryConfig& query_config, std::vector<Variant>& variants, 
-    std::vector<uint64_t>& query_row_idx_in_order, GA4GHCallInfoToVariantIdx& call_info_2_variant, GA4GHPagingInfo* paging_info)
+    std::vector<uint64_t>& query_row_idx_in_order, GA4GHCallInfoToVariantIdx& call_info_2_variant, GA4GHPagingInfo* paging_info,
+    VariantPool* variant_pool)
 {
 #ifdef DUPLICATE_CELL_AT_END
   get_column_sorted_call_idx_vec(query_row_idx_in_order);
@@ -786,7 +934,7 @@ void Variant::move_calls_to_separate_variants(const VariantQueryConfig& query_co
     if(paging_info && paging_info->handled_previously(curr_row_idx, curr_column_idx))
       continue;
     auto newly_inserted = move_call_to_variant_vector(query_config, to_move_call, variants, call_info_2_variant,
-        stop_inserting_new_variants); 
+        stop_inserting_new_variants, variant_pool);
     //If paging, complex logic for checking page end 
     PAGE_END_CHECK_LOGIC 
     last_column_idx = curr_column_idx;
@@ -798,6 +946,9 @@ void Variant::copy_simple_members(const Variant& other)
   m_query_config = other.m_query_config;
   m_col_begin = other.m_col_begin;
   m_col_end = other.m_col_end;
+  m_track_active_calls = other.m_track_active_calls;
+  m_active_call_idxs = other.m_active_call_idxs;
+  m_num_sorted_active_calls = other.m_num_sorted_active_calls;
 }
 
 //Memory de-allocation
@@ -806,6 +957,8 @@ void Variant::clear()
   for(auto& call : m_calls)
     call.clear();
   m_calls.clear();
+  m_active_call_idxs.clear();
+  m_num_sorted_active_calls = 0ull;
   m_fields.clear();
   m_common_fields_query_idxs.clear();
 }
@@ -850,6 +1003,17 @@ void Variant::copy_common_fields(const Variant& other)
 
 void Variant::deep_copy_simple_members(const Variant& other)
 {
+  //Only the active calls of other need to be copied - invalidate calls that were active in this object
+  //(other calls were invalidated by previous invocations)
+  if(m_track_active_calls && other.m_track_active_calls && m_calls.size() == other.get_num_calls())
+  {
+    for(auto call_idx : m_active_call_idxs)
+      m_calls[call_idx].mark_valid(false);
+    copy_simple_members(other);
+    for(auto call_idx : m_active_call_idxs)
+      m_calls[call_idx].deep_copy_simple_members(other.get_call(call_idx));
+    return;
+  }
   //Copy simple primitive members
   copy_simple_members(other);
   //Copy simple primitive members of member calls
@@ -921,12 +1085,18 @@ void Variant::binary_deserialize_header(const std::vector<uint8_t>& buffer, uint
 }
 
 bool move_call_to_variant_vector(const VariantQueryConfig& query_config, VariantCall& to_move_call,
-    std::vector<Variant>& variants, GA4GHCallInfoToVariantIdx& call_info_2_variant, bool stop_inserting_new_variants)
+    std::vector<Variant>& variants, GA4GHCallInfoToVariantIdx& call_info_2_variant, bool stop_inserting_new_variants,
+    VariantPool* variant_pool)
 {
   uint64_t variant_idx = variants.size();
   bool newly_inserted = call_info_2_variant.find_or_insert(query_config, to_move_call, variant_idx);
   if(newly_inserted && !stop_inserting_new_variants)
-    variants.emplace_back(Variant());
+  {
+    if(variant_pool)
+      variant_pool->append_variant(variants);
+    else
+      variants.emplace_back(Variant());
+  }
   //variant_idx can be >= variants.size() if stop_inserting_new_variants is true
   assert(variant_idx < variants.size() || stop_inserting_new_variants);
   if((!newly_inserted && variant_idx < variants.size()) || !stop_inserting_new_variants)
@@ -934,7 +1104,10 @@ bool move_call_to_variant_vector(const VariantQueryConfig& query_config, Variant
     Variant& curr_variant = variants[variant_idx];
     //Set position of variant
     curr_variant.set_column_interval(to_move_call.get_column_begin(), to_move_call.get_column_end());
-    curr_variant.add_call(std::move(to_move_call));
+    if(variant_pool)
+      variant_pool->move_call_to_variant(curr_variant, to_move_call);
+    else
+      curr_variant.add_call(std::move(to_move_call));
   }
   return newly_inserted;
 }
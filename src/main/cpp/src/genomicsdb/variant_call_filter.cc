@@ -0,0 +1,174 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to 
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of 
+ * the Software, and to permit persons to whom the Software is furnished to do so, 
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS 
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR 
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "variant_call_filter.h"
+#include "variant_cell.h"
+#include "vcf.h"
+
+//Longest operators first so that "<=" is not parsed as "<"
+static const char* g_filter_op_strings[] = { "==", "!=", "<=", ">=", "<", ">" };
+static const VariantCallFilter::ComparisonOpEnum g_filter_op_enums[] = {
+  VariantCallFilter::FILTER_OP_EQ, VariantCallFilter::FILTER_OP_NE,
+  VariantCallFilter::FILTER_OP_LE, VariantCallFilter::FILTER_OP_GE,
+  VariantCallFilter::FILTER_OP_LT, VariantCallFilter::FILTER_OP_GT
+};
+
+void VariantCallFilter::parse(const std::string& expression)
+{
+  clear();
+  m_expression = expression;
+  auto clause_begin = 0ull;
+  //Empty expression - no clauses
+  auto done = (expression.find_first_not_of(" \t") == std::string::npos);
+  while(!done)
+  {
+    auto clause_end = expression.find("&&", clause_begin);
+    if(clause_end == std::string::npos)
+      clause_end = expression.length();
+    auto clause_string = expression.substr(clause_begin, clause_end-clause_begin);
+    //Field name
+    auto name_begin = clause_string.find_first_not_of(" \t");
+    auto name_end = clause_string.find_first_of(" \t=!<>", name_begin);
+    if(name_begin == std::string::npos || name_end == std::string::npos || name_end == name_begin)
+      throw VariantCallFilterException(std::string("Malformed clause '")+clause_string+"' in filter expression '"
+          +expression+"'");
+    auto field_name = clause_string.substr(name_begin, name_end-name_begin);
+    //Operator
+    auto op_begin = clause_string.find_first_not_of(" \t", name_end);
+    auto op_idx = 0u;
+    auto num_ops = sizeof(g_filter_op_strings)/sizeof(g_filter_op_strings[0]);
+    for(;op_begin != std::string::npos && op_idx<num_ops;++op_idx)
+      if(clause_string.compare(op_begin, strlen(g_filter_op_strings[op_idx]), g_filter_op_strings[op_idx]) == 0)
+        break;
+    if(op_begin == std::string::npos || op_idx >= num_ops)
+      throw VariantCallFilterException(std::string("Unknown comparison operator in clause '")+clause_string
+          +"' - must be one of ==, !=, <, <=, >, >=");
+    //Value
+    auto value_begin = op_begin + strlen(g_filter_op_strings[op_idx]);
+    const char* value_ptr = clause_string.c_str()+value_begin;
+    char* value_end_ptr = 0;
+    auto value = strtod(value_ptr, &value_end_ptr);
+    if(value_end_ptr == value_ptr
+        || clause_string.find_first_not_of(" \t", value_end_ptr-clause_string.c_str()) != std::string::npos)
+      throw VariantCallFilterException(std::string("Clause '")+clause_string+"' must compare field "+field_name
+          +" with a number");
+    m_clauses.emplace_back(field_name, g_filter_op_enums[op_idx], value);
+    done = (clause_end == expression.length());
+    clause_begin = clause_end+2u;
+  }
+}
+
+void VariantCallFilter::bind_field(const unsigned clause_idx, const unsigned query_idx, const std::type_index& type)
+{
+  assert(clause_idx < m_clauses.size());
+  auto& clause = m_clauses[clause_idx];
+  clause.m_query_idx = query_idx;
+  if(type == std::type_index(typeid(int)))
+    clause.m_field_type = FILTER_FIELD_TYPE_INT;
+  else if(type == std::type_index(typeid(unsigned)))
+    clause.m_field_type = FILTER_FIELD_TYPE_UNSIGNED;
+  else if(type == std::type_index(typeid(int64_t)))
+    clause.m_field_type = FILTER_FIELD_TYPE_INT64;
+  else if(type == std::type_index(typeid(uint64_t)))
+    clause.m_field_type = FILTER_FIELD_TYPE_UINT64;
+  else if(type == std::type_index(typeid(float)))
+    clause.m_field_type = FILTER_FIELD_TYPE_FLOAT;
+  else if(type == std::type_index(typeid(double)))
+    clause.m_field_type = FILTER_FIELD_TYPE_DOUBLE;
+  else
+    throw VariantCallFilterException(std::string("Field ")+clause.m_field_name
+        +" cannot be used in a filter expression - only numeric fields are supported");
+}
+
+template<class T>
+bool VariantCallFilter::evaluate_clause(const FilterClause& clause, const BufferVariantCell& cell) const
+{
+  auto ptr = cell.get_field_ptr_for_query_idx<T>(clause.m_query_idx);
+  auto num_elements = cell.get_field_length(clause.m_query_idx);
+  for(auto i=0;i<num_elements;++i)
+  {
+    auto val = ptr[i];
+    if(is_tiledb_missing_value<T>(val))
+      continue;
+    auto x = static_cast<double>(val);
+    auto passes = false;
+    switch(clause.m_op)
+    {
+      case FILTER_OP_EQ:
+        passes = (x == clause.m_value);
+        break;
+      case FILTER_OP_NE:
+        passes = (x != clause.m_value);
+        break;
+      case FILTER_OP_LT:
+        passes = (x < clause.m_value);
+        break;
+      case FILTER_OP_LE:
+        passes = (x <= clause.m_value);
+        break;
+      case FILTER_OP_GT:
+        passes = (x > clause.m_value);
+        break;
+      case FILTER_OP_GE:
+        passes = (x >= clause.m_value);
+        break;
+    }
+    if(passes)
+      return true;
+  }
+  return false;
+}
+
+bool VariantCallFilter::evaluate(const BufferVariantCell& cell) const
+{
+  for(const auto& clause : m_clauses)
+  {
+    assert(clause.m_query_idx != UNDEFINED_ATTRIBUTE_IDX_VALUE && "Filter fields must be bound before evaluation");
+    auto passes = false;
+    switch(clause.m_field_type)
+    {
+      case FILTER_FIELD_TYPE_INT:
+        passes = evaluate_clause<int>(clause, cell);
+        break;
+      case FILTER_FIELD_TYPE_UNSIGNED:
+        passes = evaluate_clause<unsigned>(clause, cell);
+        break;
+      case FILTER_FIELD_TYPE_INT64:
+        passes = evaluate_clause<int64_t>(clause, cell);
+        break;
+      case FILTER_FIELD_TYPE_UINT64:
+        passes = evaluate_clause<uint64_t>(clause, cell);
+        break;
+      case FILTER_FIELD_TYPE_FLOAT:
+        passes = evaluate_clause<float>(clause, cell);
+        break;
+      case FILTER_FIELD_TYPE_DOUBLE:
+        passes = evaluate_clause<double>(clause, cell);
+        break;
+      default:
+        throw VariantCallFilterException(std::string("Field ")+clause.m_field_name+" is not bound to a queried field");
+    }
+    if(!passes)
+      return false;
+  }
+  return true;
+}
@@ -105,3 +105,63 @@ void BufferVariantCell::set_cell(const void* ptr)
   assert(offset == cell_size);
 #endif
 }
+
+//VariantCellBatch functions
+void VariantCellBatch::initialize(const unsigned num_queried_attributes, const int END_query_idx)
+{
+  assert(END_query_idx < static_cast<int>(num_queried_attributes));
+  m_END_query_idx = END_query_idx;
+  m_offsets.resize(num_queried_attributes);
+  m_values.resize(num_queried_attributes);
+  clear();
+}
+
+void VariantCellBatch::clear()
+{
+  m_rows.clear();
+  m_columns.clear();
+  m_END_values.clear();
+  for(auto i=0u;i<m_offsets.size();++i)
+  {
+    m_offsets[i].resize(1u);
+    m_offsets[i][0u] = 0ull;
+    m_values[i].clear();
+  }
+}
+
+void VariantCellBatch::add_field(const unsigned query_idx, const void* ptr, const size_t num_bytes)
+{
+  assert(query_idx < m_offsets.size());
+  //Cell for which data is being added
+  assert(m_offsets[query_idx].size() == m_rows.size());
+  auto& values = m_values[query_idx];
+  auto src = reinterpret_cast<const uint8_t*>(ptr);
+  values.insert(values.end(), src, src+num_bytes);
+  m_offsets[query_idx].push_back(values.size());
+  if(static_cast<int>(query_idx) == m_END_query_idx)
+  {
+    assert(num_bytes == sizeof(int64_t));
+    m_END_values.push_back(*(reinterpret_cast<const int64_t*>(ptr)));
+  }
+}
+
+void VariantCellBatch::swap(VariantCellBatch& other)
+{
+  std::swap(m_END_query_idx, other.m_END_query_idx);
+  m_rows.swap(other.m_rows);
+  m_columns.swap(other.m_columns);
+  m_END_values.swap(other.m_END_values);
+  m_offsets.swap(other.m_offsets);
+  m_values.swap(other.m_values);
+}
+
+void VariantCellBatch::set_cell(BufferVariantCell& cell, const size_t cell_idx) const
+{
+  assert(cell_idx < size());
+  for(auto i=0u;i<m_offsets.size();++i)
+  {
+    cell.set_field_ptr_for_query_idx(i, get_field_ptr(i, cell_idx));
+    cell.set_field_size_in_bytes(i, get_field_size_in_bytes(i, cell_idx));
+  }
+  cell.set_coordinates(m_rows[cell_idx], m_columns[cell_idx]);
+}
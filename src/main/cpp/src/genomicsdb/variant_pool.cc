@@ -0,0 +1,127 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to 
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of 
+ * the Software, and to permit persons to whom the Software is furnished to do so, 
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS 
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR 
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "variant_pool.h"
+
+void VariantPool::set_query_config(const VariantQueryConfig& query_config)
+{
+  auto query_attributes_schema_idxs = query_config.get_query_attributes_schema_idxs();
+  if(query_attributes_schema_idxs != m_query_attributes_schema_idxs)
+  {
+    //Field objects of pooled calls may have the wrong types for the new query
+    m_calls.clear();
+    m_query_attributes_schema_idxs = std::move(query_attributes_schema_idxs);
+  }
+}
+
+void VariantPool::append_variant(std::vector<Variant>& variants)
+{
+  if(m_variants.empty())
+  {
+    variants.emplace_back(Variant());
+    ++m_num_variant_allocations;
+  }
+  else
+  {
+    variants.emplace_back(std::move(m_variants.back()));
+    m_variants.pop_back();
+    ++m_num_variant_reuses;
+  }
+}
+
+void VariantPool::append_calls(Variant& variant, const uint64_t num_calls)
+{
+  auto num_reused_calls = std::min<uint64_t>(num_calls, m_calls.size());
+  for(auto i=0ull;i<num_reused_calls;++i)
+  {
+    variant.add_call(std::move(m_calls.back()));
+    m_calls.pop_back();
+  }
+  for(auto i=num_reused_calls;i<num_calls;++i)
+    variant.add_call(VariantCall());
+  m_num_call_reuses += num_reused_calls;
+  m_num_call_allocations += (num_calls - num_reused_calls);
+}
+
+void VariantPool::move_call_to_variant(Variant& variant, VariantCall& to_move_call)
+{
+  if(m_calls.empty())
+  {
+    variant.add_call(std::move(to_move_call));
+    ++m_num_call_allocations;
+  }
+  else
+  {
+    //Move constructor - moves the field vector, no field objects are allocated
+    variant.add_call(std::move(m_calls.back()));
+    m_calls.pop_back();
+    variant.get_calls().back().swap(to_move_call);
+    ++m_num_call_reuses;
+  }
+}
+
+void VariantPool::release(Variant& variant)
+{
+  for(auto& call : variant.get_calls())
+  {
+    if(m_calls.size() >= m_max_num_pooled_calls)
+      break;
+    call.reset_for_new_interval();
+    //Stale data must not be seen by the next user of the call
+    for(auto& field : call.get_all_fields())
+      if(field.get())
+        field->set_valid(false);
+    m_calls.emplace_back(std::move(call));
+  }
+  //Capacity of the calls vector is retained
+  variant.get_calls().clear();
+  variant.disable_active_calls_tracking();
+  variant.resize_common_fields(0u);
+  //The query config may not outlive the query
+  variant.set_query_config(0);
+}
+
+void VariantPool::release(std::vector<Variant>& variants)
+{
+  for(auto& variant : variants)
+  {
+    release(variant);
+    if(m_variants.size() < m_max_num_pooled_variants)
+      m_variants.emplace_back(std::move(variant));
+  }
+  variants.clear();
+}
+
+void VariantPool::reset_stats()
+{
+  m_num_variant_allocations = 0ull;
+  m_num_call_allocations = 0ull;
+  m_num_variant_reuses = 0ull;
+  m_num_call_reuses = 0ull;
+}
+
+void VariantPool::print_stats(std::ostream& fptr) const
+{
+  fptr << "Variant pool: #variants allocated "<<m_num_variant_allocations<<" reused "<<m_num_variant_reuses
+    <<" #calls allocated "<<m_num_call_allocations<<" reused "<<m_num_call_reuses
+    <<" pooled variants "<<m_variants.size()<<" calls "<<m_calls.size()<<"\n";
+}
@@ -68,6 +68,42 @@ void VariantQueryConfig::set_column_interval_to_query(const int64_t colBegin, co
   m_query_column_intervals[0] = make_pair(colBegin, colEnd);
 }
 
+uint64_t VariantQueryConfig::get_num_queried_columns() const
+{
+  auto num_columns = 0ull;
+  for(const auto& interval : m_query_column_intervals)
+    num_columns += (interval.second - interval.first + 1);
+  return num_columns;
+}
+
+void VariantQueryConfig::coalesce_column_intervals(VariantQueryConfig& coalesced_query_config,
+    std::vector<ColumnRange>& target_intervals) const
+{
+  auto sorted_intervals = m_query_column_intervals;
+  std::sort(sorted_intervals.begin(), sorted_intervals.end(), ColumnRangeCompare);
+  //Merge overlapping/adjacent intervals - a single forward pass cannot produce duplicate output for a column
+  target_intervals.clear();
+  for(const auto& interval : sorted_intervals)
+  {
+    if(!target_intervals.empty() && interval.first <= target_intervals.back().second+1)
+      target_intervals.back().second = std::max(target_intervals.back().second, interval.second);
+    else
+      target_intervals.push_back(interval);
+  }
+  //Group nearby targets into scan intervals
+  std::vector<ColumnRange> scan_intervals;
+  for(const auto& interval : target_intervals)
+  {
+    if(!scan_intervals.empty()
+        && static_cast<uint64_t>(interval.first - scan_intervals.back().second - 1) <= m_coalesce_column_intervals_max_gap)
+      scan_intervals.back().second = interval.second;
+    else
+      scan_intervals.push_back(interval);
+  }
+  coalesced_query_config = *this;
+  coalesced_query_config.set_column_intervals_to_query(scan_intervals);
+}
+
 void VariantQueryConfig::invalidate_array_row_idx_to_query_row_idx_map(bool all_rows)
 {
   if(all_rows)
@@ -106,6 +142,44 @@ void VariantQueryConfig::setup_array_row_idx_to_query_row_idx_map()
   m_query_rows = std::move(tmp_vector);
 }
 
+void VariantQueryConfig::get_query_row_blocks(std::vector<RowRange>& row_blocks, const unsigned max_num_blocks) const
+{
+  assert(max_num_blocks > 0u);
+  row_blocks.clear();
+  if(m_query_all_rows)
+  {
+    row_blocks.emplace_back(m_smallest_row_idx, static_cast<int64_t>(get_num_rows_in_array())+m_smallest_row_idx-1);
+    return;
+  }
+  //m_query_rows is sorted
+  for(auto row_idx : m_query_rows)
+  {
+    if(row_blocks.empty() || row_idx > row_blocks.back().second+1)
+      row_blocks.emplace_back(row_idx, row_idx);
+    else
+      row_blocks.back().second = std::max(row_blocks.back().second, row_idx);
+  }
+  if(row_blocks.size() <= max_num_blocks)
+    return;
+  //Too many blocks - merge blocks separated by gaps <= the (#blocks-max_num_blocks)-th smallest gap
+  std::vector<int64_t> gaps(row_blocks.size()-1u);
+  for(auto i=1ull;i<row_blocks.size();++i)
+    gaps[i-1u] = row_blocks[i].first - row_blocks[i-1u].second;
+  auto num_merges = row_blocks.size() - max_num_blocks;
+  std::nth_element(gaps.begin(), gaps.begin()+(num_merges-1u), gaps.end());
+  auto max_merged_gap = gaps[num_merges-1u];
+  auto num_merged_blocks = 1ull;
+  for(auto i=1ull;i<row_blocks.size();++i)
+  {
+    auto& last_block = row_blocks[num_merged_blocks-1u];
+    if(row_blocks[i].first - last_block.second <= max_merged_gap)
+      last_block.second = row_blocks[i].second;
+    else
+      row_blocks[num_merged_blocks++] = row_blocks[i];
+  }
+  row_blocks.resize(num_merged_blocks);
+}
+
 void VariantQueryConfig::update_rows_to_query(const std::vector<int64_t>& rows)
 {
   assert(is_bookkeeping_done());
@@ -0,0 +1,171 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to 
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of 
+ * the Software, and to permit persons to whom the Software is furnished to do so, 
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS 
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR 
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "variant_query_result_cache.h"
+
+void VariantQueryResultCache::set_max_num_bytes(const size_t max_num_bytes)
+{
+#pragma omp critical(variant_query_result_cache)
+  {
+    m_max_num_bytes = max_num_bytes;
+    evict(m_max_num_bytes);
+  }
+}
+
+size_t VariantQueryResultCache::get_max_num_bytes() const
+{
+  size_t value = 0u;
+#pragma omp critical(variant_query_result_cache)
+  value = m_max_num_bytes;
+  return value;
+}
+
+size_t VariantQueryResultCache::get_num_bytes() const
+{
+  size_t value = 0u;
+#pragma omp critical(variant_query_result_cache)
+  value = m_num_bytes;
+  return value;
+}
+
+size_t VariantQueryResultCache::size() const
+{
+  size_t value = 0u;
+#pragma omp critical(variant_query_result_cache)
+  value = m_key_to_entry.size();
+  return value;
+}
+
+uint64_t VariantQueryResultCache::get_num_hits() const
+{
+  uint64_t value = 0ull;
+#pragma omp critical(variant_query_result_cache)
+  value = m_num_hits;
+  return value;
+}
+
+uint64_t VariantQueryResultCache::get_num_misses() const
+{
+  uint64_t value = 0ull;
+#pragma omp critical(variant_query_result_cache)
+  value = m_num_misses;
+  return value;
+}
+
+uint64_t VariantQueryResultCache::get_num_evictions() const
+{
+  uint64_t value = 0ull;
+#pragma omp critical(variant_query_result_cache)
+  value = m_num_evictions;
+  return value;
+}
+
+void VariantQueryResultCache::reset_stats()
+{
+#pragma omp critical(variant_query_result_cache)
+  {
+    m_num_hits = 0ull;
+    m_num_misses = 0ull;
+    m_num_evictions = 0ull;
+  }
+}
+
+bool VariantQueryResultCache::lookup(const std::string& key, std::vector<uint8_t>& serialized_variants,
+    GA4GHPagingInfo* paging_info)
+{
+  auto found = false;
+#pragma omp critical(variant_query_result_cache)
+  {
+    auto iter = m_key_to_entry.find(key);
+    if(iter != m_key_to_entry.end())
+    {
+      //Move to front of LRU list
+      m_lru_list.splice(m_lru_list.begin(), m_lru_list, iter->second);
+      const auto& entry = m_lru_list.front();
+      serialized_variants = entry.m_serialized_variants;
+      if(paging_info)
+        *paging_info = entry.m_paging_info;
+      ++m_num_hits;
+      found = true;
+    }
+    else
+      ++m_num_misses;
+  }
+  return found;
+}
+
+void VariantQueryResultCache::insert(const std::string& key, const uint8_t* serialized_variants, const size_t num_bytes,
+    const GA4GHPagingInfo* paging_info)
+{
+#pragma omp critical(variant_query_result_cache)
+  {
+    auto iter = m_key_to_entry.find(key);
+    if(iter != m_key_to_entry.end())
+    {
+      m_num_bytes -= get_entry_size(*(iter->second));
+      m_lru_list.erase(iter->second);
+      m_key_to_entry.erase(iter);
+    }
+    CacheEntry entry;
+    entry.m_key = key;
+    entry.m_serialized_variants.assign(serialized_variants, serialized_variants+num_bytes);
+    if(paging_info)
+      entry.m_paging_info = *paging_info;
+    auto entry_size = get_entry_size(entry);
+    if(entry_size <= m_max_num_bytes)
+    {
+      evict(m_max_num_bytes - entry_size);
+      m_lru_list.push_front(std::move(entry));
+      m_key_to_entry[key] = m_lru_list.begin();
+      m_num_bytes += entry_size;
+    }
+  }
+}
+
+void VariantQueryResultCache::clear()
+{
+#pragma omp critical(variant_query_result_cache)
+  {
+    m_lru_list.clear();
+    m_key_to_entry.clear();
+    m_num_bytes = 0ull;
+  }
+}
+
+void VariantQueryResultCache::evict(const size_t max_num_bytes)
+{
+  while(m_num_bytes > max_num_bytes && !m_lru_list.empty())
+  {
+    const auto& entry = m_lru_list.back();
+    m_num_bytes -= get_entry_size(entry);
+    m_key_to_entry.erase(entry.m_key);
+    m_lru_list.pop_back();
+    ++m_num_evictions;
+  }
+}
+
+void VariantQueryResultCache::print_stats(std::ostream& fptr) const
+{
+#pragma omp critical(variant_query_result_cache)
+  fptr << "Query result cache : #hits " << m_num_hits << " #misses " << m_num_misses << " #evictions " << m_num_evictions
+    << " #entries " << m_key_to_entry.size() << " size " << m_num_bytes << "/" << m_max_num_bytes << " bytes\n";
+}
@@ -23,10 +23,23 @@
 #include "variant_storage_manager.h"
 #include "variant_field_data.h"
 #include <sys/stat.h>
+#include <dirent.h>
 #include "json_config.h"
+#include "histogram.h"
 
 #define VERIFY_OR_THROW(X) if(!(X)) throw VariantStorageManagerException(#X);
 #define GET_METADATA_PATH(workspace, array) ((workspace)+'/'+(array)+"/genomicsdb_meta.json")
+#define GET_TILE_INDEX_PATH(workspace, array) ((workspace)+'/'+(array)+"/genomicsdb_tile_index")
+//Book-keeping file present in every fragment directory of a TileDB array
+#ifndef TILEDB_FRAGMENT_FILENAME
+#define TILEDB_FRAGMENT_FILENAME "__tiledb_fragment.tdb"
+#endif
+
+//Tile index file - magic, #fragments, #cells per tile, #tiles, followed by 5 int64_t values per tile
+#define TILE_INDEX_FILE_MAGIC "GDBTIDX2"
+#define TILE_INDEX_FILE_MAGIC_LENGTH 8u
+//Older format without #fragments - cannot be validated against the array
+#define TILE_INDEX_FILE_MAGIC_V1 "GDBTIDX1"
 
 const std::unordered_map<std::string, int> VariantStorageManager::m_mode_string_to_int = {
   { "r", TILEDB_ARRAY_READ },
@@ -39,36 +52,120 @@ std::vector<const char*> VariantStorageManager::m_metadata_attributes = std::vec
 //ceil(buffer_size/field_size)*field_size
 #define GET_ALIGNED_BUFFER_SIZE(buffer_size, field_size) ((((buffer_size)+(field_size)-1u)/(field_size))*(field_size))
 
+//When the iterator is over multiple subarrays, the buffer size is split among the TileDB iterators
+//but each TileDB iterator gets at least this much
+#define MIN_BUFFER_SIZE_PER_SUBARRAY (64u*1024u)
+
+//Adaptive buffer sizing - no buffer is smaller than this
+#define MIN_ADAPTIVE_BUFFER_SIZE (64u*1024u)
+//Guess for the #elements in a cell of a variable length attribute that has not been read before
+#define DEFAULT_NUM_ELEMENTS_IN_VARIABLE_LENGTH_CELL 8u
+
+//VariantArrayReadStats functions
+void VariantArrayReadStats::update(const int schema_idx, const uint64_t num_cells, const uint64_t num_bytes,
+    const uint64_t num_refills)
+{
+#pragma omp critical(variant_array_read_stats)
+  {
+    assert(static_cast<size_t>(schema_idx) < m_num_cells.size());
+    m_num_cells[schema_idx] += num_cells;
+    m_num_bytes[schema_idx] += num_bytes;
+    m_num_refills[schema_idx] += num_refills;
+  }
+}
+
+void VariantArrayReadStats::add_iterator(const uint64_t num_buffer_bytes)
+{
+#pragma omp critical(variant_array_read_stats)
+  {
+    ++m_num_iterators;
+    m_num_buffer_bytes += num_buffer_bytes;
+  }
+}
+
+double VariantArrayReadStats::get_average_cell_size(const int schema_idx) const
+{
+  auto average = 0.0;
+#pragma omp critical(variant_array_read_stats)
+  {
+    assert(static_cast<size_t>(schema_idx) < m_num_cells.size());
+    if(m_num_cells[schema_idx] > 0ull)
+      average = static_cast<double>(m_num_bytes[schema_idx])/m_num_cells[schema_idx];
+  }
+  return average;
+}
+
 //VariantArrayCellIterator functions
 VariantArrayCellIterator::VariantArrayCellIterator(TileDB_CTX* tiledb_ctx, const VariantArraySchema& variant_array_schema,
-        const std::string& array_path, const int64_t* range, const std::vector<int>& attribute_ids, const size_t buffer_size)
+        const std::string& array_path, const int64_t* ranges, const unsigned num_ranges,
+        const std::vector<int>& attribute_ids, const size_t buffer_size,
+        const size_t buffer_budget, const std::shared_ptr<VariantArrayReadStats>& read_stats)
+  : VariantArrayCellIterator(tiledb_ctx, variant_array_schema, std::vector<std::string>(num_ranges, array_path),
+      ranges, attribute_ids, buffer_size, buffer_budget, read_stats)
+{ }
+
+VariantArrayCellIterator::VariantArrayCellIterator(TileDB_CTX* tiledb_ctx, const VariantArraySchema& variant_array_schema,
+        const std::vector<std::string>& iterator_array_paths, const int64_t* ranges,
+        const std::vector<int>& attribute_ids, const size_t buffer_size,
+        const size_t buffer_budget, const std::shared_ptr<VariantArrayReadStats>& read_stats)
   : m_num_queried_attributes(attribute_ids.size()), m_tiledb_ctx(tiledb_ctx),
-  m_variant_array_schema(&variant_array_schema), m_cell(variant_array_schema, attribute_ids)
+  m_variant_array_schema(&variant_array_schema), m_cell(variant_array_schema, attribute_ids),
+  m_iterators_pq(TileDBIteratorColumnMajorCompare(&m_iterators_coords)),
+  m_attribute_ids(attribute_ids), m_read_stats(read_stats)
 #ifdef DO_PROFILING
   , m_tiledb_timer()
   , m_tiledb_to_buffer_cell_timer()
 #endif
 {
+  m_prefetch_depth = 0u;
+  m_prefetch_batch_size = 0u;
+  m_prefetch_head_idx = 0u;
+  m_num_prefetched_batches = 0u;
+  m_prefetch_done = false;
+  m_stop_prefetch = false;
+  m_num_cells_read = 0ull;
+  m_array_batch_size = 0u;
+  //One TileDB iterator per (array, subarray) pair
+  auto num_iterators = static_cast<unsigned>(iterator_array_paths.size());
+  auto multiple_arrays = false;
+  for(auto r=1u;r<num_iterators && !multiple_arrays;++r)
+    multiple_arrays = (iterator_array_paths[r] != iterator_array_paths[0u]);
+  m_num_bytes_read.resize(m_num_queried_attributes, 0ull);
+  m_num_refills.resize(m_num_queried_attributes, 0ull);
+  m_next_field_ptrs.resize(static_cast<size_t>(num_iterators)*m_num_queried_attributes, 0);
   m_buffers.clear();
+  //Per attribute buffer sizes within the budget, or the same size for all buffers
+  std::vector<size_t> adaptive_buffer_sizes;
+  if(buffer_budget > 0u)
+    get_adaptive_buffer_sizes(adaptive_buffer_sizes, (num_iterators > 1u)
+        ? std::max<size_t>(buffer_budget/num_iterators, MIN_BUFFER_SIZE_PER_SUBARRAY) : buffer_budget, read_stats.get());
+  auto subarray_buffer_size = (num_iterators > 1u) ? std::max<size_t>(buffer_size/num_iterators, MIN_BUFFER_SIZE_PER_SUBARRAY)
+    : buffer_size;
   std::vector<const char*> attribute_names(attribute_ids.size()+1u);  //+1 for the COORDS
-  for(auto i=0ull;i<attribute_ids.size();++i)
+  for(auto r=0u;r<num_iterators;++r)
   {
-    //Buffer size must be resized to be a multiple of the field size
-    auto curr_buffer_size = buffer_size;
-    attribute_names[i] = variant_array_schema.attribute_name(attribute_ids[i]).c_str();
-    //For varible length attributes, need extra buffer for maintaining offsets
-    if(variant_array_schema.is_variable_length_field(attribute_ids[i]))
+    auto buffer_idx = 0u;
+    for(auto i=0ull;i<attribute_ids.size();++i)
     {
-      curr_buffer_size = GET_ALIGNED_BUFFER_SIZE(buffer_size, sizeof(size_t));
-      m_buffers.emplace_back(curr_buffer_size);
+      attribute_names[i] = variant_array_schema.attribute_name(attribute_ids[i]).c_str();
+      auto is_variable_length_field = variant_array_schema.is_variable_length_field(attribute_ids[i]);
+      //For varible length attributes, need extra buffer for maintaining offsets
+      if(is_variable_length_field)
+      {
+        auto offsets_buffer_size = (buffer_budget > 0u) ? adaptive_buffer_sizes[buffer_idx++] : subarray_buffer_size;
+        m_buffers.emplace_back(GET_ALIGNED_BUFFER_SIZE(offsets_buffer_size, sizeof(size_t)));
+      }
+      auto curr_buffer_size = (buffer_budget > 0u) ? adaptive_buffer_sizes[buffer_idx++] : subarray_buffer_size;
+      //Buffer size must be resized to be a multiple of the field size
+      m_buffers.emplace_back(GET_ALIGNED_BUFFER_SIZE(curr_buffer_size,
+            is_variable_length_field ? sizeof(size_t) : m_cell.get_field_size_in_bytes(i)));
     }
-    else
-      curr_buffer_size = GET_ALIGNED_BUFFER_SIZE(buffer_size, m_cell.get_field_size_in_bytes(i));
-    m_buffers.emplace_back(curr_buffer_size);
+    //Co-ordinates
+    auto coords_buffer_size = (buffer_budget > 0u) ? adaptive_buffer_sizes[buffer_idx++] : subarray_buffer_size;
+    attribute_names[attribute_ids.size()] = TILEDB_COORDS;
+    m_buffers.emplace_back(GET_ALIGNED_BUFFER_SIZE(coords_buffer_size, variant_array_schema.dim_size_in_bytes()));
   }
-  //Co-ordinates
-  attribute_names[attribute_ids.size()] = TILEDB_COORDS;
-  m_buffers.emplace_back(GET_ALIGNED_BUFFER_SIZE(buffer_size, variant_array_schema.dim_size_in_bytes()));
+  m_num_buffers_per_iterator = num_iterators ? m_buffers.size()/num_iterators : 0u;
   //Initialize pointers to buffers
   m_buffer_pointers.resize(m_buffers.size());
   m_buffer_sizes.resize(m_buffers.size());
@@ -77,17 +174,47 @@ VariantArrayCellIterator::VariantArrayCellIterator(TileDB_CTX* tiledb_ctx, const
     m_buffer_pointers[i] = reinterpret_cast<void*>(&(m_buffers[i][0]));
     m_buffer_sizes[i] = m_buffers[i].size();
   }
-  /* Initialize the array in READ mode. */
-  auto status = tiledb_array_iterator_init(
-      tiledb_ctx, 
-      &m_tiledb_array_iterator,
-      array_path.c_str(),
-      reinterpret_cast<const void*>(range), // range, 
-      &(attribute_names[0]),           
-      attribute_names.size(),
-      const_cast<void**>(&(m_buffer_pointers[0])),
-      &(m_buffer_sizes[0]));      
-  VERIFY_OR_THROW(status == TILEDB_OK && "Error while initializing TileDB iterator");
+  m_tiledb_array_iterators.resize(num_iterators, 0);
+  //Initializing an iterator reads the first tiles of its subarray - with multiple arrays (column partitions),
+  //the partitions are read in parallel
+  std::vector<int> init_status(num_iterators, TILEDB_OK);
+#pragma omp parallel for default(shared) schedule(dynamic, 1) if(multiple_arrays)
+  for(auto r=0u;r<num_iterators;++r)
+  {
+    auto buffer_offset = r*m_num_buffers_per_iterator;
+    /* Initialize the array in READ mode. */
+    init_status[r] = tiledb_array_iterator_init(
+        tiledb_ctx,
+        &(m_tiledb_array_iterators[r]),
+        iterator_array_paths[r].c_str(),
+        reinterpret_cast<const void*>(ranges+4u*r), // range,
+        &(attribute_names[0]),
+        attribute_names.size(),
+        const_cast<void**>(&(m_buffer_pointers[buffer_offset])),
+        &(m_buffer_sizes[buffer_offset]));
+  }
+  for(auto r=0u;r<num_iterators;++r)
+    if(init_status[r] != TILEDB_OK)
+      throw VariantStorageManagerException(std::string("Error while initializing TileDB iterator for array ")
+          +iterator_array_paths[r]);
+  if(m_read_stats)
+  {
+    auto num_buffer_bytes = 0ull;
+    for(const auto& buffer : m_buffers)
+      num_buffer_bytes += buffer.size();
+    m_read_stats->add_iterator(num_buffer_bytes);
+  }
+#ifdef DO_PROFILING
+  for(auto r=0u;r<num_iterators;++r)
+    count_refills(r);
+#endif
+  //Merge cells from multiple subarrays and arrays
+  if(num_iterators != 1u)
+  {
+    m_iterators_coords.resize(num_iterators);
+    for(auto r=0u;r<num_iterators;++r)
+      push_into_iterators_pq(r);
+  }
 #ifdef DEBUG
   m_last_row = -1;
   m_last_column = -1;
@@ -98,23 +225,203 @@ VariantArrayCellIterator::VariantArrayCellIterator(TileDB_CTX* tiledb_ctx, const
 #endif
 }
 
+VariantArrayCellIterator::VariantArrayCellIterator(const VariantArraySchema& variant_array_schema,
+    const std::vector<int>& attribute_ids, std::vector<std::unique_ptr<VariantArrayCellIterator>>&& array_iterators,
+    const unsigned prefetch_depth, const size_t batch_size)
+  : m_num_queried_attributes(attribute_ids.size()), m_tiledb_ctx(0),
+  m_variant_array_schema(&variant_array_schema), m_cell(variant_array_schema, attribute_ids),
+  m_array_iterators(std::move(array_iterators)),
+  m_iterators_pq(TileDBIteratorColumnMajorCompare(&m_iterators_coords)),
+  m_attribute_ids(attribute_ids)
+#ifdef DO_PROFILING
+  , m_tiledb_timer()
+  , m_tiledb_to_buffer_cell_timer()
+#endif
+{
+  m_prefetch_depth = 0u;
+  m_prefetch_batch_size = 0u;
+  m_prefetch_head_idx = 0u;
+  m_num_prefetched_batches = 0u;
+  m_prefetch_done = false;
+  m_stop_prefetch = false;
+  m_num_cells_read = 0ull;
+  m_num_buffers_per_iterator = 0u;
+  m_num_bytes_read.resize(m_num_queried_attributes, 0ull);
+  m_num_refills.resize(m_num_queried_attributes, 0ull);
+  m_array_batch_size = std::max<size_t>(batch_size, 1u);
+  //END values are not needed in the batches of the arrays, cells are copied from them
+  for(auto& array_iterator : m_array_iterators)
+    array_iterator->start_prefetch(std::max(prefetch_depth, 1u), m_array_batch_size, -1);
+  m_array_batches.resize(m_array_iterators.size());
+  for(auto& batch : m_array_batches)
+    batch.initialize(m_num_queried_attributes, -1);
+  //Empty batches - the first push reads the first batch of every array
+  m_array_batch_cell_idxs.resize(m_array_iterators.size(), 0u);
+  m_iterators_coords.resize(m_array_iterators.size());
+  for(auto i=0u;i<m_array_iterators.size();++i)
+    push_array_iterator_into_pq(i);
+#ifdef DEBUG
+  m_last_row = -1;
+  m_last_column = -1;
+  m_num_cells_iterated_over = 0ull;
+#endif
+}
+
+void VariantArrayCellIterator::get_adaptive_buffer_sizes(std::vector<size_t>& buffer_sizes, const size_t buffer_budget,
+    const VariantArrayReadStats* read_stats) const
+{
+  //#bytes per cell of every buffer, in the order in which buffers are passed to TileDB
+  std::vector<double> cell_sizes;
+  for(auto i=0u;i<m_num_queried_attributes;++i)
+  {
+    auto schema_idx = m_attribute_ids[i];
+    if(m_variant_array_schema->is_variable_length_field(schema_idx))
+    {
+      cell_sizes.push_back(sizeof(size_t)); //offsets
+      auto average_cell_size = read_stats ? read_stats->get_average_cell_size(schema_idx) : 0.0;
+      cell_sizes.push_back((average_cell_size > 0.0) ? average_cell_size
+          : static_cast<double>(m_variant_array_schema->element_size(schema_idx)*DEFAULT_NUM_ELEMENTS_IN_VARIABLE_LENGTH_CELL));
+    }
+    else
+      cell_sizes.push_back(m_cell.get_field_size_in_bytes(i));
+  }
+  cell_sizes.push_back(m_variant_array_schema->dim_size_in_bytes());
+  auto total_cell_size = 0.0;
+  for(auto val : cell_sizes)
+    total_cell_size += val;
+  //Every buffer holds the same #cells
+  auto num_cells_per_fill = static_cast<double>(buffer_budget)/total_cell_size;
+  buffer_sizes.resize(cell_sizes.size());
+  for(auto i=0u;i<cell_sizes.size();++i)
+    buffer_sizes[i] = std::max<size_t>(static_cast<size_t>(cell_sizes[i]*num_cells_per_fill), MIN_ADAPTIVE_BUFFER_SIZE);
+}
+
+void VariantArrayReadStats::print(const std::string& array_name, const VariantArraySchema& schema,
+    std::ostream& fptr) const
+{
+#pragma omp critical(variant_array_read_stats)
+  {
+    if(m_num_iterators > 0ull)
+    {
+      fptr << "Read stats of array "<<array_name<<": #iterators "<<m_num_iterators
+        <<" average read buffer bytes per iterator "<<m_num_buffer_bytes/m_num_iterators<<"\n";
+      for(auto i=0u;i<m_num_cells.size();++i)
+        if(m_num_cells[i] > 0ull)
+          fptr << schema.attribute_name(i) << " #cells "<<m_num_cells[i]<<" bytes read "<<m_num_bytes[i]
+            << " #refills "<<m_num_refills[i]<<"\n";
+    }
+  }
+}
+
+void VariantArrayCellIterator::count_refills(const unsigned iterator_idx)
+{
+  auto tiledb_array_iterator = m_tiledb_array_iterators[iterator_idx];
+  if(tiledb_array_iterator_end(tiledb_array_iterator))
+    return;
+  const uint8_t* field_ptr = 0;
+  size_t field_size = 0u;
+  for(auto i=0u;i<m_num_queried_attributes;++i)
+  {
+    auto status = tiledb_array_iterator_get_value(tiledb_array_iterator, i,
+        reinterpret_cast<const void**>(&field_ptr), &field_size);
+    VERIFY_OR_THROW(status == TILEDB_OK);
+    auto& next_field_ptr = m_next_field_ptrs[iterator_idx*m_num_queried_attributes+i];
+    //The first cell of the iterator is in the initial fill
+    if(next_field_ptr && field_ptr != next_field_ptr)
+      ++(m_num_refills[i]);
+    next_field_ptr = field_ptr + field_size;
+  }
+}
+
+void VariantArrayCellIterator::push_into_iterators_pq(const unsigned idx)
+{
+  assert(idx < m_tiledb_array_iterators.size());
+  if(tiledb_array_iterator_end(m_tiledb_array_iterators[idx]))
+    return;
+  const uint8_t* field_ptr = 0;
+  size_t field_size = 0u;
+  auto status = tiledb_array_iterator_get_value(m_tiledb_array_iterators[idx], m_num_queried_attributes,
+      reinterpret_cast<const void**>(&field_ptr), &field_size);
+  VERIFY_OR_THROW(status == TILEDB_OK);
+  auto coords_ptr = reinterpret_cast<const int64_t*>(field_ptr);
+  m_iterators_coords[idx].first = coords_ptr[0];
+  m_iterators_coords[idx].second = coords_ptr[1];
+  m_iterators_pq.push(idx);
+}
+
+void VariantArrayCellIterator::advance_merged_iterators()
+{
+  assert(!m_iterators_pq.empty());
+  auto idx = m_iterators_pq.top();
+  m_iterators_pq.pop();
+  auto status = tiledb_array_iterator_next(m_tiledb_array_iterators[idx]);
+  if(status != TILEDB_OK)
+    throw VariantStorageManagerException("VariantArrayCellIterator increment failed");
+#ifdef DO_PROFILING
+  count_refills(idx);
+#endif
+  push_into_iterators_pq(idx);
+}
+
+void VariantArrayCellIterator::push_array_iterator_into_pq(const unsigned idx)
+{
+  assert(idx < m_array_iterators.size());
+  auto& batch = m_array_batches[idx];
+  auto& cell_idx = m_array_batch_cell_idxs[idx];
+  if(cell_idx >= batch.size())
+  {
+    //Blocks till the reader thread of the array has a batch ready - 0 cells at the end of the array
+    m_array_iterators[idx]->fill_batch(batch);
+    cell_idx = 0u;
+    if(batch.size() == 0u)
+      return;
+  }
+  m_iterators_coords[idx].first = batch.get_rows()[cell_idx];
+  m_iterators_coords[idx].second = batch.get_columns()[cell_idx];
+  m_iterators_pq.push(idx);
+}
+
+void VariantArrayCellIterator::advance_array_iterators()
+{
+  assert(!m_iterators_pq.empty());
+  auto idx = m_iterators_pq.top();
+  m_iterators_pq.pop();
+  ++(m_array_batch_cell_idxs[idx]);
+  push_array_iterator_into_pq(idx);
+}
+
 const BufferVariantCell& VariantArrayCellIterator::operator*()
 {
 #ifdef DO_PROFILING
   m_tiledb_to_buffer_cell_timer.start();
 #endif
+  //Cell in the current batch of an array iterator - no copies
+  if(!m_array_iterators.empty())
+  {
+    auto array_idx = m_iterators_pq.top();
+    m_array_batches[array_idx].set_cell(m_cell, m_array_batch_cell_idxs[array_idx]);
+    ++m_num_cells_read;
+#ifdef DO_PROFILING
+    m_tiledb_to_buffer_cell_timer.stop();
+#endif
+    return m_cell;
+  }
   const uint8_t* field_ptr = 0;
   size_t field_size = 0u;
+  auto iterator_idx = get_curr_iterator_idx();
+  auto tiledb_array_iterator = m_tiledb_array_iterators[iterator_idx];
+  ++m_num_cells_read;
   for(auto i=0u;i<m_num_queried_attributes;++i)
   {
-    auto status = tiledb_array_iterator_get_value(m_tiledb_array_iterator, i,
+    auto status = tiledb_array_iterator_get_value(tiledb_array_iterator, i,
         reinterpret_cast<const void**>(&field_ptr), &field_size);
     VERIFY_OR_THROW(status == TILEDB_OK);
+    m_num_bytes_read[i] += field_size;
     m_cell.set_field_ptr_for_query_idx(i, field_ptr);
     m_cell.set_field_size_in_bytes(i, field_size);
   }
   //Co-ordinates
-  auto status = tiledb_array_iterator_get_value(m_tiledb_array_iterator, m_num_queried_attributes,
+  auto status = tiledb_array_iterator_get_value(tiledb_array_iterator, m_num_queried_attributes,
         reinterpret_cast<const void**>(&field_ptr), &field_size);
   VERIFY_OR_THROW(status == TILEDB_OK);
   assert(field_size == m_variant_array_schema->dim_size_in_bytes());
@@ -126,13 +433,363 @@ const BufferVariantCell& VariantArrayCellIterator::operator*()
   return m_cell;
 }
 
+size_t VariantArrayCellIterator::fill_batch(VariantCellBatch& batch)
+{
+  VERIFY_OR_THROW(m_prefetch_depth > 0u && "fill_batch() can be called only after start_prefetch()");
+  assert(batch.get_num_queried_attributes() == m_num_queried_attributes);
+  std::unique_lock<std::mutex> lock(m_prefetch_mutex);
+  while(m_num_prefetched_batches == 0u && !m_prefetch_done)
+    m_prefetch_cv.wait(lock);
+  if(m_num_prefetched_batches == 0u)
+  {
+    if(m_prefetch_exception)
+      std::rethrow_exception(m_prefetch_exception);
+    batch.clear();
+    return 0u;
+  }
+  //Hand the batch over to the consumer - the consumer's old batch becomes the free slot
+  std::swap(batch, m_prefetch_batches[m_prefetch_head_idx]);
+  m_prefetch_head_idx = (m_prefetch_head_idx+1u)%m_prefetch_depth;
+  --m_num_prefetched_batches;
+  m_prefetch_cv.notify_all();
+  return batch.size();
+}
+
+void VariantArrayCellIterator::start_prefetch(const unsigned prefetch_depth, const size_t batch_size, const int END_query_idx)
+{
+  assert(m_prefetch_depth == 0u);
+  if(prefetch_depth == 0u || batch_size == 0u || !m_array_iterators.empty())
+    return;
+  m_prefetch_batch_size = batch_size;
+  m_prefetch_batches.resize(prefetch_depth);
+  for(auto& batch : m_prefetch_batches)
+    batch.initialize(m_num_queried_attributes, END_query_idx);
+  m_prefetch_head_idx = 0u;
+  m_num_prefetched_batches = 0u;
+  m_prefetch_done = false;
+  m_stop_prefetch = false;
+  m_prefetch_depth = prefetch_depth;
+  m_prefetch_thread = std::thread(&VariantArrayCellIterator::prefetch, this);
+}
+
+void VariantArrayCellIterator::prefetch()
+{
+  try
+  {
+    while(true)
+    {
+      unsigned slot_idx = 0u;
+      {
+        std::unique_lock<std::mutex> lock(m_prefetch_mutex);
+        while(m_num_prefetched_batches == m_prefetch_depth && !m_stop_prefetch)
+          m_prefetch_cv.wait(lock);
+        if(m_stop_prefetch)
+          break;
+        slot_idx = (m_prefetch_head_idx+m_num_prefetched_batches)%m_prefetch_depth;
+      }
+      //The consumer never touches free slots - no lock needed while reading from TileDB
+      auto num_cells = fill_batch_from_array(m_prefetch_batches[slot_idx], m_prefetch_batch_size);
+      std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+      if(num_cells > 0u)
+        ++m_num_prefetched_batches;
+      m_prefetch_done = end_of_array_iterators();
+      m_prefetch_cv.notify_all();
+      if(m_prefetch_done)
+        break;
+    }
+  }
+  catch(...)
+  {
+    std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+    m_prefetch_exception = std::current_exception();
+    m_prefetch_done = true;
+    m_prefetch_cv.notify_all();
+  }
+}
+
+bool VariantArrayCellIterator::prefetch_end() const
+{
+  std::unique_lock<std::mutex> lock(m_prefetch_mutex);
+  while(m_num_prefetched_batches == 0u && !m_prefetch_done)
+    m_prefetch_cv.wait(lock);
+  if(m_num_prefetched_batches == 0u && m_prefetch_exception)
+    std::rethrow_exception(m_prefetch_exception);
+  return (m_num_prefetched_batches == 0u);
+}
+
+void VariantArrayCellIterator::stop_prefetch()
+{
+  if(!m_prefetch_thread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+    m_stop_prefetch = true;
+    m_prefetch_cv.notify_all();
+  }
+  m_prefetch_thread.join();
+}
+
+size_t VariantArrayCellIterator::fill_batch_from_array(VariantCellBatch& batch, const size_t max_num_cells)
+{
+  assert(batch.get_num_queried_attributes() == m_num_queried_attributes && m_array_iterators.empty());
+  batch.clear();
+  const uint8_t* field_ptr = 0;
+  size_t field_size = 0u;
+  while(!end_of_array_iterators() && batch.size() < max_num_cells)
+  {
+#ifdef DO_PROFILING
+    m_tiledb_to_buffer_cell_timer.start();
+#endif
+    auto iterator_idx = get_curr_iterator_idx();
+    //TileDB only exposes a pointer per cell into buffers that the next increment may refill - cells are
+    //copied one at a time
+    ++m_num_cells_read;
+    auto tiledb_array_iterator = m_tiledb_array_iterators[iterator_idx];
+    //Co-ordinates
+    auto status = tiledb_array_iterator_get_value(tiledb_array_iterator, m_num_queried_attributes,
+        reinterpret_cast<const void**>(&field_ptr), &field_size);
+    VERIFY_OR_THROW(status == TILEDB_OK);
+    assert(field_size == m_variant_array_schema->dim_size_in_bytes());
+    auto coords_ptr = reinterpret_cast<const int64_t*>(field_ptr);
+    batch.add_coordinates(coords_ptr[0], coords_ptr[1]);
+    for(auto i=0u;i<m_num_queried_attributes;++i)
+    {
+      status = tiledb_array_iterator_get_value(tiledb_array_iterator, i,
+          reinterpret_cast<const void**>(&field_ptr), &field_size);
+      VERIFY_OR_THROW(status == TILEDB_OK);
+      m_num_bytes_read[i] += field_size;
+      batch.add_field(i, field_ptr, field_size);
+    }
+#ifdef DO_PROFILING
+    m_tiledb_to_buffer_cell_timer.stop();
+#endif
+    operator++();
+  }
+  return batch.size();
+}
+
+//Sets (or adds) the given members in the JSON metadata file, other members in the file are retained
+static void write_members_to_metadata(const std::string& metadata_filename,
+    const std::vector<std::pair<std::string, int64_t>>& members)
+{
+  rapidjson::Document json_doc;
+  std::ifstream ifs(metadata_filename.c_str());
+  if(ifs.is_open())
+  {
+    std::string str((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    json_doc.Parse(str.c_str());
+    if(json_doc.HasParseError())
+      throw VariantStorageManagerException(std::string("Syntax error in corrupted JSON metadata file ")+metadata_filename);
+    ifs.close();
+  }
+  if(!json_doc.IsObject())
+    json_doc.SetObject();
+  for(const auto& curr_member : members)
+  {
+    if(json_doc.HasMember(curr_member.first.c_str()))
+      json_doc[curr_member.first.c_str()].SetInt64(curr_member.second);
+    else
+    {
+      rapidjson::Value name(curr_member.first.c_str(), json_doc.GetAllocator());
+      rapidjson::Value value(curr_member.second);
+      json_doc.AddMember(name, value, json_doc.GetAllocator());
+    }
+  }
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  json_doc.Accept(writer);
+  auto* fptr = fopen(metadata_filename.c_str(), "w");
+  VERIFY_OR_THROW(fptr);
+  fwrite(reinterpret_cast<const void*>(buffer.GetString()), 1u, strlen(buffer.GetString()), fptr);
+  fclose(fptr);
+}
+
+//VariantArrayTileIndex functions
+void VariantArrayTileIndex::clear()
+{
+  m_is_valid = false;
+  m_num_fragments = 0ull;
+  m_num_cells_per_tile = 0ull;
+  m_num_cells_in_last_tile = 0ull;
+  m_tiles.clear();
+  m_prefix_max_column_end.clear();
+  m_prefix_max_END.clear();
+}
+
+void VariantArrayTileIndex::create_empty_index_file(const std::string& filename, const uint64_t num_cells_per_tile)
+{
+  VariantArrayTileIndex tile_index;
+  tile_index.m_is_valid = true;
+  tile_index.m_num_cells_per_tile = std::max<uint64_t>(1ull, num_cells_per_tile);
+  tile_index.write_to_file(filename);
+}
+
+bool VariantArrayTileIndex::read_from_file(const std::string& filename, const int num_fragments)
+{
+  clear();
+  auto* fptr = fopen(filename.c_str(), "rb");
+  if(fptr == 0)
+    return false;
+  char magic[TILE_INDEX_FILE_MAGIC_LENGTH];
+  uint64_t num_tiles = 0ull;
+  auto success = (fread(magic, 1u, TILE_INDEX_FILE_MAGIC_LENGTH, fptr) == TILE_INDEX_FILE_MAGIC_LENGTH);
+  if(success && memcmp(magic, TILE_INDEX_FILE_MAGIC_V1, TILE_INDEX_FILE_MAGIC_LENGTH) == 0)
+  {
+    fclose(fptr);
+    return false;
+  }
+  success = success
+    && (memcmp(magic, TILE_INDEX_FILE_MAGIC, TILE_INDEX_FILE_MAGIC_LENGTH) == 0)
+    && (fread(&m_num_fragments, sizeof(uint64_t), 1u, fptr) == 1u)
+    && (fread(&m_num_cells_per_tile, sizeof(uint64_t), 1u, fptr) == 1u)
+    && (fread(&num_tiles, sizeof(uint64_t), 1u, fptr) == 1u);
+  //Fragments were added or removed without updating the index - tiles may be missing
+  if(success && num_fragments >= 0 && m_num_fragments != static_cast<uint64_t>(num_fragments))
+  {
+    fclose(fptr);
+    clear();
+    return false;
+  }
+  if(success)
+  {
+    m_tiles.resize(num_tiles);
+    success = (num_tiles == 0ull || fread(&(m_tiles[0]), sizeof(TileInfo), num_tiles, fptr) == num_tiles);
+  }
+  fclose(fptr);
+  if(!success)
+    throw VariantStorageManagerException(std::string("Corrupted tile index file ")+filename);
+  m_is_valid = true;
+  //Loads append new tiles - the last tile of the previous load is never extended
+  m_num_cells_in_last_tile = m_num_cells_per_tile;
+  build_search_structures();
+  return true;
+}
+
+void VariantArrayTileIndex::write_to_file(const std::string& filename) const
+{
+  assert(m_is_valid);
+  auto* fptr = fopen(filename.c_str(), "wb");
+  if(fptr == 0)
+    throw VariantStorageManagerException(std::string("Could not open tile index file ")+filename+" for writing");
+  uint64_t num_tiles = m_tiles.size();
+  auto success = (fwrite(TILE_INDEX_FILE_MAGIC, 1u, TILE_INDEX_FILE_MAGIC_LENGTH, fptr) == TILE_INDEX_FILE_MAGIC_LENGTH)
+    && (fwrite(&m_num_fragments, sizeof(uint64_t), 1u, fptr) == 1u)
+    && (fwrite(&m_num_cells_per_tile, sizeof(uint64_t), 1u, fptr) == 1u)
+    && (fwrite(&num_tiles, sizeof(uint64_t), 1u, fptr) == 1u)
+    && (num_tiles == 0ull || fwrite(&(m_tiles[0]), sizeof(TileInfo), num_tiles, fptr) == num_tiles);
+  fclose(fptr);
+  if(!success)
+    throw VariantStorageManagerException(std::string("Error while writing tile index file ")+filename);
+}
+
+void VariantArrayTileIndex::add_cell(const int64_t row, const int64_t column, const int64_t END)
+{
+  assert(m_is_valid);
+  //For cell copies at END positions, END < column
+  auto max_END = std::max(column, END);
+  if(m_tiles.empty() || m_num_cells_in_last_tile >= m_num_cells_per_tile)
+  {
+    m_tiles.push_back(TileInfo({ column, column, row, row, max_END }));
+    m_num_cells_in_last_tile = 0ull;
+  }
+  else
+  {
+    //Cells are written in column major order
+    auto& last_tile = m_tiles.back();
+    last_tile.m_column_end = column;
+    last_tile.m_row_begin = std::min(last_tile.m_row_begin, row);
+    last_tile.m_row_end = std::max(last_tile.m_row_end, row);
+    last_tile.m_max_END = std::max(last_tile.m_max_END, max_END);
+  }
+  ++m_num_cells_in_last_tile;
+  //Search structures are rebuilt when the index is read back
+  m_prefix_max_column_end.clear();
+  m_prefix_max_END.clear();
+}
+
+void VariantArrayTileIndex::build_search_structures()
+{
+  //Tiles from different loads (fragments) may overlap
+  std::sort(m_tiles.begin(), m_tiles.end(), TileColumnBeginCompare());
+  m_prefix_max_column_end.resize(m_tiles.size());
+  m_prefix_max_END.resize(m_tiles.size());
+  for(auto i=0ull;i<m_tiles.size();++i)
+  {
+    m_prefix_max_column_end[i] = (i == 0ull) ? m_tiles[i].m_column_end : std::max(m_prefix_max_column_end[i-1u], m_tiles[i].m_column_end);
+    m_prefix_max_END[i] = (i == 0ull) ? m_tiles[i].m_max_END : std::max(m_prefix_max_END[i-1u], m_tiles[i].m_max_END);
+  }
+}
+
+//Idx of the first tile with column begin > column
+#define GET_FIRST_TILE_IDX_BEGINNING_AFTER(tiles, column) \
+  (std::upper_bound((tiles).begin(), (tiles).end(), (column), TileColumnBeginCompare()) - (tiles).begin())
+
+int64_t VariantArrayTileIndex::get_first_column_at_or_after(const int64_t column, const int64_t row_begin,
+    const int64_t row_end) const
+{
+  assert(m_prefix_max_column_end.size() == m_tiles.size());
+  size_t tile_idx = GET_FIRST_TILE_IDX_BEGINNING_AFTER(m_tiles, column);
+  //Tiles beginning at or before column which extend to column - the prefix max bounds the backward walk
+  for(auto i=tile_idx;i>0u && m_prefix_max_column_end[i-1u] >= column;--i)
+  {
+    const auto& tile = m_tiles[i-1u];
+    if(tile.m_column_end >= column && tile.m_row_begin <= row_end && tile.m_row_end >= row_begin)
+      return column;
+  }
+  for(auto i=tile_idx;i<m_tiles.size();++i)
+  {
+    const auto& tile = m_tiles[i];
+    if(tile.m_row_begin <= row_end && tile.m_row_end >= row_begin)
+      return tile.m_column_begin;
+  }
+  return INT64_MAX;
+}
+
+int64_t VariantArrayTileIndex::get_max_END_of_cells_beginning_at_or_before(const int64_t column) const
+{
+  assert(m_prefix_max_END.size() == m_tiles.size());
+  size_t tile_idx = GET_FIRST_TILE_IDX_BEGINNING_AFTER(m_tiles, column);
+  return (tile_idx == 0u) ? -1ll : m_prefix_max_END[tile_idx-1u];
+}
+
+void VariantArrayTileIndex::add_cell_estimates_to_histogram(Histogram& histogram, const int64_t column_begin,
+    const int64_t column_end, const int64_t row_begin, const int64_t row_end, const uint64_t histogram_offset) const
+{
+  assert(m_prefix_max_column_end.size() == m_tiles.size());
+  auto num_cells_per_tile = static_cast<int64_t>(m_num_cells_per_tile);
+  //Tiles beginning before column_begin which do not extend to column_begin can be skipped
+  auto first_tile_idx = std::lower_bound(m_prefix_max_column_end.begin(), m_prefix_max_column_end.end(), column_begin)
+    - m_prefix_max_column_end.begin();
+  size_t end_tile_idx = GET_FIRST_TILE_IDX_BEGINNING_AFTER(m_tiles, column_end);
+  for(auto i=static_cast<size_t>(first_tile_idx);i<end_tile_idx;++i)
+  {
+    const auto& tile = m_tiles[i];
+    if(tile.m_column_end < column_begin || tile.m_row_begin > row_end || tile.m_row_end < row_begin)
+      continue;
+    //k-th cell of the tile is assumed to begin at m_column_begin + (k*tile_width)/num_cells_per_tile - only the
+    //cells within [column_begin, column_end] are visited
+    auto tile_width = tile.m_column_end - tile.m_column_begin + 1;
+    auto k_begin = (tile.m_column_begin >= column_begin) ? 0ll
+      : ((column_begin - tile.m_column_begin)*num_cells_per_tile + tile_width - 1)/tile_width;
+    auto k_end = (tile.m_column_end <= column_end) ? num_cells_per_tile
+      : ((column_end - tile.m_column_begin + 1)*num_cells_per_tile + tile_width - 1)/tile_width;
+    for(auto k=k_begin;k<k_end;++k)
+    {
+      auto column = tile.m_column_begin + (k*tile_width)/num_cells_per_tile;
+      histogram.add_value(histogram_offset + (column - column_begin));
+    }
+  }
+}
+
 //VariantArrayInfo functions
 VariantArrayInfo::VariantArrayInfo(int idx, int mode, const std::string& name,
     const VariantArraySchema& schema, TileDB_Array* tiledb_array, const std::string& metadata_filename,
-    const size_t buffer_size)
+    const std::string& tile_index_filename, const int num_fragments, const size_t buffer_size)
 : m_idx(idx), m_mode(mode), m_name(name), m_schema(schema), m_cell(m_schema), m_tiledb_array(tiledb_array),
-  m_metadata_filename(metadata_filename)
+  m_metadata_filename(metadata_filename), m_tile_index_filename(tile_index_filename)
 {
+  m_buffer_size = buffer_size;
+  m_max_buffer_offset = 0u;
   //If writing, allocate buffers
   if(mode == TILEDB_ARRAY_WRITE || mode == TILEDB_ARRAY_WRITE_UNSORTED)
   {
@@ -155,7 +812,24 @@ VariantArrayInfo::VariantArrayInfo(int idx, int mode, const std::string& name,
       m_buffer_offsets[i] = 0ull; //will be modified during a write
     }
   }
+  m_END_schema_idx = -1;
+  for(auto i=0ull;i<schema.attribute_num();++i)
+    if(schema.attribute_name(i) == "END")
+    {
+      m_END_schema_idx = i;
+      break;
+    }
+  m_max_interval_length_modified = false;
   read_row_bounds_from_metadata();
+  //Tile index exists only if all the cells in the array are indexed
+  m_tile_index.read_from_file(m_tile_index_filename, num_fragments);
+  //Every write adds one fragment
+  if(m_tile_index.is_valid() && (mode == TILEDB_ARRAY_WRITE || mode == TILEDB_ARRAY_WRITE_UNSORTED))
+    m_tile_index.set_num_fragments(num_fragments+1);
+  m_tile_index_modified = false;
+  m_read_stats = std::make_shared<VariantArrayReadStats>(schema.attribute_num());
+  m_column_partition = ColumnRange(0, INT64_MAX);
+  m_row_partition = RowRange(0, INT64_MAX);
 #ifdef DEBUG
   m_last_row = m_last_column = -1;
 #endif
@@ -180,8 +854,21 @@ VariantArrayInfo::VariantArrayInfo(VariantArrayInfo&& other)
   m_buffer_pointers = std::move(other.m_buffer_pointers);
   for(auto i=0ull;i<m_buffer_pointers.size();++i)
     m_buffer_pointers[i] = reinterpret_cast<void*>(&(m_buffers[i][0]));
+  m_buffer_size = other.m_buffer_size;
+  m_max_buffer_offset = other.m_max_buffer_offset;
   m_metadata_contains_max_valid_row_idx_in_array = other.m_metadata_contains_max_valid_row_idx_in_array;
   m_max_valid_row_idx_in_array = other.m_max_valid_row_idx_in_array;
+  m_END_schema_idx = other.m_END_schema_idx;
+  m_max_interval_length = other.m_max_interval_length;
+  m_metadata_contains_max_interval_length = other.m_metadata_contains_max_interval_length;
+  m_max_interval_length_modified = other.m_max_interval_length_modified;
+  m_tile_index_filename = std::move(other.m_tile_index_filename);
+  m_tile_index = std::move(other.m_tile_index);
+  m_tile_index_modified = other.m_tile_index_modified;
+  m_read_stats = std::move(other.m_read_stats);
+  m_async_writer = std::move(other.m_async_writer);
+  m_column_partition = other.m_column_partition;
+  m_row_partition = other.m_row_partition;
 #ifdef DEBUG
   m_last_row = other.m_last_row;
   m_last_column = other.m_last_column;
@@ -190,77 +877,237 @@ VariantArrayInfo::VariantArrayInfo(VariantArrayInfo&& other)
 
 void VariantArrayInfo::write_cell(const void* ptr)
 {
-  m_cell.set_cell(ptr);
+  //Serialized cell - co-ordinates, cell size, then every attribute in schema order, variable length fields
+  //prefixed by #elements (see BufferVariantCell::set_cell()). The fields are copied straight into the write buffers
+  auto cell_ptr = reinterpret_cast<const uint8_t*>(ptr);
+  auto row = *(reinterpret_cast<const int64_t*>(cell_ptr));
+  auto column = *(reinterpret_cast<const int64_t*>(cell_ptr+sizeof(int64_t)));
+  auto cell_size = *(reinterpret_cast<const size_t*>(cell_ptr+2*sizeof(int64_t)));
 #ifdef DEBUG
-  assert((m_cell.get_begin_column() > m_last_column) || (m_cell.get_begin_column() == m_last_column && m_cell.get_row() > m_last_row));
-  m_last_row = m_cell.get_row();
-  m_last_column = m_cell.get_begin_column();
+  assert((column > m_last_column) || (column == m_last_column && row > m_last_row));
+  m_last_row = row;
+  m_last_column = column;
 #endif
-  auto buffer_idx = 0ull;
-  auto overflow = false;
-  //First check if the current cell will fit into the buffers
-  for(auto i=0ull;i<m_schema.attribute_num();++i)
+  //No buffer grows by more than cell_size bytes - the field values, the offset of a variable length field and
+  //the co-ordinates are all part of the serialized cell. Flush once the fullest buffer cannot take the cell
+  if(m_max_buffer_offset+cell_size > m_buffer_size)
   {
-    assert(buffer_idx < m_buffer_pointers.size());
-    //Specify offsets in the buffer for variable length fields
-    if(m_schema.is_variable_length_field(i))
-    {
-      if(m_buffer_offsets[buffer_idx]+sizeof(size_t) > m_buffers[buffer_idx].size())
-      {
-        overflow = true;
-        break;
-      }
-      ++buffer_idx;
-    }
-    if(m_buffer_offsets[buffer_idx]+m_cell.get_field_size_in_bytes(i) > m_buffers[buffer_idx].size())
-    {
-      overflow = true;
-      break;
-    }
-    ++buffer_idx;
-  }
-  //Check if co-ordinates buffer overflows
-  auto coords_buffer_idx = m_buffers.size()-1u;
-  auto coords_size = m_schema.dim_size_in_bytes();
-  overflow = overflow || (m_buffer_offsets[coords_buffer_idx]+coords_size > m_buffers[coords_buffer_idx].size());
-  //write to array and reset sizes
-  if(overflow)
-  {
-    auto status = tiledb_array_write(m_tiledb_array, const_cast<const void**>(&(m_buffer_pointers[0])), &(m_buffer_offsets[0]));
-    VERIFY_OR_THROW(status == TILEDB_OK);
-    memset(&(m_buffer_offsets[0]), 0, m_buffer_offsets.size()*sizeof(size_t));
+    if(m_max_buffer_offset > 0u)
+      flush_write_buffers();
+    if(cell_size > m_buffer_size)
+      throw VariantStorageManagerException(std::string("Cell of size ")+std::to_string(cell_size)
+          +" bytes does not fit into the write buffers of array "+m_name+" (segment size "
+          +std::to_string(m_buffer_size)+" bytes)");
   }
-  buffer_idx = 0;
-  for(auto i=0ull;i<m_schema.attribute_num();++i)
+  auto END = column;
+  uint64_t offset = 2*sizeof(int64_t)+sizeof(size_t);
+  auto buffer_idx = 0u;
+  for(auto i=0u;i<m_schema.attribute_num();++i)
   {
-    assert(buffer_idx < m_buffer_pointers.size());
-    //Specify offsets in the buffer for variable length fields
+    size_t length = m_schema.val_num(i);
     if(m_schema.is_variable_length_field(i))
     {
-      assert(buffer_idx+1u < m_buffer_offsets.size());
-      assert(m_buffer_offsets[buffer_idx]+sizeof(size_t) <= m_buffers[buffer_idx].size());
+      length = *(reinterpret_cast<const int*>(cell_ptr+offset));
+      offset += sizeof(int);
       //Offset buffer - new entry starts after last entry
       *(reinterpret_cast<size_t*>(&(m_buffers[buffer_idx][m_buffer_offsets[buffer_idx]]))) = m_buffer_offsets[buffer_idx+1u];
       m_buffer_offsets[buffer_idx] += sizeof(size_t);
+      m_max_buffer_offset = std::max(m_max_buffer_offset, m_buffer_offsets[buffer_idx]);
       ++buffer_idx;
     }
-    auto field_size = m_cell.get_field_size_in_bytes(i);
+    auto field_size = length*m_schema.element_size(i);
+    if(static_cast<int>(i) == m_END_schema_idx)
+      END = *(reinterpret_cast<const int64_t*>(cell_ptr+offset));
     assert(m_buffer_offsets[buffer_idx]+field_size <= m_buffers[buffer_idx].size());
-    memcpy(&(m_buffers[buffer_idx][m_buffer_offsets[buffer_idx]]), m_cell.get_field_ptr_for_query_idx<void>(i), field_size);
+    memcpy(&(m_buffers[buffer_idx][m_buffer_offsets[buffer_idx]]), cell_ptr+offset, field_size);
     m_buffer_offsets[buffer_idx] += field_size;
+    m_max_buffer_offset = std::max(m_max_buffer_offset, m_buffer_offsets[buffer_idx]);
+    offset += field_size;
     ++buffer_idx;
   }
+  assert(offset == cell_size);
   //Co-ordinates
+  auto coords_buffer_idx = m_buffers.size()-1u;
+  auto coords_size = m_schema.dim_size_in_bytes();
   assert(buffer_idx == coords_buffer_idx);
-  assert(m_buffer_offsets[coords_buffer_idx]+coords_size <= m_buffers[coords_buffer_idx].size());
   memcpy(&(m_buffers[coords_buffer_idx][m_buffer_offsets[coords_buffer_idx]]), ptr, coords_size);
   m_buffer_offsets[coords_buffer_idx] += coords_size;
+  m_max_buffer_offset = std::max(m_max_buffer_offset, m_buffer_offsets[coords_buffer_idx]);
+  if(m_END_schema_idx < 0)
+    return;
+  //Track max interval length - cell copies at END positions have END < begin and are ignored
+  if(m_metadata_contains_max_interval_length && END - column > m_max_interval_length)
+  {
+    m_max_interval_length = END - column;
+    m_max_interval_length_modified = true;
+  }
+  if(m_tile_index.is_valid())
+  {
+    m_tile_index.add_cell(row, column, END);
+    m_tile_index_modified = true;
+  }
+}
+
+void VariantArrayInfo::close_array()
+{
+  auto is_write_mode = (m_mode == TILEDB_ARRAY_WRITE || m_mode == TILEDB_ARRAY_WRITE_UNSORTED);
+  std::exception_ptr write_exception;
+  //Flush cells in buffer - cells that could not be written are dropped, so that close_array() does not
+  //write them again
+  try
+  {
+    auto coords_buffer_idx = m_buffers.size()-1u;
+    if(is_write_mode && m_buffer_offsets[coords_buffer_idx] > 0ull)
+      flush_write_buffers();
+  }
+  catch(...)
+  {
+    write_exception = std::current_exception();
+    memset(&(m_buffer_offsets[0]), 0, m_buffer_offsets.size()*sizeof(size_t));
+    m_max_buffer_offset = 0u;
+  }
+  //All writes must complete before the array is finalized - the write in flight may fail too
+  if(m_async_writer)
+  {
+    auto async_writer = std::move(m_async_writer);
+    try
+    {
+      async_writer->finish();
+    }
+    catch(...)
+    {
+      if(!write_exception)
+        write_exception = std::current_exception();
+    }
+  }
+  //Record max interval length of the cells written - not if some of the cells are missing
+  if(is_write_mode && m_tiledb_array && !write_exception)
+  {
+    write_max_interval_length_to_metadata();
+    if(m_tile_index.is_valid() && m_tile_index_modified)
+      m_tile_index.write_to_file(m_tile_index_filename);
+  }
+  m_tile_index_modified = false;
+#ifdef DO_PROFILING
+  //Totals over all the iterators of the array
+  if(m_mode == TILEDB_ARRAY_READ && m_read_stats)
+    m_read_stats->print(m_name, m_schema, std::cerr);
+#endif
+  if(m_tiledb_array)
+    tiledb_array_finalize(m_tiledb_array);
+  m_tiledb_array = 0;
+  m_name.clear();
+  m_mode = -1;
+  if(write_exception)
+    std::rethrow_exception(write_exception);
+}
+
+void VariantArrayInfo::flush_write_buffers()
+{
+  if(m_async_writer)
+    m_async_writer->write(m_buffers, m_buffer_pointers, m_buffer_offsets);
+  else
+  {
+    auto status = tiledb_array_write(m_tiledb_array, const_cast<const void**>(&(m_buffer_pointers[0])), &(m_buffer_offsets[0]));
+    if(status != TILEDB_OK)
+      throw VariantStorageManagerException("Error while writing to array "+m_name);
+  }
+  memset(&(m_buffer_offsets[0]), 0, m_buffer_offsets.size()*sizeof(size_t));
+  m_max_buffer_offset = 0u;
+}
+
+void VariantArrayInfo::enable_async_writes()
+{
+  VERIFY_OR_THROW((m_mode == TILEDB_ARRAY_WRITE || m_mode == TILEDB_ARRAY_WRITE_UNSORTED) && m_tiledb_array);
+  if(!m_async_writer)
+    m_async_writer.reset(new VariantArrayAsyncWriter(m_tiledb_array, m_name));
+}
+
+//VariantArrayAsyncWriter functions
+VariantArrayAsyncWriter::VariantArrayAsyncWriter(TileDB_Array* tiledb_array, const std::string& array_name)
+  : m_tiledb_array(tiledb_array), m_array_name(array_name)
+{
+  m_has_pending_write = false;
+  m_stop = false;
+  m_write_failed = false;
+  m_thread = std::thread(&VariantArrayAsyncWriter::write_loop, this);
+}
+
+void VariantArrayAsyncWriter::write(std::vector<std::vector<uint8_t>>& buffers, std::vector<void*>& buffer_pointers,
+    const std::vector<size_t>& buffer_offsets)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  //Back-pressure - the previous set of buffers must be written first
+  while(m_has_pending_write)
+    m_cv.wait(lock);
+  if(m_write_failed)
+    throw VariantStorageManagerException("Error while writing to array "+m_array_name);
+  //Second set of buffers is allocated on the first write
+  if(m_buffers.empty())
+  {
+    m_buffers.resize(buffers.size());
+    m_buffer_pointers.resize(buffers.size());
+    for(auto i=0ull;i<buffers.size();++i)
+    {
+      m_buffers[i].resize(buffers[i].size());
+      m_buffer_pointers[i] = reinterpret_cast<void*>(&(m_buffers[i][0]));
+    }
+  }
+  assert(m_buffers.size() == buffers.size());
+  //Swapping vectors swaps their storage - the pointers remain valid
+  std::swap(m_buffers, buffers);
+  std::swap(m_buffer_pointers, buffer_pointers);
+  m_buffer_sizes = buffer_offsets;
+  m_has_pending_write = true;
+  m_cv.notify_all();
+}
+
+void VariantArrayAsyncWriter::write_loop()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while(true)
+  {
+    while(!m_has_pending_write && !m_stop)
+      m_cv.wait(lock);
+    if(!m_has_pending_write)
+      break;
+    //The consumer does not touch the buffers in flight - compress and write without holding the lock
+    lock.unlock();
+    auto status = tiledb_array_write(m_tiledb_array, const_cast<const void**>(&(m_buffer_pointers[0])), &(m_buffer_sizes[0]));
+    lock.lock();
+    if(status != TILEDB_OK)
+      m_write_failed = true;
+    m_has_pending_write = false;
+    m_cv.notify_all();
+  }
+}
+
+void VariantArrayAsyncWriter::stop_thread()
+{
+  if(!m_thread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+    m_cv.notify_all();
+  }
+  //Pending write is completed before the thread exits
+  m_thread.join();
+}
+
+void VariantArrayAsyncWriter::finish()
+{
+  stop_thread();
+  if(m_write_failed)
+    throw VariantStorageManagerException("Error while writing to array "+m_array_name);
 }
 
 void VariantArrayInfo::read_row_bounds_from_metadata()
 {
   //Compute value from array schema
   m_metadata_contains_max_valid_row_idx_in_array = false;
+  m_max_interval_length = -1ll;
+  m_metadata_contains_max_interval_length = false;
   const auto& dim_domains = m_schema.dim_domains();
   m_max_valid_row_idx_in_array = dim_domains[0].second;
   //Try reading from metadata
@@ -279,6 +1126,13 @@ void VariantArrayInfo::read_row_bounds_from_metadata()
         m_max_valid_row_idx_in_array = json_doc["max_valid_row_idx_in_array"].GetInt64();
         m_metadata_contains_max_valid_row_idx_in_array = true;
       }
+      //Absent for arrays loaded by older versions - the value can never be computed for such arrays
+      //since the lengths of the cells already in the array are not known
+      if(json_doc.HasMember("max_interval_length") && json_doc["max_interval_length"].IsInt64())
+      {
+        m_max_interval_length = json_doc["max_interval_length"].GetInt64();
+        m_metadata_contains_max_interval_length = true;
+      }
     }
   }
 }
@@ -295,17 +1149,17 @@ void VariantArrayInfo::update_row_bounds_in_array(TileDB_CTX* tiledb_ctx, const
       || (max_valid_row_idx_in_array > m_max_valid_row_idx_in_array))
   {
     m_max_valid_row_idx_in_array = max_valid_row_idx_in_array;
-    rapidjson::Document json_doc;
-    json_doc.SetObject();
-    json_doc.AddMember("lb_row_idx", lb_row_idx, json_doc.GetAllocator());
-    json_doc.AddMember("max_valid_row_idx_in_array", max_valid_row_idx_in_array, json_doc.GetAllocator());
-    rapidjson::StringBuffer buffer;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    json_doc.Accept(writer);
-    auto* fptr = fopen(metadata_filename.c_str(), "w");
-    VERIFY_OR_THROW(fptr);
-    fwrite(reinterpret_cast<const void*>(buffer.GetString()), 1u, strlen(buffer.GetString()), fptr);
-    fclose(fptr);
+    write_members_to_metadata(metadata_filename, { { "lb_row_idx", lb_row_idx },
+        { "max_valid_row_idx_in_array", max_valid_row_idx_in_array } });
+  }
+}
+
+void VariantArrayInfo::write_max_interval_length_to_metadata()
+{
+  if(m_metadata_filename.length() && m_metadata_contains_max_interval_length && m_max_interval_length_modified)
+  {
+    write_members_to_metadata(m_metadata_filename, { { "max_interval_length", m_max_interval_length } });
+    m_max_interval_length_modified = false;
   }
 }
 
@@ -388,13 +1242,22 @@ int VariantStorageManager::open_array(const std::string& array_name, const char*
       else
         fclose(fptr);
       m_open_arrays_info_vector.emplace_back(idx, mode_int, array_name, tmp_schema, tiledb_array,
-          GET_METADATA_PATH(m_workspace, array_name), m_segment_size);
+          GET_METADATA_PATH(m_workspace, array_name), GET_TILE_INDEX_PATH(m_workspace, array_name),
+          get_num_fragments(array_name), m_segment_size);
       return idx;
     }
   }
   return -1;
 }
 
+std::vector<int> VariantStorageManager::open_arrays(const std::vector<std::string>& array_names, const char* mode)
+{
+  std::vector<int> ads(array_names.size(), -1);
+  for(auto i=0ull;i<array_names.size();++i)
+    ads[i] = open_array(array_names[i], mode);
+  return ads;
+}
+
 void VariantStorageManager::close_array(const int ad)
 {
   VERIFY_OR_THROW(static_cast<size_t>(ad) < m_open_arrays_info_vector.size() &&
@@ -402,7 +1265,8 @@ void VariantStorageManager::close_array(const int ad)
   m_open_arrays_info_vector[ad].close_array();
 }
 
-int VariantStorageManager::define_array(const VariantArraySchema* variant_array_schema, const size_t num_cells_per_tile)
+int VariantStorageManager::define_array(const VariantArraySchema* variant_array_schema, const size_t num_cells_per_tile,
+    const bool build_tile_index)
 {
   //Attribute attributes
   std::vector<const char*> attribute_names(variant_array_schema->attribute_num());
@@ -473,19 +1337,26 @@ int VariantStorageManager::define_array(const VariantArraySchema* variant_array_
   {
     status = tiledb_array_free_schema(&array_schema);
     if(status == TILEDB_OK)
-      status = define_metadata_schema(variant_array_schema);
+      status = define_metadata_schema(variant_array_schema, true);
+    //No cells in the array yet - every cell written from now on is indexed
+    if(status == TILEDB_OK && build_tile_index)
+      VariantArrayTileIndex::create_empty_index_file(GET_TILE_INDEX_PATH(m_workspace, variant_array_schema->array_name()),
+          num_cells_per_tile);
   }
   return status;
 }
 
 //Define metadata
-int VariantStorageManager::define_metadata_schema(const VariantArraySchema* variant_array_schema)
+int VariantStorageManager::define_metadata_schema(const VariantArraySchema* variant_array_schema, const bool is_new_array)
 {
   auto* fptr = fopen(GET_METADATA_PATH(m_workspace, variant_array_schema->array_name()).c_str(), "w");
   VERIFY_OR_THROW(fptr);
   //Create empty JSON
   rapidjson::Document d;
   d.SetObject();
+  //No cells in the array yet - max interval length is tracked from the first write
+  if(is_new_array)
+    d.AddMember("max_interval_length", static_cast<int64_t>(0), d.GetAllocator());
   rapidjson::StringBuffer buffer;
   rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
   d.Accept(writer);
@@ -504,6 +1375,105 @@ int VariantStorageManager::get_array_schema(const int ad, VariantArraySchema* va
   return status;
 }
 
+int VariantStorageManager::consolidate_array(const std::string& array_name)
+{
+  for(const auto& curr_elem : m_open_arrays_info_vector)
+    if(curr_elem.get_array_name() == array_name)
+      throw VariantStorageManagerException("Cannot consolidate array "+array_name+" while it is open");
+  auto status = tiledb_array_consolidate(m_tiledb_ctx, (m_workspace+'/'+array_name).c_str());
+  if(status != TILEDB_OK)
+    return status;
+  //Tiles are regrouped by consolidation - rebuild the sidecar tile index from the cells in column major order
+  auto tile_index_filename = GET_TILE_INDEX_PATH(m_workspace, array_name);
+  VariantArrayTileIndex old_tile_index;
+  //All the cells are rescanned - a stale index is rebuilt too
+  if(!old_tile_index.read_from_file(tile_index_filename, -1) || !old_tile_index.is_valid())
+    return TILEDB_OK;
+  VariantArraySchema schema;
+  status = get_array_schema(array_name, &schema);
+  if(status != TILEDB_OK)
+    return status;
+  auto END_schema_idx = -1;
+  for(auto i=0ull;i<schema.attribute_num();++i)
+    if(schema.attribute_name(i) == "END")
+      END_schema_idx = i;
+  VERIFY_OR_THROW(END_schema_idx >= 0 && "Array with a tile index must have the END attribute");
+  //The new index is built in a temporary file - the old index stays in place till the new one is complete
+  auto tmp_tile_index_filename = tile_index_filename+".tmp";
+  try
+  {
+    VariantArrayTileIndex::create_empty_index_file(tmp_tile_index_filename, old_tile_index.get_num_cells_per_tile());
+    VariantArrayTileIndex tile_index;
+    tile_index.read_from_file(tmp_tile_index_filename, 0);
+    tile_index.set_num_fragments(std::max(0, get_num_fragments(array_name)));
+    const auto& dim_domains = schema.dim_domains();
+    int64_t range[] = { dim_domains[0].first, dim_domains[0].second, dim_domains[1].first, dim_domains[1].second };
+    {
+      VariantArrayCellIterator iter(m_tiledb_ctx, schema, m_workspace+'/'+array_name, range, 1u,
+          std::vector<int>(1u, END_schema_idx), m_segment_size);
+      for(;!iter.end();++iter)
+      {
+        auto& cell = *iter;
+        tile_index.add_cell(cell.get_row(), cell.get_begin_column(), *(cell.get_field_ptr_for_query_idx<int64_t>(0)));
+      }
+    }
+    tile_index.write_to_file(tmp_tile_index_filename);
+  }
+  catch(...)
+  {
+    remove(tmp_tile_index_filename.c_str());
+    throw;
+  }
+  if(rename(tmp_tile_index_filename.c_str(), tile_index_filename.c_str()) != 0)
+  {
+    remove(tmp_tile_index_filename.c_str());
+    throw VariantStorageManagerException("Could not replace tile index file "+tile_index_filename);
+  }
+  return TILEDB_OK;
+}
+
+int VariantStorageManager::get_num_fragments(const std::string& array_name, int64_t* last_modification_time) const
+{
+  if(last_modification_time)
+    *last_modification_time = 0;
+  auto array_path = m_workspace+'/'+array_name;
+  auto dir = opendir(array_path.c_str());
+  if(dir == 0)
+    return -1;
+  auto num_fragments = 0;
+  struct dirent* entry = 0;
+  while((entry = readdir(dir)) != 0)
+  {
+    std::string entry_name = entry->d_name;
+    if(entry_name == "." || entry_name == "..")
+      continue;
+    //Fragments are sub-directories with a book-keeping file
+    struct stat st;
+    if(stat((array_path+'/'+entry_name+'/'+TILEDB_FRAGMENT_FILENAME).c_str(), &st) == 0)
+    {
+      ++num_fragments;
+      if(last_modification_time)
+        *last_modification_time = std::max<int64_t>(*last_modification_time,
+            static_cast<int64_t>(st.st_mtim.tv_sec)*1000000000ll + st.st_mtim.tv_nsec);
+    }
+  }
+  closedir(dir);
+  return num_fragments;
+}
+
+int VariantStorageManager::get_num_fragments(const int ad, int64_t* last_modification_time) const
+{
+  VERIFY_OR_THROW(static_cast<size_t>(ad) < m_open_arrays_info_vector.size() &&
+      m_open_arrays_info_vector[ad].get_array_name().length());
+  return get_num_fragments(m_open_arrays_info_vector[ad].get_array_name(), last_modification_time);
+}
+
+const std::string& VariantStorageManager::get_array_name(const int ad) const
+{
+  VERIFY_OR_THROW(static_cast<size_t>(ad) < m_open_arrays_info_vector.size());
+  return m_open_arrays_info_vector[ad].get_array_name();
+}
+
 int VariantStorageManager::get_array_schema(const std::string& array_name, VariantArraySchema* variant_array_schema)
 {
   // Get array schema
@@ -558,7 +1528,87 @@ VariantArrayCellIterator* VariantStorageManager::begin(
       m_open_arrays_info_vector[ad].get_array_name().length());
   auto& curr_elem = m_open_arrays_info_vector[ad];
   return new VariantArrayCellIterator(m_tiledb_ctx, curr_elem.get_schema(), m_workspace+'/'+curr_elem.get_array_name(),
-      range, attribute_ids, m_segment_size);   
+      range, 1u, attribute_ids, m_segment_size, 0u, curr_elem.get_read_stats());
+}
+
+void VariantStorageManager::check_compatible_arrays(const std::vector<int>& ads) const
+{
+  VERIFY_OR_THROW(!ads.empty());
+  for(auto ad : ads)
+  {
+    VERIFY_OR_THROW(static_cast<size_t>(ad) < m_open_arrays_info_vector.size() &&
+        m_open_arrays_info_vector[ad].get_array_name().length());
+    //Cells from all the arrays are read into cells of the first array's schema
+    const auto& first_schema = m_open_arrays_info_vector[ads[0u]].get_schema();
+    const auto& curr_schema = m_open_arrays_info_vector[ad].get_schema();
+    auto is_compatible = (curr_schema.attribute_num() == first_schema.attribute_num());
+    for(auto j=0u;is_compatible && j<curr_schema.attribute_num();++j)
+      is_compatible = (curr_schema.attribute_name(j) == first_schema.attribute_name(j)
+          && curr_schema.type(j) == first_schema.type(j) && curr_schema.val_num(j) == first_schema.val_num(j));
+    if(!is_compatible)
+      throw VariantStorageManagerException(std::string("Schema of array ")+m_open_arrays_info_vector[ad].get_array_name()
+          +" does not match the schema of array "+m_open_arrays_info_vector[ads[0u]].get_array_name());
+  }
+}
+
+VariantArrayCellIterator* VariantStorageManager::begin(
+    const std::vector<int>& ads, const std::vector<int64_t>& ranges, const std::vector<int>& attribute_ids,
+    const size_t buffer_budget) const
+{
+  check_compatible_arrays(ads);
+  assert(ranges.size()%4u == 0u);
+  //Subarrays clipped to the partition of every array - subarrays outside the partition are dropped
+  std::vector<std::string> iterator_array_paths;
+  std::vector<int64_t> iterator_ranges;
+  for(auto ad : ads)
+  {
+    auto num_subarrays = clip_ranges_to_partition(ad, ranges, iterator_ranges);
+    iterator_array_paths.resize(iterator_array_paths.size()+num_subarrays,
+        m_workspace+'/'+m_open_arrays_info_vector[ad].get_array_name());
+  }
+  auto& first_elem = m_open_arrays_info_vector[ads[0u]];
+  return new VariantArrayCellIterator(m_tiledb_ctx, first_elem.get_schema(), iterator_array_paths,
+      iterator_ranges.size() ? &(iterator_ranges[0]) : 0, attribute_ids, m_segment_size,
+      buffer_budget, first_elem.get_read_stats());
+}
+
+VariantArrayCellIterator* VariantStorageManager::begin_with_array_threads(
+    const std::vector<int>& ads, const std::vector<int64_t>& ranges, const std::vector<int>& attribute_ids,
+    const unsigned prefetch_depth, const size_t batch_size, const size_t buffer_budget) const
+{
+  check_compatible_arrays(ads);
+  //Subarrays of every array within its partition - arrays with no subarrays left are not read
+  std::vector<std::vector<int64_t>> array_ranges(ads.size());
+  auto num_arrays_read = 0u;
+  for(auto i=0ull;i<ads.size();++i)
+    if(clip_ranges_to_partition(ads[i], ranges, array_ranges[i]) > 0u)
+      ++num_arrays_read;
+  std::vector<std::unique_ptr<VariantArrayCellIterator>> array_iterators;
+  for(auto i=0ull;i<ads.size();++i)
+    if(!array_ranges[i].empty())
+      array_iterators.emplace_back(begin(ads[i], array_ranges[i], attribute_ids, buffer_budget/num_arrays_read));
+  return new VariantArrayCellIterator(m_open_arrays_info_vector[ads[0u]].get_schema(), attribute_ids,
+      std::move(array_iterators), prefetch_depth, batch_size);
+}
+
+unsigned VariantStorageManager::get_max_num_subarrays(const unsigned num_arrays, const size_t buffer_budget) const
+{
+  assert(num_arrays > 0u);
+  auto total_buffer_size = (buffer_budget > 0u) ? buffer_budget : static_cast<size_t>(m_segment_size);
+  return std::max<size_t>(total_buffer_size/(static_cast<size_t>(MIN_BUFFER_SIZE_PER_SUBARRAY)*num_arrays), 1u);
+}
+
+VariantArrayCellIterator* VariantStorageManager::begin(
+    int ad, const std::vector<int64_t>& ranges, const std::vector<int>& attribute_ids,
+    const size_t buffer_budget) const
+{
+  VERIFY_OR_THROW(static_cast<size_t>(ad) < m_open_arrays_info_vector.size() &&
+      m_open_arrays_info_vector[ad].get_array_name().length());
+  assert(ranges.size()%4u == 0u);
+  auto& curr_elem = m_open_arrays_info_vector[ad];
+  return new VariantArrayCellIterator(m_tiledb_ctx, curr_elem.get_schema(), m_workspace+'/'+curr_elem.get_array_name(),
+      ranges.size() ? &(ranges[0]) : 0, ranges.size()/4u, attribute_ids, m_segment_size,
+      buffer_budget, curr_elem.get_read_stats());
 }
 
 void VariantStorageManager::write_cell_sorted(const int ad, const void* ptr)
@@ -568,6 +1618,13 @@ void VariantStorageManager::write_cell_sorted(const int ad, const void* ptr)
   m_open_arrays_info_vector[ad].write_cell(ptr);
 }
 
+void VariantStorageManager::enable_async_writes(const int ad)
+{
+  VERIFY_OR_THROW(static_cast<size_t>(ad) < m_open_arrays_info_vector.size() &&
+      m_open_arrays_info_vector[ad].get_array_name().length());
+  m_open_arrays_info_vector[ad].enable_async_writes();
+}
+
 int64_t VariantStorageManager::get_num_valid_rows_in_array(const int ad) const
 {
   assert(static_cast<size_t>(ad) < m_open_arrays_info_vector.size() &&
@@ -575,6 +1632,58 @@ int64_t VariantStorageManager::get_num_valid_rows_in_array(const int ad) const
   return m_open_arrays_info_vector[ad].get_num_valid_rows_in_array();
 }
 
+int64_t VariantStorageManager::get_max_interval_length(const int ad) const
+{
+  assert(static_cast<size_t>(ad) < m_open_arrays_info_vector.size() &&
+      m_open_arrays_info_vector[ad].get_array_name().length());
+  return m_open_arrays_info_vector[ad].get_max_interval_length();
+}
+
+const VariantArrayTileIndex* VariantStorageManager::get_tile_index(const int ad) const
+{
+  assert(static_cast<size_t>(ad) < m_open_arrays_info_vector.size() &&
+      m_open_arrays_info_vector[ad].get_array_name().length());
+  return m_open_arrays_info_vector[ad].get_tile_index();
+}
+
+void VariantStorageManager::set_column_partition(const int ad, const ColumnRange& column_partition)
+{
+  VERIFY_OR_THROW(static_cast<size_t>(ad) < m_open_arrays_info_vector.size() &&
+      m_open_arrays_info_vector[ad].get_array_name().length());
+  m_open_arrays_info_vector[ad].set_column_partition(column_partition);
+}
+
+void VariantStorageManager::set_row_partition(const int ad, const RowRange& row_partition)
+{
+  VERIFY_OR_THROW(static_cast<size_t>(ad) < m_open_arrays_info_vector.size() &&
+      m_open_arrays_info_vector[ad].get_array_name().length());
+  m_open_arrays_info_vector[ad].set_row_partition(row_partition);
+}
+
+unsigned VariantStorageManager::clip_ranges_to_partition(const int ad, const std::vector<int64_t>& ranges,
+    std::vector<int64_t>& clipped_ranges) const
+{
+  assert(ranges.size()%4u == 0u);
+  const auto& row_partition = m_open_arrays_info_vector[ad].get_row_partition();
+  const auto& column_partition = m_open_arrays_info_vector[ad].get_column_partition();
+  auto num_subarrays = 0u;
+  for(auto i=0ull;i+3u<ranges.size();i+=4u)
+  {
+    auto row_begin = std::max(ranges[i], row_partition.first);
+    auto row_end = std::min(ranges[i+1u], row_partition.second);
+    auto column_begin = std::max(ranges[i+2u], column_partition.first);
+    auto column_end = std::min(ranges[i+3u], column_partition.second);
+    if(row_begin > row_end || column_begin > column_end)
+      continue;
+    clipped_ranges.push_back(row_begin);
+    clipped_ranges.push_back(row_end);
+    clipped_ranges.push_back(column_begin);
+    clipped_ranges.push_back(column_end);
+    ++num_subarrays;
+  }
+  return num_subarrays;
+}
+
 void VariantStorageManager::update_row_bounds_in_array(const int ad, const int64_t lb_row_idx, const int64_t max_valid_row_idx_in_array)
 {
   assert(static_cast<size_t>(ad) < m_open_arrays_info_vector.size() &&
@@ -141,12 +141,16 @@ LoaderArrayWriter::LoaderArrayWriter(
   //Array does not exist - define it first
   if(m_array_descriptor < 0)
   {
-    VERIFY_OR_THROW(m_storage_manager->define_array(m_schema, m_loader_json_config.get_num_cells_per_tile()) == TILEDB_OK
+    VERIFY_OR_THROW(m_storage_manager->define_array(m_schema, m_loader_json_config.get_num_cells_per_tile(),
+          m_loader_json_config.build_tile_index()) == TILEDB_OK
         && "Could not define TileDB array");
     //Open array in write mode
     m_array_descriptor = m_storage_manager->open_array(array_name, "w");
   }
   VERIFY_OR_THROW(m_array_descriptor != -1 && "Could not open TileDB array for loading");
+  //Compression and disk writes overlap with producing the next cells
+  if(m_loader_json_config.async_tiledb_writes())
+    m_storage_manager->enable_async_writes(m_array_descriptor);
   m_storage_manager->update_row_bounds_in_array(m_array_descriptor, m_row_partition.first,
       std::min(m_row_partition.second, id_mapper->get_max_callset_row_idx()));
 }
@@ -347,12 +351,11 @@ LoaderCombinedGVCFOperator::LoaderCombinedGVCFOperator(const VidMapper* id_mappe
   //Initialize variant
   m_variant = std::move(Variant(&m_query_config));
   m_variant.resize_based_on_query();
+  m_variant.enable_active_calls_tracking();
   //Cell
   m_cell = new BufferVariantCell(*m_schema, m_query_config);
   //Partition bounds
   m_partition = partition_range;
-  //PQ elements
-  m_tmp_pq_vector.resize(m_query_config.get_num_rows_to_query());
   //Position elements
   m_current_start_position = -1ll;
   m_next_start_position = -1ll;
@@ -374,7 +377,6 @@ void LoaderCombinedGVCFOperator::clear()
 {
   m_query_config.clear();
   m_variant.clear();
-  m_tmp_pq_vector.clear();
 }
 
 void LoaderCombinedGVCFOperator::operate(const void* cell_ptr)
@@ -410,7 +412,7 @@ void LoaderCombinedGVCFOperator::operate(const void* cell_ptr)
   m_cell->set_cell(cell_ptr);
   m_query_processor->scan_handle_cell(m_query_config, 0u,
       m_variant, *m_operator, *m_cell,
-      m_end_pq, m_tmp_pq_vector,
+      m_end_pq,
       m_current_start_position, m_next_start_position,
       m_num_calls_with_deletions, m_handle_spanning_deletions,
       m_stats_ptr);
@@ -443,6 +445,8 @@ void LoaderCombinedGVCFOperator::finish(const int64_t column_interval_end)
   {
     m_query_processor->handle_gvcf_ranges(m_end_pq, m_query_config, m_variant, *m_operator,
         m_current_start_position, m_next_start_position, column_interval_end == INT64_MAX, m_num_calls_with_deletions, m_stats_ptr);
+    if(!m_operator->overflow())
+      m_operator->end_column_interval(0u);
     operator_overflow = m_operator->overflow(); //must be queried before post_operate_sequential and flush_output() are called
 #ifdef DO_MEMORY_PROFILING
     statm_t mem_result;
@@ -60,8 +60,20 @@ BroadCombinedGVCFOperator::BroadCombinedGVCFOperator(VCFAdapter& vcf_adapter, co
   m_vcf_adapter = &vcf_adapter;
   m_vid_mapper = &id_mapper;
   m_use_missing_values_not_vector_end = use_missing_values_only_not_vector_end;
+  m_sites_only = query_config.sites_only();
   m_vcf_hdr = vcf_adapter.get_vcf_header();
   m_bcf_out = bcf_init();
+  //GQ banding
+  m_GQ_bands = vcf_adapter.get_GQ_bands();
+  m_pending_bcf_out = bcf_init();
+  m_pending_bcf_record_size = 0ull;
+  m_pending_column_begin = -1ll;
+  m_pending_column_end = -1ll;
+  m_pending_contig_begin_position = 0ll;
+  m_curr_FORMAT_buffer = 0;
+  m_curr_FORMAT_buffer_size = 0;
+  m_pending_FORMAT_buffer = 0;
+  m_pending_FORMAT_buffer_size = 0;
   //vector of char*, to avoid frequent reallocs()
   m_alleles_pointer_buffer.resize(100u);
   //DP INFO field - handle after all FORMAT fields have been processed
@@ -70,17 +82,24 @@ BroadCombinedGVCFOperator::BroadCombinedGVCFOperator(VCFAdapter& vcf_adapter, co
   //Determine queried INFO and FORMAT fields
   for(auto i=0u;i<query_config.get_num_queried_attributes();++i)
   {
+    //Fields fetched only for the per-call filter are neither in the records nor in the header
+    if(query_config.is_filter_only_query_idx(i))
+      continue;
     auto* field_info = m_vid_mapper->get_field_info(query_config.get_query_attribute_name(i));
     if(field_info)
     {
       auto known_field_enum = query_config.is_defined_known_field_enum_for_query_idx(i) ? query_config.get_known_field_enum_for_query_idx(i)
         : UNDEFINED_ATTRIBUTE_IDX_VALUE;
       auto VCF_field_combine_operation = query_config.get_VCF_field_combine_operation_for_query_attribute_idx(i);
+      //Sites-only - no FORMAT fields, DP is the sum of the INFO DP values of the calls
+      if(m_sites_only && known_field_enum == GVCF_DP_IDX
+          && VCF_field_combine_operation == VCFFieldCombineOperationEnum::VCF_FIELD_COMBINE_OPERATION_DP)
+        VCF_field_combine_operation = VCFFieldCombineOperationEnum::VCF_FIELD_COMBINE_OPERATION_SUM;
       auto add_to_INFO_vector = (field_info->m_is_vcf_INFO_field && known_field_enum != GVCF_END_IDX
           && (known_field_enum != GVCF_DP_IDX || VCF_field_combine_operation != VCFFieldCombineOperationEnum::VCF_FIELD_COMBINE_OPERATION_DP) //not DP or not combined as GATK Combine GVCF DP
           && VCF_field_combine_operation != VCFFieldCombineOperationEnum::VCF_FIELD_COMBINE_OPERATION_MOVE_TO_FORMAT  //not moved to FORMAT
           );
-      auto add_to_FORMAT_vector = (field_info->m_is_vcf_FORMAT_field ||
+      auto add_to_FORMAT_vector = !m_sites_only && (field_info->m_is_vcf_FORMAT_field ||
           (field_info->m_is_vcf_INFO_field
            && ((known_field_enum == GVCF_DP_IDX && VCF_field_combine_operation == VCFFieldCombineOperationEnum::VCF_FIELD_COMBINE_OPERATION_DP)
              || (VCF_field_combine_operation == VCFFieldCombineOperationEnum::VCF_FIELD_COMBINE_OPERATION_MOVE_TO_FORMAT)
@@ -163,9 +182,9 @@ BroadCombinedGVCFOperator::BroadCombinedGVCFOperator(VCFAdapter& vcf_adapter, co
   auto curr_contig_flag = m_vid_mapper->get_next_contig_location(-1ll, m_next_contig_name, m_next_contig_begin_position);
   assert(curr_contig_flag);
   switch_contig();
-  //Add samples to template header
+  //Add samples to template header - sites-only VCFs have no sample columns
   std::string callset_name;
-  for(auto i=0ull;i<query_config.get_num_rows_to_query();++i)
+  for(auto i=0ull;!m_sites_only && i<query_config.get_num_rows_to_query();++i)
   {
     auto row_idx = query_config.get_array_row_idx_for_query_row_idx(i);
     auto status = m_vid_mapper->get_callset_name(row_idx, callset_name);
@@ -463,11 +482,196 @@ void BroadCombinedGVCFOperator::operate(Variant& variant, const VariantQueryConf
   //INFO fields
   handle_INFO_fields(variant);
   //FORMAT fields
-  handle_FORMAT_fields(variant);
+  if(!m_sites_only)
+    handle_FORMAT_fields(variant);
 #ifdef DO_PROFILING
   m_bcf_t_creation_timer.stop();
 #endif
-  m_vcf_adapter->handoff_output_bcf_line(m_bcf_out, m_bcf_record_size);
+  if(m_GQ_bands.empty())
+    m_vcf_adapter->handoff_output_bcf_line(m_bcf_out, m_bcf_record_size);
+  else
+    band_or_handoff_record();
+}
+
+void BroadCombinedGVCFOperator::band_or_handoff_record()
+{
+  //Only reference blocks with GQ values are banded
+  auto can_band = m_is_reference_block_only && get_GQ_band_vector(m_bcf_out, m_curr_GQ_band_vector);
+  auto column_begin = static_cast<int64_t>(m_remapped_variant.get_column_begin());
+  auto column_end = static_cast<int64_t>(m_remapped_variant.get_column_end());
+  if(m_pending_column_end >= 0)
+  {
+    if(can_band && column_begin == m_pending_column_end+1 && m_curr_contig_begin_position == m_pending_contig_begin_position
+        && m_curr_GQ_band_vector == m_pending_GQ_band_vector && have_same_INFO_fields(m_bcf_out, m_pending_bcf_out))
+    {
+      //Extend pending record - as in GATK's GQ bands, GQ, DP and PL are the minimum over the merged records.
+      //INFO values are per column and have no meaningful combination over the band, hence they must match
+      m_pending_column_end = column_end;
+      merge_FORMAT_field_minimum("GQ");
+      merge_FORMAT_field_minimum("DP");
+      merge_FORMAT_field_minimum("MIN_DP");
+      merge_FORMAT_field_minimum("PL");
+      return;
+    }
+    flush_pending_record();
+  }
+  if(can_band)
+  {
+    std::swap<bcf1_t*>(m_bcf_out, m_pending_bcf_out);
+    m_pending_bcf_record_size = m_bcf_record_size;
+    m_pending_column_begin = column_begin;
+    m_pending_column_end = column_end;
+    m_pending_contig_begin_position = m_curr_contig_begin_position;
+    m_pending_GQ_band_vector.swap(m_curr_GQ_band_vector);
+  }
+  else
+    m_vcf_adapter->handoff_output_bcf_line(m_bcf_out, m_bcf_record_size);
+}
+
+void BroadCombinedGVCFOperator::flush_pending_record()
+{
+  if(m_pending_column_end < 0)
+    return;
+  if(m_pending_column_end > m_pending_column_begin)
+  {
+    int vcf_end_pos = m_pending_column_end - m_pending_contig_begin_position + 1; //vcf END is 1 based
+    //Records that span multiple columns already have END
+    auto END_exists = (bcf_get_info_int32(m_vcf_hdr, m_pending_bcf_out, "END",
+          &m_curr_FORMAT_buffer, &m_curr_FORMAT_buffer_size) > 0);
+    bcf_update_info_int32(m_vcf_hdr, m_pending_bcf_out, "END", &vcf_end_pos, 1);
+    if(!END_exists)
+      m_pending_bcf_record_size += sizeof(int);
+  }
+  m_vcf_adapter->handoff_output_bcf_line(m_pending_bcf_out, m_pending_bcf_record_size);
+  m_pending_column_end = -1ll;
+}
+
+void BroadCombinedGVCFOperator::checkpoint_pending_record(std::vector<uint8_t>& buffer, uint64_t& offset)
+{
+  //Pending flag
+  RESIZE_BINARY_SERIALIZATION_BUFFER_IF_NEEDED(buffer, offset, sizeof(bool));
+  *(reinterpret_cast<bool*>(&(buffer[offset]))) = (m_pending_column_end >= 0);
+  offset += sizeof(bool);
+  if(m_pending_column_end < 0)
+    return;
+  //Columns, contig begin position, record size
+  auto add_size = 3u*sizeof(int64_t)+2u*sizeof(uint64_t);
+  RESIZE_BINARY_SERIALIZATION_BUFFER_IF_NEEDED(buffer, offset, add_size);
+  *(reinterpret_cast<int64_t*>(&(buffer[offset]))) = m_pending_column_begin;
+  offset += sizeof(int64_t);
+  *(reinterpret_cast<int64_t*>(&(buffer[offset]))) = m_pending_column_end;
+  offset += sizeof(int64_t);
+  *(reinterpret_cast<int64_t*>(&(buffer[offset]))) = m_pending_contig_begin_position;
+  offset += sizeof(int64_t);
+  *(reinterpret_cast<uint64_t*>(&(buffer[offset]))) = m_pending_bcf_record_size;
+  offset += sizeof(uint64_t);
+  //Serialized length is filled in after the record is serialized
+  auto length_offset = offset;
+  offset += sizeof(uint64_t);
+  //Record as BCF - bcf_serialize() returns offset unchanged if the buffer is too small
+  kstring_t tmp_string = { 0, 0, 0 };
+  auto new_offset = offset;
+  while(new_offset == offset)
+  {
+    RESIZE_BINARY_SERIALIZATION_BUFFER_IF_NEEDED(buffer, offset, m_pending_bcf_record_size);
+    new_offset = bcf_serialize(m_pending_bcf_out, &(buffer[0]), offset, buffer.size(), 1, m_vcf_hdr, &tmp_string);
+    if(new_offset == offset)
+      buffer.resize(2u*buffer.size());
+  }
+  free(tmp_string.s);
+  *(reinterpret_cast<uint64_t*>(&(buffer[length_offset]))) = new_offset - offset;
+  offset = new_offset;
+}
+
+void BroadCombinedGVCFOperator::restore_pending_record(const std::vector<uint8_t>& buffer, uint64_t& offset)
+{
+  m_pending_column_end = -1ll;
+  if(offset + sizeof(bool) > buffer.size())
+    throw BroadCombinedGVCFException("Truncated checkpoint of the GQ band record");
+  auto is_pending = *(reinterpret_cast<const bool*>(&(buffer[offset])));
+  offset += sizeof(bool);
+  if(!is_pending)
+    return;
+  if(offset + 3u*sizeof(int64_t)+2u*sizeof(uint64_t) > buffer.size())
+    throw BroadCombinedGVCFException("Truncated checkpoint of the GQ band record");
+  auto column_begin = *(reinterpret_cast<const int64_t*>(&(buffer[offset])));
+  offset += sizeof(int64_t);
+  auto column_end = *(reinterpret_cast<const int64_t*>(&(buffer[offset])));
+  offset += sizeof(int64_t);
+  m_pending_contig_begin_position = *(reinterpret_cast<const int64_t*>(&(buffer[offset])));
+  offset += sizeof(int64_t);
+  m_pending_bcf_record_size = *(reinterpret_cast<const uint64_t*>(&(buffer[offset])));
+  offset += sizeof(uint64_t);
+  auto serialized_length = *(reinterpret_cast<const uint64_t*>(&(buffer[offset])));
+  offset += sizeof(uint64_t);
+  if(offset + serialized_length > buffer.size())
+    throw BroadCombinedGVCFException("Truncated checkpoint of the GQ band record");
+  auto new_offset = bcf_deserialize(m_pending_bcf_out, const_cast<uint8_t*>(&(buffer[0])), offset,
+      offset + serialized_length, 1, m_vcf_hdr);
+  if(new_offset != offset + serialized_length)
+    throw BroadCombinedGVCFException("Could not deserialize the GQ band record in the checkpoint");
+  offset = new_offset;
+  if(!get_GQ_band_vector(m_pending_bcf_out, m_pending_GQ_band_vector))
+    throw BroadCombinedGVCFException("GQ band record in the checkpoint has no GQ values");
+  m_pending_column_begin = column_begin;
+  m_pending_column_end = column_end;
+}
+
+bool BroadCombinedGVCFOperator::get_GQ_band_vector(bcf1_t* line, std::vector<int>& GQ_band_vector)
+{
+  auto num_values = bcf_get_format_int32(m_vcf_hdr, line, "GQ", &m_curr_FORMAT_buffer, &m_curr_FORMAT_buffer_size);
+  if(num_values <= 0)
+    return false;
+  GQ_band_vector.resize(num_values);
+  //Band idx - #boundaries <= GQ, -1 for samples without a GQ value
+  for(auto i=0;i<num_values;++i)
+    GQ_band_vector[i] = is_bcf_valid_value<int>(m_curr_FORMAT_buffer[i])
+      ? std::upper_bound(m_GQ_bands.begin(), m_GQ_bands.end(), m_curr_FORMAT_buffer[i]) - m_GQ_bands.begin()
+      : -1;
+  return true;
+}
+
+void BroadCombinedGVCFOperator::merge_FORMAT_field_minimum(const char* field_name)
+{
+  auto num_values = bcf_get_format_int32(m_vcf_hdr, m_bcf_out, field_name, &m_curr_FORMAT_buffer, &m_curr_FORMAT_buffer_size);
+  auto num_pending_values = bcf_get_format_int32(m_vcf_hdr, m_pending_bcf_out, field_name,
+      &m_pending_FORMAT_buffer, &m_pending_FORMAT_buffer_size);
+  if(num_values <= 0 || num_values != num_pending_values)
+    return;
+  for(auto i=0;i<num_values;++i)
+    if(is_bcf_valid_value<int>(m_curr_FORMAT_buffer[i])
+        && (!is_bcf_valid_value<int>(m_pending_FORMAT_buffer[i]) || m_curr_FORMAT_buffer[i] < m_pending_FORMAT_buffer[i]))
+      m_pending_FORMAT_buffer[i] = m_curr_FORMAT_buffer[i];
+  bcf_update_format_int32(m_vcf_hdr, m_pending_bcf_out, field_name, m_pending_FORMAT_buffer, num_values);
+}
+
+//Skips removed INFO fields and END
+static int get_next_INFO_idx_to_compare(const bcf1_t* line, int idx, const int END_key)
+{
+  while(idx < static_cast<int>(line->n_info) && (line->d.info[idx].vptr == 0 || line->d.info[idx].key == END_key))
+    ++idx;
+  return idx;
+}
+
+bool BroadCombinedGVCFOperator::have_same_INFO_fields(bcf1_t* line, bcf1_t* other_line) const
+{
+  bcf_unpack(line, BCF_UN_INFO);
+  bcf_unpack(other_line, BCF_UN_INFO);
+  auto END_key = bcf_hdr_id2int(m_vcf_hdr, BCF_DT_ID, "END");
+  //Both records are built by handle_INFO_fields() - INFO fields are in the same order
+  auto idx = get_next_INFO_idx_to_compare(line, 0, END_key);
+  auto other_idx = get_next_INFO_idx_to_compare(other_line, 0, END_key);
+  while(idx < static_cast<int>(line->n_info) && other_idx < static_cast<int>(other_line->n_info))
+  {
+    auto& info = line->d.info[idx];
+    auto& other_info = other_line->d.info[other_idx];
+    if(info.key != other_info.key || info.type != other_info.type || info.len != other_info.len
+        || info.vptr_len != other_info.vptr_len || memcmp(info.vptr, other_info.vptr, info.vptr_len) != 0)
+      return false;
+    idx = get_next_INFO_idx_to_compare(line, idx+1, END_key);
+    other_idx = get_next_INFO_idx_to_compare(other_line, other_idx+1, END_key);
+  }
+  return (idx >= static_cast<int>(line->n_info) && other_idx >= static_cast<int>(other_line->n_info));
 }
 
 void BroadCombinedGVCFOperator::switch_contig()
@@ -600,4 +804,40 @@ void BroadCombinedGVCFOperator::handle_deletions(Variant& variant, const Variant
   }
 }
 
+//BroadCombinedGVCFOperatorSet functions
+BroadCombinedGVCFOperatorSet::BroadCombinedGVCFOperatorSet(const VCFAdapter& vcf_adapter, const VidMapper& id_mapper,
+    const VariantQueryConfig& query_config, const unsigned num_threads,
+    const unsigned max_diploid_alt_alleles_that_can_be_genotyped, const bool use_missing_values_only_not_vector_end)
+{
+  assert(num_threads > 0u);
+  m_vcf_adapters.resize(num_threads, 0);
+  m_buffers.resize(num_threads, 0);
+  m_operators.resize(num_threads, 0);
+  for(auto i=0u;i<num_threads;++i)
+  {
+    m_buffers[i] = new RWBuffer();
+    m_vcf_adapters[i] = new VCFSerializedBufferAdapter(DEFAULT_COMBINED_VCF_RECORDS_BUFFER_SIZE, false);
+    m_vcf_adapters[i]->initialize(vcf_adapter);
+    m_vcf_adapters[i]->set_buffer(*(m_buffers[i]));
+    m_operators[i] = new BroadCombinedGVCFOperator(*(m_vcf_adapters[i]), id_mapper, query_config,
+        max_diploid_alt_alleles_that_can_be_genotyped, use_missing_values_only_not_vector_end);
+    //Header is printed by the main adapter - discard the copy produced by the constructor
+    m_buffers[i]->m_num_valid_bytes = 0u;
+  }
+}
+
+BroadCombinedGVCFOperatorSet::~BroadCombinedGVCFOperatorSet()
+{
+  for(auto i=0u;i<m_operators.size();++i)
+  {
+    //Operator refers to the adapter which refers to the buffer
+    delete m_operators[i];
+    delete m_vcf_adapters[i];
+    delete m_buffers[i];
+  }
+  m_operators.clear();
+  m_vcf_adapters.clear();
+  m_buffers.clear();
+}
+
 #endif //ifdef HTSDIR
@@ -140,9 +140,9 @@ void VariantOperations::merge_alt_alleles(const Variant& variant,
   auto merged_reference_length = merged_reference_allele.length();
   //invalidate all existing mappings in the LUT
   alleles_LUT.reset_luts();
-  //vector to store idx mappings for NON_REF allele, update LUT at end as #ALT alleles are not known till end
-  //Set everything to -1 (invalid mapping)
-  auto input_non_reference_allele_idx = std::vector<int>(variant.get_num_calls(), -1);
+  //vector to store <call idx, NON_REF allele idx> pairs, update LUT at end as #ALT alleles are not known till end
+  //Only calls containing NON_REF are stored - avoids allocating/traversing a vector of size #calls at every site
+  auto input_non_reference_allele_idx = std::vector<std::pair<uint64_t, int>>();
   auto merged_allele_idx = 1u;	//why 1, ref is index 0, alt begins at 1
   NON_REF_exists = false;       //by default, assume NON_REF does not exist
   //Get VariantQueryConfig
@@ -175,7 +175,7 @@ void VariantOperations::merge_alt_alleles(const Variant& variant,
     {
       if(IS_NON_REF_ALLELE(allele))
       {
-        input_non_reference_allele_idx[curr_call_idx_in_variant] = input_allele_idx;
+        input_non_reference_allele_idx.emplace_back(curr_call_idx_in_variant, input_allele_idx);
         NON_REF_exists = true;
       }
       else
@@ -214,15 +214,9 @@ void VariantOperations::merge_alt_alleles(const Variant& variant,
     //always check whether LUT is big enough for alleles_LUT (since the #alleles in the merged variant is unknown)
     alleles_LUT.resize_luts_if_needed(non_reference_allele_idx + 1); 
     //Add mappings for non_ref allele
-    //Iterate over valid calls
-    for (auto valid_calls_iter=variant.begin();valid_calls_iter != variant.end();++valid_calls_iter)
-    {
-      //Not always in sequence, as invalid calls are skipped
-      auto curr_call_idx_in_variant = valid_calls_iter.get_call_idx_in_variant();
-      if(input_non_reference_allele_idx[curr_call_idx_in_variant] >= 0)
-        alleles_LUT.add_input_merged_idx_pair(curr_call_idx_in_variant, input_non_reference_allele_idx[curr_call_idx_in_variant],
-            non_reference_allele_idx);
-    }
+    for(const auto& call_idx_allele_idx_pair : input_non_reference_allele_idx)
+      alleles_LUT.add_input_merged_idx_pair(call_idx_allele_idx_pair.first, call_idx_allele_idx_pair.second,
+          non_reference_allele_idx);
   }
 }
 
@@ -357,6 +351,135 @@ void SingleVariantOperatorBase::operate(Variant& variant, const VariantQueryConf
   m_remapping_needed = !m_is_reference_block_only;
 }
 
+//CoalescedColumnIntervalsOperator
+void CoalescedColumnIntervalsOperator::switch_target(const unsigned target_idx)
+{
+  if(target_idx == m_curr_target_idx)
+    return;
+  if(m_curr_target_idx != UNDEFINED_TARGET_IDX)
+    m_variant_operator->end_column_interval(m_curr_target_idx);
+  m_curr_target_idx = target_idx;
+  if(m_curr_target_idx != UNDEFINED_TARGET_IDX)
+    m_variant_operator->begin_column_interval(m_curr_target_idx, m_target_intervals[m_curr_target_idx]);
+}
+
+unsigned CoalescedColumnIntervalsOperator::operate_on_targets(Variant& variant, unsigned target_idx)
+{
+  auto column_begin = static_cast<int64_t>(variant.get_column_begin());
+  auto column_end = static_cast<int64_t>(variant.get_column_end());
+  for(;target_idx<m_target_intervals.size() && m_target_intervals[target_idx].first <= column_end;++target_idx)
+  {
+    //Remaining targets are handled after the scan resumes
+    if(m_variant_operator->overflow())
+      return target_idx;
+    switch_target(target_idx);
+    variant.set_column_interval(std::max(column_begin, m_target_intervals[target_idx].first),
+        std::min(column_end, m_target_intervals[target_idx].second));
+    m_variant_operator->operate(variant, *m_query_config);
+    variant.set_column_interval(column_begin, column_end);
+  }
+  return UNDEFINED_TARGET_IDX;
+}
+
+void CoalescedColumnIntervalsOperator::flush_pending_variants()
+{
+  while(!m_pending_variants.empty())
+  {
+    auto target_idx = operate_on_targets(m_pending_variants.front(), m_pending_target_idxs.front());
+    if(target_idx != UNDEFINED_TARGET_IDX)
+    {
+      m_pending_target_idxs.front() = target_idx;
+      return;
+    }
+    m_pending_variants.pop_front();
+    m_pending_target_idxs.pop_front();
+  }
+}
+
+void CoalescedColumnIntervalsOperator::operate(Variant& variant, const VariantQueryConfig& query_config)
+{
+  m_query_config = &query_config;
+  auto column_begin = static_cast<int64_t>(variant.get_column_begin());
+  //Variants are produced in column order, targets are sorted and disjoint
+  while(m_next_target_idx < m_target_intervals.size() && m_target_intervals[m_next_target_idx].second < column_begin)
+    ++m_next_target_idx;
+  //Variants left over from the previous overflow go first
+  flush_pending_variants();
+  auto target_idx = m_next_target_idx;
+  if(m_pending_variants.empty())
+    target_idx = operate_on_targets(variant, target_idx);
+  if(target_idx < m_target_intervals.size()
+      && m_target_intervals[target_idx].first <= static_cast<int64_t>(variant.get_column_end()))
+  {
+    //Deep copy - variant is re-used by the scan
+    m_pending_variants.emplace_back();
+    m_pending_variants.back().copy_from_variant(variant);
+    m_pending_target_idxs.push_back(target_idx);
+  }
+}
+
+void CoalescedColumnIntervalsOperator::finalize()
+{
+  flush_pending_variants();
+  //Still overflowing - the last target is closed when the scan resumes
+  if(m_pending_variants.empty() && !m_variant_operator->overflow())
+    switch_target(UNDEFINED_TARGET_IDX);
+}
+
+void CoalescedColumnIntervalsOperator::checkpoint_state(std::vector<uint8_t>& buffer, uint64_t& offset) const
+{
+  //Target idxs, #pending Variants
+  auto add_size = 2u*sizeof(unsigned)+sizeof(uint64_t);
+  RESIZE_BINARY_SERIALIZATION_BUFFER_IF_NEEDED(buffer, offset, add_size);
+  *(reinterpret_cast<unsigned*>(&(buffer[offset]))) = m_next_target_idx;
+  offset += sizeof(unsigned);
+  *(reinterpret_cast<unsigned*>(&(buffer[offset]))) = m_curr_target_idx;
+  offset += sizeof(unsigned);
+  *(reinterpret_cast<uint64_t*>(&(buffer[offset]))) = m_pending_variants.size();
+  offset += sizeof(uint64_t);
+  //First target still to be handled followed by the Variant
+  for(auto i=0ull;i<m_pending_variants.size();++i)
+  {
+    RESIZE_BINARY_SERIALIZATION_BUFFER_IF_NEEDED(buffer, offset, sizeof(unsigned));
+    *(reinterpret_cast<unsigned*>(&(buffer[offset]))) = m_pending_target_idxs[i];
+    offset += sizeof(unsigned);
+    m_pending_variants[i].binary_serialize(buffer, offset);
+  }
+}
+
+void CoalescedColumnIntervalsOperator::restore_state(const VariantQueryProcessor& query_processor,
+    const VariantQueryConfig& query_config, const std::vector<uint8_t>& buffer, uint64_t& offset)
+{
+  if(offset + 2u*sizeof(unsigned)+sizeof(uint64_t) > buffer.size())
+    throw VariantOperationException("Truncated checkpoint of the coalesced column intervals");
+  auto next_target_idx = *(reinterpret_cast<const unsigned*>(&(buffer[offset])));
+  offset += sizeof(unsigned);
+  auto curr_target_idx = *(reinterpret_cast<const unsigned*>(&(buffer[offset])));
+  offset += sizeof(unsigned);
+  auto num_pending_variants = *(reinterpret_cast<const uint64_t*>(&(buffer[offset])));
+  offset += sizeof(uint64_t);
+  if(next_target_idx > m_target_intervals.size()
+      || (curr_target_idx != UNDEFINED_TARGET_IDX && curr_target_idx >= m_target_intervals.size()))
+    throw VariantOperationException("Target interval idx in the checkpoint is larger than the number of targets");
+  m_next_target_idx = next_target_idx;
+  m_curr_target_idx = curr_target_idx;
+  m_query_config = &query_config;
+  m_pending_variants.clear();
+  m_pending_target_idxs.clear();
+  for(auto i=0ull;i<num_pending_variants;++i)
+  {
+    if(offset + sizeof(unsigned) > buffer.size())
+      throw VariantOperationException("Truncated checkpoint of the coalesced column intervals");
+    auto target_idx = *(reinterpret_cast<const unsigned*>(&(buffer[offset])));
+    offset += sizeof(unsigned);
+    if(target_idx >= m_target_intervals.size())
+      throw VariantOperationException("Target interval idx in the checkpoint is larger than the number of targets");
+    m_pending_variants.emplace_back(&query_config);
+    query_processor.binary_deserialize(m_pending_variants.back(), query_config, buffer, offset);
+    m_pending_target_idxs.push_back(target_idx);
+  }
+}
+
 //Dummy genotyping operator
 void DummyGenotypingOperator::operate(Variant& variant, const VariantQueryConfig& query_config)
 {
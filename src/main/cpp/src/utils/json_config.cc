@@ -104,11 +104,16 @@ void JSONConfigBase::read_from_file(const std::string& filename, const VidMapper
   {
     VERIFY_OR_THROW(!(m_json.HasMember("row_partitions") && m_json.HasMember("column_partitions"))
         && "Cannot have both \"row_partitions\" and \"column_partitions\" simultaneously in the JSON file");
-    VERIFY_OR_THROW((m_json.HasMember("query_column_ranges") || m_json.HasMember("column_partitions") ||
+    VERIFY_OR_THROW((m_json.HasMember("query_column_ranges") || m_json.HasMember("query_column_ranges_bed_file")
+          || m_json.HasMember("column_partitions") ||
           m_json.HasMember("query_row_ranges") || m_json.HasMember("row_partitions")) &&
-        "Must have one of \"query_column_ranges\" or \"column_partitions\" or \"query_row_ranges\" or \"row_partitions\"");
+        "Must have one of \"query_column_ranges\" or \"query_column_ranges_bed_file\" or \"column_partitions\" or \"query_row_ranges\" or \"row_partitions\"");
     VERIFY_OR_THROW((!m_json.HasMember("query_column_ranges") || !m_json.HasMember("column_partitions")) &&
         "Cannot use both \"query_column_ranges\" and \"column_partitions\" simultaneously");
+    VERIFY_OR_THROW((!m_json.HasMember("query_column_ranges_bed_file") || !m_json.HasMember("column_partitions")) &&
+        "Cannot use both \"query_column_ranges_bed_file\" and \"column_partitions\" simultaneously");
+    VERIFY_OR_THROW((!m_json.HasMember("query_column_ranges_bed_file") || !m_json.HasMember("query_column_ranges")) &&
+        "Cannot use both \"query_column_ranges_bed_file\" and \"query_column_ranges\" simultaneously");
     //Query columns
     //Example:  [ [ [0,5], 45 ], [ 76, 87 ] ]
     //This means that rank 0 will have 2 query intervals: [0-5] and [45-45] and rank 1 will have
@@ -187,6 +192,30 @@ void JSONConfigBase::read_from_file(const std::string& filename, const VidMapper
       }
     }
     else
+      if(m_json.HasMember("query_column_ranges_bed_file"))
+      {
+        //Either a single BED file used by all ranks or a list of BED files, one for every rank
+        const rapidjson::Value& bed_files = m_json["query_column_ranges_bed_file"];
+        if(bed_files.IsArray())
+        {
+          m_column_ranges.resize(bed_files.Size());
+          for(rapidjson::SizeType i=0;i<bed_files.Size();++i)
+          {
+            VERIFY_OR_THROW(bed_files[i].IsString());
+            read_column_ranges_from_bed_file(bed_files[i].GetString(), id_mapper, m_column_ranges[i]);
+          }
+          if(bed_files.Size() == 1u)
+            m_single_query_column_ranges_vector = true;
+        }
+        else
+        {
+          VERIFY_OR_THROW(bed_files.IsString());
+          m_column_ranges.resize(1u);
+          read_column_ranges_from_bed_file(bed_files.GetString(), id_mapper, m_column_ranges[0u]);
+          m_single_query_column_ranges_vector = true;
+        }
+      }
+      else
       if (m_json.HasMember("column_partitions"))
       {
         m_column_partitions_specified = true;
@@ -407,6 +436,35 @@ const std::vector<RowRange>& JSONConfigBase::get_query_row_ranges(const int rank
   return m_row_ranges[fixed_rank];
 }
 
+void JSONConfigBase::read_column_ranges_from_bed_file(const std::string& filename, const VidMapper* id_mapper,
+    std::vector<ColumnRange>& column_ranges)
+{
+  std::ifstream ifs(filename.c_str());
+  if(!ifs.is_open())
+    throw RunConfigException(std::string("Could not open BED file ")+filename);
+  assert(id_mapper != 0);
+  std::string line;
+  auto line_idx = 0ull;
+  while(std::getline(ifs, line))
+  {
+    ++line_idx;
+    //Skip empty lines, comments and header lines
+    if(line.empty() || line[0] == '#' || line.compare(0u, 5u, "track") == 0 || line.compare(0u, 7u, "browser") == 0)
+      continue;
+    std::istringstream line_stream(line);
+    std::string contig_name;
+    int64_t begin = -1ll;
+    int64_t end = -1ll;
+    if(!(line_stream >> contig_name >> begin >> end) || begin < 0 || end <= begin)
+      throw RunConfigException(std::string("Invalid BED file line ")+std::to_string(line_idx)+" in "+filename+" : "+line);
+    ContigInfo contig_info;
+    if(!id_mapper->get_contig_info(contig_name, contig_info))
+      throw VidMapperException("JSONConfigBase::read_column_ranges_from_bed_file: Invalid contig name : " + contig_name);
+    //BED intervals are 0-based and half-open
+    column_ranges.emplace_back(contig_info.m_tiledb_column_offset + begin, contig_info.m_tiledb_column_offset + end - 1);
+  }
+}
+
 const std::vector<ColumnRange>& JSONConfigBase::get_query_column_ranges(const int rank) const
 {
   auto fixed_rank = m_single_query_column_ranges_vector ? 0 : rank;
@@ -472,9 +530,16 @@ void JSONBasicQueryConfig::update_from_loader(JSONLoaderConfig* loader_config, c
   // Update array if it is not provided in query json
   if (!m_json.HasMember("array"))
   {
-    // Set as single array
-    m_single_array_name = true;
-    m_array_names.push_back(loader_config->get_array_name(rank));
+    //All the partitions are queried together
+    if(m_json.HasMember("merge_array_partitions") && m_json["merge_array_partitions"].IsBool()
+        && m_json["merge_array_partitions"].GetBool() && loader_config->get_array_names().size() > 1u)
+      m_array_names = loader_config->get_array_names();
+    else
+    {
+      // Set as single array
+      m_single_array_name = true;
+      m_array_names.push_back(loader_config->get_array_name(rank));
+    }
   }
   //Vid mapping
   if(!m_json.HasMember("vid_mapping_file"))
@@ -538,10 +603,105 @@ void JSONBasicQueryConfig::read_from_file(const std::string& filename, VariantQu
       && ("Could not find array for rank "+std::to_string(rank)).c_str());
   auto& array_name = m_single_array_name ? m_array_names[0] : m_array_names[rank];
   VERIFY_OR_THROW(array_name != "" && "Empty array name");
+  //All the arrays (column partitions) in the workspace are queried by every rank through a merged iterator
+  m_merge_array_partitions = m_json.HasMember("merge_array_partitions") && m_json["merge_array_partitions"].IsBool()
+    && m_json["merge_array_partitions"].GetBool() && !m_single_array_name && m_array_names.size() > 1u;
   //Query columns
   VERIFY_OR_THROW((m_column_ranges.size() || m_scan_whole_array) && "Query column ranges not specified");
-  subset_query_column_ranges_based_on_partition(loader_config, rank);
-  if(!m_scan_whole_array)
+  if(!m_merge_array_partitions)
+    subset_query_column_ranges_based_on_partition(loader_config, rank);
+  //The loader writes intervals spanning the begin of a column partition into that partition too - merged
+  //iterators read every array only within its column partition
+  m_array_column_partitions.clear();
+  if(m_merge_array_partitions)
+  {
+    if(loader_config && loader_config->is_partitioned_by_column())
+    {
+      const auto& loader_array_names = loader_config->get_array_names();
+      for(const auto& curr_array_name : m_array_names)
+      {
+        auto partition_idx = 0u;
+        while(partition_idx < loader_array_names.size() && loader_array_names[partition_idx] != curr_array_name)
+          ++partition_idx;
+        if(partition_idx >= loader_array_names.size())
+          throw RunConfigException(std::string("Array ")+curr_array_name
+              +" is not a column partition in the loader JSON - cannot merge array partitions");
+        m_array_column_partitions.push_back(loader_config->get_column_partition(partition_idx));
+      }
+    }
+    else if(m_column_partitions_specified)
+    {
+      //Without the partition of every array, cells copied across partition boundaries would be returned twice
+      if(m_column_ranges.size() != m_array_names.size())
+        throw RunConfigException(std::string("Number of column partitions (")+std::to_string(m_column_ranges.size())
+            +") does not match the number of arrays ("+std::to_string(m_array_names.size())
+            +") - cannot merge array partitions");
+      for(auto i=0u;i<m_column_ranges.size();++i)
+      {
+        if(m_column_ranges[i].empty())
+          throw RunConfigException(std::string("No column partition for array ")+m_array_names[i]
+              +" - cannot merge array partitions");
+        m_array_column_partitions.push_back(m_column_ranges[i][0u]);
+      }
+    }
+  }
+  //Same for row partitions - every array is read only for the row blocks within its row partition
+  m_array_row_partitions.clear();
+  if(m_merge_array_partitions)
+  {
+    if(loader_config && loader_config->is_partitioned_by_row())
+    {
+      const auto& loader_array_names = loader_config->get_array_names();
+      for(const auto& curr_array_name : m_array_names)
+      {
+        auto partition_idx = 0u;
+        while(partition_idx < loader_array_names.size() && loader_array_names[partition_idx] != curr_array_name)
+          ++partition_idx;
+        if(partition_idx >= loader_array_names.size())
+          throw RunConfigException(std::string("Array ")+curr_array_name
+              +" is not a row partition in the loader JSON - cannot merge array partitions");
+        m_array_row_partitions.push_back(loader_config->get_row_partition(partition_idx));
+      }
+    }
+    else if(m_row_partitions_specified)
+    {
+      if(m_row_ranges.size() != m_array_names.size())
+        throw RunConfigException(std::string("Number of row partitions (")+std::to_string(m_row_ranges.size())
+            +") does not match the number of arrays ("+std::to_string(m_array_names.size())
+            +") - cannot merge array partitions");
+      for(auto i=0u;i<m_row_ranges.size();++i)
+      {
+        if(m_row_ranges[i].empty())
+          throw RunConfigException(std::string("No row partition for array ")+m_array_names[i]
+              +" - cannot merge array partitions");
+        m_array_row_partitions.push_back(m_row_ranges[i][0u]);
+      }
+    }
+  }
+  //Cells of row partitions interleave - every partition is read on its own thread
+  if(m_merge_array_partitions && loader_config && loader_config->is_partitioned_by_row())
+    query_config.set_scan_partitions_in_threads(true);
+  if(m_json.HasMember("scan_partitions_in_threads") && m_json["scan_partitions_in_threads"].IsBool())
+    query_config.set_scan_partitions_in_threads(m_json["scan_partitions_in_threads"].GetBool());
+  //The threaded scan reads every array only for the row blocks within its row partition - all of them must be known
+  if(m_merge_array_partitions && query_config.scan_partitions_in_threads()
+      && m_array_row_partitions.size() != m_array_names.size())
+    throw RunConfigException("\"scan_partitions_in_threads\" requires the row partition of every merged array"
+        " (from the loader JSON or \"row_partitions\" in the query JSON)");
+  //Split column intervals by cost. If all ranks query the same array and rows, the column ranges of all ranks are
+  //re-distributed among the ranks - every rank gets the column ranges of all ranks here
+  if(m_json.HasMember("balance_column_intervals") && m_json["balance_column_intervals"].IsBool())
+    query_config.set_balance_column_intervals(m_json["balance_column_intervals"].GetBool());
+  m_balance_column_intervals_across_ranks = query_config.balance_column_intervals() && !m_scan_whole_array
+    && loader_config == 0 && m_single_workspace_path && m_single_array_name
+    && (m_row_ranges.empty() || m_single_query_row_ranges_vector);
+  if(m_balance_column_intervals_across_ranks)
+  {
+    for(const auto& rank_column_ranges : m_column_ranges)
+      for(const auto& range : rank_column_ranges)
+        query_config.add_column_interval_to_query(range.first, range.second);
+  }
+  else if(!m_scan_whole_array)
   {
     VERIFY_OR_THROW((m_single_query_column_ranges_vector || static_cast<size_t>(rank) < m_column_ranges.size())
         && "Rank >= query column ranges vector size");
@@ -565,6 +725,38 @@ void JSONBasicQueryConfig::read_from_file(const std::string& filename, VariantQu
   }
   //Attributes
   query_config.set_attributes_to_query(m_attributes);
+  //#column intervals scanned in parallel by the scan operators
+  if(m_json.HasMember("num_parallel_column_intervals") && m_json["num_parallel_column_intervals"].IsInt())
+    query_config.set_num_parallel_column_intervals(std::max(1, m_json["num_parallel_column_intervals"].GetInt()));
+  //Split each column interval into num_parallel_column_intervals sub-intervals
+  if(m_json.HasMember("split_column_intervals") && m_json["split_column_intervals"].IsBool())
+    query_config.set_split_column_intervals(m_json["split_column_intervals"].GetBool());
+  //Fetch cells in batches during scans
+  if(m_json.HasMember("cell_batch_size") && m_json["cell_batch_size"].IsInt())
+    query_config.set_cell_batch_size(std::max(0, m_json["cell_batch_size"].GetInt()));
+  //Read ahead batches in a background thread during scans
+  if(m_json.HasMember("prefetch_depth") && m_json["prefetch_depth"].IsInt())
+    query_config.set_prefetch_depth(std::max(0, m_json["prefetch_depth"].GetInt()));
+  //Total size of the read buffers of a scan, sized per attribute
+  if(m_json.HasMember("read_buffer_budget_in_bytes") && m_json["read_buffer_budget_in_bytes"].IsInt64())
+    query_config.set_read_buffer_budget(std::max<int64_t>(0ll, m_json["read_buffer_budget_in_bytes"].GetInt64()));
+  //Serve nearby column intervals from a single scan
+  if(m_json.HasMember("coalesce_column_intervals") && m_json["coalesce_column_intervals"].IsBool())
+    query_config.set_coalesce_column_intervals(m_json["coalesce_column_intervals"].GetBool());
+  if(m_json.HasMember("coalesce_column_intervals_max_gap") && m_json["coalesce_column_intervals_max_gap"].IsInt64())
+    query_config.set_coalesce_column_intervals_max_gap(std::max<int64_t>(0, m_json["coalesce_column_intervals_max_gap"].GetInt64()));
+  //Byte budget of the query result cache
+  if(m_json.HasMember("result_cache_size_in_bytes") && m_json["result_cache_size_in_bytes"].IsInt64())
+    query_config.set_result_cache_size(std::max<int64_t>(0, m_json["result_cache_size_in_bytes"].GetInt64()));
+  //Per-call filter evaluated during the scan
+  if(m_json.HasMember("query_filter"))
+  {
+    VERIFY_OR_THROW(m_json["query_filter"].IsString() && "query_filter must be a string");
+    query_config.set_call_filter_expression(m_json["query_filter"].GetString());
+  }
+  //Fetch site level fields only
+  if(m_json.HasMember("sites_only") && m_json["sites_only"].IsBool())
+    query_config.set_sites_only(m_json["sites_only"].GetBool());
 }
 
 //Loader config functions
@@ -599,6 +791,8 @@ JSONLoaderConfig::JSONLoaderConfig(
   m_callset_mapping_file = "";
   m_segment_size = 10u*1024u*1024u; //10MiB default
   m_num_cells_per_tile = 1024u;
+  m_build_tile_index = false;
+  m_async_tiledb_writes = false;
   m_vid_mapper_file_required = vid_mapper_file_required;
 }
 
@@ -684,6 +878,12 @@ void JSONLoaderConfig::read_from_file(const std::string& filename, FileBasedVidM
   //TileDB array #cells/tile
   if(m_json.HasMember("num_cells_per_tile") && m_json["num_cells_per_tile"].IsInt64())
     m_num_cells_per_tile = m_json["num_cells_per_tile"].GetInt64();
+  //Sidecar tile index - built only when the array is created
+  if(m_json.HasMember("build_tile_index") && m_json["build_tile_index"].IsBool())
+    m_build_tile_index = m_json["build_tile_index"].GetBool();
+  //Compression and disk writes overlap with cell production - uses twice the write buffer memory
+  if(m_json.HasMember("async_tiledb_writes") && m_json["async_tiledb_writes"].IsBool())
+    m_async_tiledb_writes = m_json["async_tiledb_writes"].GetBool();
   //Must have path to vid_mapping_file
   if (m_vid_mapper_file_required) {
     VERIFY_OR_THROW(m_json.HasMember("vid_mapping_file"));
@@ -797,6 +997,19 @@ void JSONVCFAdapterConfig::read_from_file(const std::string& filename,
   auto produce_GT_field = (m_json.HasMember("produce_GT_field") && m_json["produce_GT_field"].GetBool());
   vcf_adapter.initialize(m_reference_genome, m_vcf_header_filename, m_vcf_output_filename, output_format, m_combined_vcf_records_buffer_size_limit,
       produce_GT_field);
+  //Merge adjacent reference block records whose per-sample GQ values fall in the same bands
+  if(m_json.HasMember("gq_bands"))
+  {
+    const rapidjson::Value& GQ_bands_json = m_json["gq_bands"];
+    VERIFY_OR_THROW(GQ_bands_json.IsArray() && "gq_bands must be an array of GQ band boundaries");
+    std::vector<int> GQ_bands(GQ_bands_json.Size());
+    for(rapidjson::SizeType i=0;i<GQ_bands_json.Size();++i)
+    {
+      VERIFY_OR_THROW(GQ_bands_json[i].IsInt() && "gq_bands must be an array of GQ band boundaries");
+      GQ_bands[i] = GQ_bands_json[i].GetInt();
+    }
+    vcf_adapter.set_GQ_bands(GQ_bands);
+  }
 }
 
 void JSONVCFAdapterQueryConfig::read_from_file(const std::string& filename, VariantQueryConfig& query_config,
@@ -805,5 +1018,7 @@ void JSONVCFAdapterQueryConfig::read_from_file(const std::string& filename, Vari
 {
   JSONBasicQueryConfig::read_from_file(filename, query_config, id_mapper, rank);
   JSONVCFAdapterConfig::read_from_file(filename, vcf_adapter, output_format, rank, combined_vcf_records_buffer_size_limit);
+  //GQ bands must not be cut by the boundaries of split column intervals
+  query_config.set_split_at_variant_cells(!vcf_adapter.get_GQ_bands().empty());
 }
 #endif
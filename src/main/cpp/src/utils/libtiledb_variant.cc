@@ -86,7 +86,7 @@ extern "C" void db_query_column(std::string workspace, std::string array_name,
 
 extern "C" void db_query_column_range(std::string workspace, std::string array_name, 
         uint64_t query_interval_idx, std::vector<Variant>& variants, VariantQueryConfig& query_config,
-        const VidMapper& vid_mapper, GA4GHPagingInfo* paging_info) {
+        const VidMapper& vid_mapper, GA4GHPagingInfo* paging_info, VariantPool* variant_pool) {
     // Init Storage Manager object in the Factory class as 
     // both ArrayDescriptor and Query Processor use it 
     Factory f;
@@ -94,7 +94,8 @@ extern "C" void db_query_column_range(std::string workspace, std::string array_n
     //Do book-keeping, if not already done
     if(!query_config.is_bookkeeping_done())
         qp->do_query_bookkeeping(qp->get_array_schema(), query_config, vid_mapper, true);
-    qp->gt_get_column_interval(qp->get_array_descriptor(), query_config, query_interval_idx, variants, paging_info, &f.stats);
+    qp->gt_get_column_interval(qp->get_array_descriptor(), query_config, query_interval_idx, variants, paging_info, &f.stats,
+        variant_pool);
     if(paging_info == 0 || paging_info->is_query_completed())
         f.stats.increment_num_queries();
 }
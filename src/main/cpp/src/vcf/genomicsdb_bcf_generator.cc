@@ -28,13 +28,15 @@ unsigned GenomicsDBBCFGenerator_NUM_ENTRIES_IN_CIRCULAR_BUFFER=1u;
 GenomicsDBBCFGenerator::GenomicsDBBCFGenerator(const std::string& loader_config_file, const std::string& query_config_file,
     const char* chr, const int start, const int end,
     int my_rank, size_t buffer_capacity, size_t tiledb_segment_size, const char* output_format,
-    const bool use_missing_values_only_not_vector_end, const bool keep_idx_fields_in_bcf_header)
+    const bool use_missing_values_only_not_vector_end, const bool keep_idx_fields_in_bcf_header,
+    const std::vector<uint8_t>* checkpoint)
   : m_buffer_control(GenomicsDBBCFGenerator_NUM_ENTRIES_IN_CIRCULAR_BUFFER), m_vcf_adapter(buffer_capacity, false, keep_idx_fields_in_bcf_header)
 #ifdef DO_PROFILING
     , m_timer()
 #endif
 {
   m_done = false;
+  m_buffer_capacity = buffer_capacity;
   //Buffer sizing
   m_buffers.resize(GenomicsDBBCFGenerator_NUM_ENTRIES_IN_CIRCULAR_BUFFER, RWBuffer(buffer_capacity+32768u)); //pad buffer to minimize reallocations
   //Parse loader JSON file
@@ -59,15 +61,63 @@ GenomicsDBBCFGenerator::GenomicsDBBCFGenerator(const std::string& loader_config_
     m_query_config.set_column_interval_to_query(column_begin, column_end);
   }
   m_storage_manager = new VariantStorageManager(static_cast<JSONBasicQueryConfig&>(bcf_scan_config).get_workspace(my_rank), tiledb_segment_size);
-  m_query_processor = new VariantQueryProcessor(m_storage_manager, static_cast<JSONBasicQueryConfig&>(bcf_scan_config).get_array_name(my_rank));
+  //A single process can stream all the column partitions of the workspace
+  if(bcf_scan_config.merge_array_partitions())
+  {
+    m_query_processor = new VariantQueryProcessor(m_storage_manager,
+        static_cast<JSONBasicQueryConfig&>(bcf_scan_config).get_array_names());
+    const auto& partition_column_ranges = bcf_scan_config.get_array_column_partitions();
+    for(auto i=0ull;i<partition_column_ranges.size();++i)
+      m_storage_manager->set_column_partition(m_query_processor->get_partition_array_descriptors()[i],
+          partition_column_ranges[i]);
+    const auto& partition_row_ranges = bcf_scan_config.get_array_row_partitions();
+    for(auto i=0ull;i<partition_row_ranges.size();++i)
+      m_storage_manager->set_row_partition(m_query_processor->get_partition_array_descriptors()[i],
+          partition_row_ranges[i]);
+  }
+  else
+    m_query_processor = new VariantQueryProcessor(m_storage_manager, static_cast<JSONBasicQueryConfig&>(bcf_scan_config).get_array_name(my_rank));
   m_query_processor->do_query_bookkeeping(m_query_processor->get_array_schema(), m_query_config, m_vid_mapper, true);
+  //Split column intervals so that a single large interval can be scanned by multiple threads
+  if(m_query_config.get_num_parallel_column_intervals() > 1u && m_query_config.split_column_intervals()
+      && m_query_config.get_num_column_intervals() > 0u)
+  {
+    VariantQueryConfig split_query_config;
+    m_query_processor->split_column_intervals(m_query_processor->get_array_descriptor(), m_query_config,
+        m_query_config.get_num_parallel_column_intervals(), split_query_config);
+    m_query_config = split_query_config;
+  }
+  //Nearby column intervals are served by a single forward scan - only for sequential scans
+  std::vector<ColumnRange> target_intervals;
+  auto use_coalesced_intervals = (m_query_config.get_num_parallel_column_intervals() <= 1u
+      && m_query_config.coalesce_column_intervals() && m_query_config.get_num_column_intervals() > 1u);
+  if(use_coalesced_intervals)
+  {
+    VariantQueryConfig coalesced_query_config;
+    m_query_config.coalesce_column_intervals(coalesced_query_config, target_intervals);
+    m_query_config = coalesced_query_config;
+  }
   //Must set buffer before constructing BroadCombinedGVCFOperator
   set_write_buffer();
+  //Per thread operators must be constructed before m_combined_bcf_operator modifies the header
+  m_parallel_bcf_operators = (m_query_config.get_num_parallel_column_intervals() > 1u)
+    ? new BroadCombinedGVCFOperatorSet(m_vcf_adapter, m_vid_mapper, m_query_config, m_query_config.get_num_parallel_column_intervals(),
+        bcf_scan_config.get_max_diploid_alt_alleles_that_can_be_genotyped(), use_missing_values_only_not_vector_end)
+    : 0;
   m_combined_bcf_operator = new BroadCombinedGVCFOperator(m_vcf_adapter, m_vid_mapper, m_query_config,
       bcf_scan_config.get_max_diploid_alt_alleles_that_can_be_genotyped(), use_missing_values_only_not_vector_end);
+  m_coalesced_bcf_operator = use_coalesced_intervals ? new CoalescedColumnIntervalsOperator(*m_combined_bcf_operator, target_intervals) : 0;
   m_query_column_interval_idx = 0u;
-  m_query_processor->scan_and_operate(m_query_processor->get_array_descriptor(), m_query_config, *m_combined_bcf_operator, m_query_column_interval_idx,
-      true, &m_scan_state);
+  //Resume from a checkpoint produced by get_checkpoint()
+  if(checkpoint)
+    restore_checkpoint(*checkpoint);
+  if(m_done) //checkpoint taken after the scan completed - nothing to produce
+    reset_read_buffer();
+  else if(m_parallel_bcf_operators)
+    scan_next_column_intervals_in_parallel();
+  else if(!m_scan_state.end()) //if the checkpoint was taken at the end of an interval, produce_next_batch() moves on
+    m_query_processor->scan_and_operate(m_query_processor->get_array_descriptor(), m_query_config, get_scan_operator(),
+        m_query_column_interval_idx, true, &m_scan_state);
 #ifdef DO_PROFILING
   m_timer.stop();
 #endif
@@ -76,9 +126,15 @@ GenomicsDBBCFGenerator::GenomicsDBBCFGenerator(const std::string& loader_config_
 GenomicsDBBCFGenerator::~GenomicsDBBCFGenerator()
 {
   m_buffers.clear();
+  if(m_coalesced_bcf_operator)
+    delete m_coalesced_bcf_operator;
+  m_coalesced_bcf_operator = 0;
   if(m_combined_bcf_operator)
     delete m_combined_bcf_operator;
   m_combined_bcf_operator = 0;
+  if(m_parallel_bcf_operators)
+    delete m_parallel_bcf_operators;
+  m_parallel_bcf_operators = 0;
   if(m_query_processor)
     delete m_query_processor;
   m_query_processor = 0;
@@ -97,11 +153,27 @@ void GenomicsDBBCFGenerator::produce_next_batch()
   auto num_bytes_produced = 0ull;
   while(num_bytes_produced == 0u)
   {
+    if(m_parallel_bcf_operators)
+    {
+      if(m_query_column_interval_idx >= std::max(1u, m_query_config.get_num_column_intervals()))
+      {
+        reset_read_buffer();
+        m_done = true;
+        return;
+      }
+      reset_read_buffer();
+      set_write_buffer();
+      scan_next_column_intervals_in_parallel();
+      num_bytes_produced = m_buffers[m_buffer_control.get_read_idx()].m_num_valid_bytes;
+      continue;
+    }
     if(m_scan_state.end())
     {
       ++m_query_column_interval_idx;
       if(m_query_column_interval_idx >= m_query_config.get_num_column_intervals())
       {
+        if(m_coalesced_bcf_operator)
+          m_coalesced_bcf_operator->finalize();
         reset_read_buffer();
         m_done = true;
         return;
@@ -110,12 +182,70 @@ void GenomicsDBBCFGenerator::produce_next_batch()
     }
     reset_read_buffer();
     set_write_buffer();
-    m_query_processor->scan_and_operate(m_query_processor->get_array_descriptor(), m_query_config, *m_combined_bcf_operator, m_query_column_interval_idx,
+    m_query_processor->scan_and_operate(m_query_processor->get_array_descriptor(), m_query_config, get_scan_operator(), m_query_column_interval_idx,
         true, &m_scan_state);
     num_bytes_produced = m_buffers[m_buffer_control.get_read_idx()].m_num_valid_bytes;
   }
 }
 
+void GenomicsDBBCFGenerator::get_checkpoint(std::vector<uint8_t>& buffer)
+{
+  uint64_t offset = 0ull;
+  //Current interval idx, done flag
+  buffer.resize(sizeof(unsigned)+sizeof(bool));
+  *(reinterpret_cast<unsigned*>(&(buffer[offset]))) = m_query_column_interval_idx;
+  offset += sizeof(unsigned);
+  *(reinterpret_cast<bool*>(&(buffer[offset]))) = m_done;
+  offset += sizeof(bool);
+  //Parallel scans stop only at interval boundaries, sequential scans may stop anywhere within an interval
+  if(!m_parallel_bcf_operators)
+  {
+    m_query_processor->checkpoint_scan_state(m_scan_state, buffer, offset);
+    //Reference block held back for GQ banding
+    m_combined_bcf_operator->checkpoint_pending_record(buffer, offset);
+    //Variants held back by the coalesced scan when the buffer filled up
+    if(m_coalesced_bcf_operator)
+      m_coalesced_bcf_operator->checkpoint_state(buffer, offset);
+  }
+  buffer.resize(offset);
+}
+
+void GenomicsDBBCFGenerator::restore_checkpoint(const std::vector<uint8_t>& buffer)
+{
+  uint64_t offset = 0ull;
+  if(buffer.size() < sizeof(unsigned)+sizeof(bool))
+    throw GenomicsDBJNIException("Truncated GenomicsDBBCFGenerator checkpoint");
+  m_query_column_interval_idx = *(reinterpret_cast<const unsigned*>(&(buffer[offset])));
+  offset += sizeof(unsigned);
+  m_done = *(reinterpret_cast<const bool*>(&(buffer[offset])));
+  offset += sizeof(bool);
+  if(m_query_column_interval_idx > std::max(1u, m_query_config.get_num_column_intervals()))
+    throw GenomicsDBJNIException("Column interval idx "+std::to_string(m_query_column_interval_idx)
+        +" in checkpoint is larger than the number of queried intervals");
+  if(!m_parallel_bcf_operators)
+  {
+    m_query_processor->restore_scan_state(m_query_processor->get_array_descriptor(), m_query_config,
+        m_query_column_interval_idx, buffer, offset, m_scan_state);
+    m_combined_bcf_operator->restore_pending_record(buffer, offset);
+    if(m_coalesced_bcf_operator)
+      m_coalesced_bcf_operator->restore_state(*m_query_processor, m_query_config, buffer, offset);
+  }
+}
+
+void GenomicsDBBCFGenerator::scan_next_column_intervals_in_parallel()
+{
+  assert(m_parallel_bcf_operators);
+  //One interval per thread in each batch - bounds the amount of output held in memory
+  auto end_column_interval_idx = std::min(m_query_column_interval_idx+m_parallel_bcf_operators->get_num_threads(),
+      std::max(1u, m_query_config.get_num_column_intervals()));
+  //Write buffer is the buffer set in set_write_buffer()
+  RWBufferScanOutputWriter output_writer(m_buffers[m_buffer_control.get_read_idx()]);
+  m_query_processor->scan_and_operate_parallel(m_query_processor->get_array_descriptor(), m_query_config,
+      m_parallel_bcf_operators->get_operators(), m_parallel_bcf_operators->get_buffers(), output_writer,
+      m_query_column_interval_idx, end_column_interval_idx, true, m_buffer_capacity);
+  m_query_column_interval_idx = end_column_interval_idx;
+}
+
 size_t GenomicsDBBCFGenerator::read_and_advance(uint8_t* dst, size_t offset, size_t n)
 {
 #ifdef DO_PROFILING
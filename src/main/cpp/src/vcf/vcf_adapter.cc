@@ -24,6 +24,8 @@
 
 #include "vcf_adapter.h"
 #include "vid_mapper.h"
+#include "htslib/bgzf.h"
+#include "htslib/hfile.h"
 
 //ReferenceGenomeInfo functions
 void ReferenceGenomeInfo::initialize(const std::string& reference_genome)
@@ -248,11 +250,36 @@ void VCFAdapter::initialize(const std::string& reference_genome,
     }
   }
   //Reference genome
+  m_reference_genome = reference_genome;
   m_reference_genome_info.initialize(reference_genome);
   m_combined_vcf_records_buffer_size_limit = combined_vcf_records_buffer_size_limit;
   m_produce_GT_field = produce_GT_field;
 }
 
+void VCFAdapter::initialize(const VCFAdapter& other)
+{
+  assert(other.m_template_vcf_hdr);
+  m_vcf_header_filename = other.m_vcf_header_filename;
+  if(m_template_vcf_hdr)
+    bcf_hdr_destroy(m_template_vcf_hdr);
+  m_template_vcf_hdr = bcf_hdr_dup(other.m_template_vcf_hdr);
+  m_is_bcf = other.m_is_bcf;
+  //Output file is owned by other, don't open it again
+  m_output_filename = other.m_output_filename;
+  m_reference_genome = other.m_reference_genome;
+  m_reference_genome_info.initialize(m_reference_genome);
+  m_combined_vcf_records_buffer_size_limit = other.m_combined_vcf_records_buffer_size_limit;
+  m_produce_GT_field = other.m_produce_GT_field;
+  m_GQ_bands = other.m_GQ_bands;
+}
+
+void VCFAdapter::set_GQ_bands(const std::vector<int>& GQ_bands)
+{
+  m_GQ_bands = GQ_bands;
+  std::sort(m_GQ_bands.begin(), m_GQ_bands.end());
+  m_GQ_bands.erase(std::unique(m_GQ_bands.begin(), m_GQ_bands.end()), m_GQ_bands.end());
+}
+
 bcf_hdr_t* VCFAdapter::initialize_default_header()
 {
   auto hdr = bcf_hdr_init("w");
@@ -267,6 +294,17 @@ void VCFAdapter::print_header()
   bcf_hdr_write(m_output_fptr, m_template_vcf_hdr);
 }
 
+void VCFAdapter::write_serialized_buffer(const uint8_t* data, const size_t num_bytes)
+{
+  assert(m_output_fptr);
+  //BCF and compressed VCF outputs are BGZF streams, uncompressed VCF is a plain file
+  auto write_size = (m_is_bcf || m_output_fptr->format.compression != no_compression)
+    ? bgzf_write(m_output_fptr->fp.bgzf, data, num_bytes)
+    : hwrite(m_output_fptr->fp.hfile, data, num_bytes);
+  if(write_size < 0 || static_cast<size_t>(write_size) != num_bytes)
+    throw VCFAdapterException(std::string("Failed to write serialized VCF/BCF records to ")+m_output_filename);
+}
+
 void VCFAdapter::handoff_output_bcf_line(bcf1_t*& line, const size_t bcf_record_size)
 {
   auto write_status = bcf_write(m_output_fptr, m_template_vcf_hdr, line);
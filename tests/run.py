@@ -45,7 +45,23 @@ def create_query_json(ws_dir, test_name, query_param_dict):
     test_dict=json.loads(query_json_template_string);
     test_dict["workspace"] = ws_dir
     test_dict["array"] = test_name
-    test_dict["query_column_ranges"] = [ [ query_param_dict["query_column_ranges"] ] ]
+    #All the arrays (partitions) of the loader are merged
+    if("merge_array_partitions" in query_param_dict):
+        del test_dict["array"]
+        test_dict["merge_array_partitions"] = query_param_dict["merge_array_partitions"]
+    #BED file, single interval [begin, end] or a list of intervals
+    if("query_column_ranges_bed_file" in query_param_dict):
+        del test_dict["query_column_ranges"]
+        test_dict["query_column_ranges_bed_file"] = query_param_dict["query_column_ranges_bed_file"]
+    elif(isinstance(query_param_dict["query_column_ranges"][0], list)):
+        test_dict["query_column_ranges"] = [ query_param_dict["query_column_ranges"] ]
+    else:
+        test_dict["query_column_ranges"] = [ [ query_param_dict["query_column_ranges"] ] ]
+    for key in [ "coalesce_column_intervals", "coalesce_column_intervals_max_gap", "query_filter", "gq_bands",
+            "num_parallel_column_intervals", "split_column_intervals", "sites_only", "balance_column_intervals",
+            "prefetch_depth", "cell_batch_size", "read_buffer_budget_in_bytes", "scan_partitions_in_threads" ]:
+        if(key in query_param_dict):
+            test_dict[key] = query_param_dict[key]
     if("vid_mapping_file" in query_param_dict):
         test_dict["vid_mapping_file"] = query_param_dict["vid_mapping_file"];
     if("callset_mapping_file" in query_param_dict):
@@ -81,11 +97,23 @@ def create_loader_json(ws_dir, test_name, test_params_dict):
     test_dict=json.loads(loader_json_template_string);
     if('column_partitions' in test_params_dict):
         test_dict['column_partitions'] = test_params_dict['column_partitions'];
-    test_dict["column_partitions"][0]["workspace"] = ws_dir;
-    test_dict["column_partitions"][0]["array"] = test_name;
+    #Row partitions replace the column partitions - the combined gVCF cannot be produced with row partitions
+    if('row_partitions' in test_params_dict):
+        del test_dict['column_partitions'];
+        test_dict['row_based_partitioning'] = True;
+        test_dict['row_partitions'] = test_params_dict['row_partitions'];
+        test_dict['produce_combined_vcf'] = False;
+    partitions = test_dict['row_partitions'] if test_dict['row_based_partitioning'] else test_dict['column_partitions'];
+    #Partition i > 0 is stored in array <test_name>_<i>
+    for partition_idx,partition in enumerate(partitions):
+        partition["workspace"] = ws_dir;
+        partition["array"] = test_name if partition_idx == 0 else test_name+'_'+str(partition_idx);
     test_dict["callset_mapping_file"] = test_params_dict['callset_mapping_file'];
     if('vid_mapping_file' in test_params_dict):
         test_dict['vid_mapping_file'] = test_params_dict['vid_mapping_file'];
+    for key in [ "build_tile_index", "ub_callset_row_idx" ]:
+        if(key in test_params_dict):
+            test_dict[key] = test_params_dict[key]
     return test_dict;
 
 def get_file_content_and_md5sum(filename):
@@ -102,6 +130,9 @@ def print_diff(golden_output, test_output):
     print(test_output);
     print("=======END=======");
 
+def get_vcf_records(vcf_string):
+    return [ line for line in vcf_string.splitlines() if not line.startswith('#') ];
+
 def cleanup_and_exit(tmpdir, exit_code):
     if(exit_code == 0):
         shutil.rmtree(tmpdir, ignore_errors=True)
@@ -147,6 +178,103 @@ def main():
                         "vcf"        : "golden_outputs/t0_1_2_vcf_at_12150",
                         "batched_vcf": "golden_outputs/t0_1_2_vcf_at_12150",
                         "java_vcf"   : "golden_outputs/java_t0_1_2_vcf_at_12150",
+                        } },
+                    #Reference blocks span the begin of the second interval - the BCF generator reuses its
+                    #scan state across intervals, its records must match the ones produced by gt_mpi_gather
+                    { "query_column_ranges" : [ [0, 12149], [12150, 1000000000] ],
+                        "query_types": [ "vcf", "bcf_generator_vcf" ],
+                        "records_must_match": [ "vcf", "bcf_generator_vcf" ] },
+                    { "query_column_ranges" : [ [12140, 12150], [12200, 12299], [17384, 17384] ],
+                        "query_types": [ "vcf", "bcf_generator_vcf" ] },
+                    #Same targets from a BED file, scanned as a single coalesced interval
+                    { "query_column_ranges_bed_file" : "inputs/t0_1_2_targets.bed",
+                        "coalesce_column_intervals": True, "coalesce_column_intervals_max_gap": 100000,
+                        "query_types": [ "vcf", "bcf_generator_vcf" ],
+                        "records_must_match_query": 4 },
+                    { "query_column_ranges" : [0, 1000000000],
+                        "query_attributes": [ field for field in vcf_query_attributes_order if field != "GQ" ],
+                        "query_types": [ "vcf", "bcf_generator_vcf" ] },
+                    #Every call has GQ >= 0 - GQ is fetched only for the filter and must not be in the output
+                    { "query_column_ranges" : [0, 1000000000],
+                        "query_attributes": [ field for field in vcf_query_attributes_order if field != "GQ" ],
+                        "query_filter": "GQ >= 0",
+                        "query_types": [ "vcf", "bcf_generator_vcf" ],
+                        "records_must_match_query": 6 },
+                    #Selective filter - the reference blocks at 12140 and 12144 (GQ 0) are dropped
+                    { "query_column_ranges" : [0, 1000000000],
+                        "query_filter": "GQ > 20",
+                        "query_types": [ "calls" ],
+                        "golden_output": {
+                        "calls"      : "golden_outputs/t0_1_2_calls_GQ_gt_20_at_0",
+                        } },
+                    #Sites-only - no FORMAT and sample columns, DP is the sum of the INFO DP values
+                    { "query_column_ranges" : [0, 1000000000], "sites_only": True,
+                        "query_types": [ "vcf", "batched_vcf" ],
+                        "golden_output": {
+                        "vcf"        : "golden_outputs/t0_1_2_sites_only_vcf_at_0",
+                        "batched_vcf": "golden_outputs/t0_1_2_sites_only_vcf_at_0",
+                        } },
+                    #Checkpoint after every page and resume - the records must match the uninterrupted stream
+                    { "query_column_ranges" : [0, 1000000000],
+                        "query_types": [ "vcf", "bcf_generator_checkpoint_vcf" ],
+                        "records_must_match": [ "vcf", "bcf_generator_checkpoint_vcf" ],
+                        "golden_output": {
+                        "vcf"        : "golden_outputs/t0_1_2_vcf_at_0",
+                        } },
+                    #Coalesced scan - Variants held back on overflow are part of the checkpoint
+                    { "query_column_ranges_bed_file" : "inputs/t0_1_2_targets.bed",
+                        "coalesce_column_intervals": True, "coalesce_column_intervals_max_gap": 100000,
+                        "query_types": [ "bcf_generator_vcf", "bcf_generator_checkpoint_vcf" ],
+                        "records_must_match": [ "bcf_generator_vcf", "bcf_generator_checkpoint_vcf" ] },
+                    #Column intervals balanced across ranks (a single rank without mpirun gets the whole interval)
+                    { "query_column_ranges" : [0, 1000000000],
+                        "query_without_loader": True,
+                        "vid_mapping_file": "inputs/vid.json",
+                        "callset_mapping_file": "inputs/callsets/t0_1_2.json",
+                        "balance_column_intervals": True,
+                        "query_types": [ "calls", "variants", "vcf" ],
+                        "golden_output": {
+                        "calls"      : "golden_outputs/t0_1_2_calls_at_0",
+                        "variants"   : "golden_outputs/t0_1_2_variants_at_0",
+                        "vcf"        : "golden_outputs/t0_1_2_vcf_at_0",
+                        } },
+                    #Small cell batches prefetched by the background thread - batches end within reference blocks
+                    { "query_column_ranges" : [0, 1000000000], "prefetch_depth": 2, "cell_batch_size": 2,
+                        "query_types": [ "calls", "variants", "vcf", "batched_vcf" ],
+                        "golden_output": {
+                        "calls"      : "golden_outputs/t0_1_2_calls_at_0",
+                        "variants"   : "golden_outputs/t0_1_2_variants_at_0",
+                        "vcf"        : "golden_outputs/t0_1_2_vcf_at_0",
+                        "batched_vcf": "golden_outputs/t0_1_2_vcf_at_0",
+                        } },
+                    { "query_column_ranges" : [12150, 1000000000], "prefetch_depth": 4, "cell_batch_size": 1,
+                        "query_types": [ "calls", "variants", "vcf", "batched_vcf" ],
+                        "golden_output": {
+                        "calls"      : "golden_outputs/t0_1_2_calls_at_12150",
+                        "variants"   : "golden_outputs/t0_1_2_variants_at_12150",
+                        "vcf"        : "golden_outputs/t0_1_2_vcf_at_12150",
+                        "batched_vcf": "golden_outputs/t0_1_2_vcf_at_12150",
+                        } },
+                    #Variants of the first interval are handed back to the VariantPool and reused by the second
+                    { "query_column_ranges" : [ [0, 1000000000], [12150, 1000000000] ],
+                        "query_types": [ "variants" ],
+                        "golden_output": {
+                        "variants"   : "golden_outputs/t0_1_2_variants_at_0_and_12150",
+                        } },
+                    #Read buffers sized per attribute - the smallest budget gives every buffer its minimum size
+                    { "query_column_ranges" : [0, 1000000000], "read_buffer_budget_in_bytes": 1,
+                        "query_types": [ "calls", "variants", "vcf" ],
+                        "golden_output": {
+                        "calls"      : "golden_outputs/t0_1_2_calls_at_0",
+                        "variants"   : "golden_outputs/t0_1_2_variants_at_0",
+                        "vcf"        : "golden_outputs/t0_1_2_vcf_at_0",
+                        } },
+                    { "query_column_ranges" : [12150, 1000000000], "read_buffer_budget_in_bytes": 4194304,
+                        "query_types": [ "calls", "variants", "vcf" ],
+                        "golden_output": {
+                        "calls"      : "golden_outputs/t0_1_2_calls_at_12150",
+                        "variants"   : "golden_outputs/t0_1_2_variants_at_12150",
+                        "vcf"        : "golden_outputs/t0_1_2_vcf_at_12150",
                         } }
                     ]
             },
@@ -169,6 +297,76 @@ def main():
                         } }
                     ]
             },
+            #Sidecar tile index - queries seek to the first tile with data and bound the left sweep with the index
+            { "name" : "t0_1_2_tile_index", 'golden_output' : 'golden_outputs/t0_1_2_loading',
+                'callset_mapping_file': 'inputs/callsets/t0_1_2.json',
+                'build_tile_index': True,
+                "query_params": [
+                    { "query_column_ranges" : [0, 1000000000], "golden_output": {
+                        "calls"      : "golden_outputs/t0_1_2_calls_at_0",
+                        "variants"   : "golden_outputs/t0_1_2_variants_at_0",
+                        "vcf"        : "golden_outputs/t0_1_2_vcf_at_0",
+                        "batched_vcf": "golden_outputs/t0_1_2_vcf_at_0",
+                        } },
+                    { "query_column_ranges" : [12150, 1000000000], "golden_output": {
+                        "calls"      : "golden_outputs/t0_1_2_calls_at_12150",
+                        "variants"   : "golden_outputs/t0_1_2_variants_at_12150",
+                        "vcf"        : "golden_outputs/t0_1_2_vcf_at_12150",
+                        "batched_vcf": "golden_outputs/t0_1_2_vcf_at_12150",
+                        } }
+                    ]
+            },
+            #Query result cache - hit and miss, then invalidation by an incremental load of the append callsets
+            { "name" : "t0_1_2_result_cache", 'golden_output' : 'golden_outputs/t0_1_2_loading',
+                'callset_mapping_file': 'inputs/callsets/t0_1_2.json',
+                'append_callset_mapping_file': 'inputs/callsets/t6_7_8.json'
+            },
+            #Row 0 and rows 1-2 loaded as separate fragments - queries must not change after consolidation
+            { "name" : "t0_1_2_fragments",
+                'callset_mapping_file': 'inputs/callsets/t0_1_2.json',
+                'ub_callset_row_idx': 0,
+                'append_lb_callset_row_idx': 1,
+                "query_params": [
+                    { "query_column_ranges" : [0, 1000000000],
+                        "query_types": [ "calls", "variants", "vcf" ],
+                        "golden_output": {
+                        "calls"      : "golden_outputs/t0_1_2_calls_at_0",
+                        "variants"   : "golden_outputs/t0_1_2_variants_at_0",
+                        "vcf"        : "golden_outputs/t0_1_2_vcf_at_0",
+                        }
+                    },
+                    { "query_column_ranges" : [0, 1000000000], "consolidate_before_query": True,
+                        "query_types": [ "calls", "variants", "vcf" ],
+                        "records_must_match_query": 0,
+                        "golden_output": {
+                        "calls"      : "golden_outputs/t0_1_2_calls_at_0",
+                        "variants"   : "golden_outputs/t0_1_2_variants_at_0",
+                        "vcf"        : "golden_outputs/t0_1_2_vcf_at_0",
+                        }
+                    }
+                ]
+            },
+            #Adjacent reference blocks - the first two blocks of HG00141 fall in the same GQ band
+            { "name" : "t0_1_2_gq_bands_csv",
+                'callset_mapping_file': 'inputs/callsets/t0_1_2_gq_bands_csv.json',
+                "query_params": [
+                    { "query_column_ranges" : [0, 1000000000], "gq_bands": [5, 20, 60],
+                        "query_types": [ "vcf", "batched_vcf", "bcf_generator_vcf" ],
+                        "records_must_match": [ "vcf", "bcf_generator_vcf" ],
+                        "golden_output": {
+                        "vcf"        : "golden_outputs/t0_1_2_gq_bands_vcf_at_0",
+                        "batched_vcf": "golden_outputs/t0_1_2_gq_bands_vcf_at_0",
+                        } },
+                    #Split intervals must not cut bands
+                    { "query_column_ranges" : [12140, 12169], "gq_bands": [5, 20, 60],
+                        "num_parallel_column_intervals": 3, "split_column_intervals": True,
+                        "query_types": [ "vcf", "bcf_generator_vcf" ],
+                        "records_must_match": [ "vcf", "bcf_generator_vcf" ],
+                        "golden_output": {
+                        "vcf"        : "golden_outputs/t0_1_2_gq_bands_vcf_at_0",
+                        } }
+                    ]
+            },
             { "name" : "t0_overlapping", 'golden_output': 'golden_outputs/t0_overlapping',
                 'callset_mapping_file': 'inputs/callsets/t0_overlapping.json',
                 "query_params": [
@@ -178,6 +376,37 @@ def main():
                     }
                 ]
             },
+            { "name" : "t0_1_2_column_partitions",
+                'callset_mapping_file': 'inputs/callsets/t0_1_2.json',
+                'column_partitions': [ {"begin": 0, "workspace":"", "array": "" },
+                    {"begin": 12150, "workspace":"", "array": "" } ],
+                "query_params": [
+                    { "query_column_ranges" : [0, 1000000000], "merge_array_partitions": True,
+                        "query_types": [ "calls", "variants", "vcf" ],
+                        "golden_output": {
+                        "calls"      : "golden_outputs/t0_1_2_calls_at_0",
+                        "variants"   : "golden_outputs/t0_1_2_variants_at_0",
+                        "vcf"        : "golden_outputs/t0_1_2_vcf_at_0",
+                        }
+                    }
+                ]
+            },
+            { "name" : "t0_1_2_row_partitions",
+                'callset_mapping_file': 'inputs/callsets/t0_1_2.json',
+                'row_partitions': [ {"begin": 0, "workspace":"", "array": "" },
+                    {"begin": 2, "workspace":"", "array": "" } ],
+                "query_params": [
+                    { "query_column_ranges" : [0, 1000000000], "merge_array_partitions": True,
+                        "scan_partitions_in_threads": True,
+                        "query_types": [ "calls", "variants", "vcf" ],
+                        "golden_output": {
+                        "calls"      : "golden_outputs/t0_1_2_calls_at_0",
+                        "variants"   : "golden_outputs/t0_1_2_variants_at_0",
+                        "vcf"        : "golden_outputs/t0_1_2_vcf_at_0",
+                        }
+                    }
+                ]
+            },
             { "name" : "t0_overlapping_at_12202", 'golden_output': 'golden_outputs/t0_overlapping_at_12202',
                 'callset_mapping_file': 'inputs/callsets/t0_overlapping.json',
                 'column_partitions': [ {"begin": 12202, "workspace":"", "array": "" }]
@@ -293,6 +522,18 @@ def main():
             pid = subprocess.Popen('java TestBufferStreamGenomicsDBImporter '+loader_json_filename
                     +' '+test_params_dict['stream_name_to_filename_mapping'],
                     shell=True, stdout=subprocess.PIPE);
+        elif(len(test_loader_dict.get('row_partitions', test_loader_dict.get('column_partitions'))) > 1):
+            #Without MPI, every partition is loaded by its own process
+            for partition_idx in range(1, len(test_loader_dict.get('row_partitions',
+                    test_loader_dict.get('column_partitions')))):
+                pid = subprocess.Popen(exe_path+os.path.sep+'vcf2tiledb -r %d '%(partition_idx)+loader_json_filename,
+                        shell=True, stdout=subprocess.PIPE);
+                pid.communicate()
+                if(pid.returncode != 0):
+                    sys.stderr.write('Loader test: '+test_name+' partition '+str(partition_idx)+' failed\n');
+                    cleanup_and_exit(tmpdir, -1);
+            pid = subprocess.Popen(exe_path+os.path.sep+'vcf2tiledb -r 0 '+loader_json_filename, shell=True,
+                    stdout=subprocess.PIPE);
         else:
             pid = subprocess.Popen(exe_path+os.path.sep+'vcf2tiledb '+loader_json_filename, shell=True,
                     stdout=subprocess.PIPE);
@@ -307,8 +548,54 @@ def main():
                 sys.stderr.write('Loader stdout mismatch for test: '+test_name+'\n');
                 print_diff(golden_stdout, stdout_string);
                 cleanup_and_exit(tmpdir, -1);
+        if('append_callset_mapping_file' in test_params_dict):
+            append_loader_dict = create_loader_json(ws_dir, test_name, test_params_dict);
+            append_loader_dict['callset_mapping_file'] = test_params_dict['append_callset_mapping_file'];
+            append_loader_dict['delete_and_create_tiledb_array'] = False;
+            append_loader_dict['produce_combined_vcf'] = False;
+            append_loader_dict['segment_size'] = load_segment_size;
+            append_loader_json_filename = tmpdir+os.path.sep+test_name+'_append.json'
+            with open(append_loader_json_filename, 'wb') as fptr:
+                json.dump(append_loader_dict, fptr, indent=4, separators=(',', ': '));
+                fptr.close();
+            pid = subprocess.Popen(exe_path+os.path.sep+'test_variant_query_result_cache -V '
+                    +append_loader_dict['vid_mapping_file']+' -l '+append_loader_json_filename
+                    +' '+ws_dir+' '+test_name+' 0 1000000000', shell=True, stdout=subprocess.PIPE);
+            pid.communicate()
+            if(pid.returncode != 0):
+                sys.stderr.write('Query result cache test: '+test_name+' failed\n');
+                cleanup_and_exit(tmpdir, -1);
+        #Rows >= append_lb_callset_row_idx are loaded as a second fragment
+        if('append_lb_callset_row_idx' in test_params_dict):
+            append_loader_dict = create_loader_json(ws_dir, test_name, test_params_dict);
+            del append_loader_dict['ub_callset_row_idx'];
+            append_loader_dict['lb_callset_row_idx'] = test_params_dict['append_lb_callset_row_idx'];
+            append_loader_dict['delete_and_create_tiledb_array'] = False;
+            append_loader_dict['produce_combined_vcf'] = False;
+            append_loader_dict['segment_size'] = load_segment_size;
+            append_loader_json_filename = tmpdir+os.path.sep+test_name+'_append.json'
+            with open(append_loader_json_filename, 'wb') as fptr:
+                json.dump(append_loader_dict, fptr, indent=4, separators=(',', ': '));
+                fptr.close();
+            pid = subprocess.Popen(exe_path+os.path.sep+'vcf2tiledb '+append_loader_json_filename, shell=True,
+                    stdout=subprocess.PIPE);
+            pid.communicate()
+            if(pid.returncode != 0):
+                sys.stderr.write('Loader test: '+test_name+' append failed\n');
+                cleanup_and_exit(tmpdir, -1);
         if('query_params' in test_params_dict):
+            all_query_outputs = []
             for query_param_dict in test_params_dict['query_params']:
+                #Fragments are merged before the query - the array must have had several fragments and must be
+                #left with one
+                if('consolidate_before_query' in query_param_dict and query_param_dict['consolidate_before_query']):
+                    pid = subprocess.Popen(exe_path+os.path.sep+'consolidate_tiledb_array '+ws_dir+' '+test_name,
+                            shell=True, stderr=subprocess.PIPE);
+                    stderr_string = pid.communicate()[1]
+                    if(pid.returncode != 0 or 'Consolidated array' not in stderr_string
+                            or not stderr_string.rstrip().endswith('#fragments 1')):
+                        sys.stderr.write('Consolidation test: '+test_name+' failed\n'+stderr_string);
+                        cleanup_and_exit(tmpdir, -1);
                 test_query_dict = create_query_json(ws_dir, test_name, query_param_dict)
                 query_types_list = [
                         ('calls','--print-calls'),
@@ -316,10 +603,21 @@ def main():
                         ('vcf','--produce-Broad-GVCF'),
                         ('batched_vcf','--produce-Broad-GVCF -p 128'),
                         ('java_vcf', ''),
+                        ('bcf_generator_vcf', '-p 1024'),
+                        ('bcf_generator_checkpoint_vcf', '-p 256 -c'),
                         ]
+                if('query_types' in query_param_dict):
+                    query_types_list = [ (query_type,cmd_line_param) for query_type,cmd_line_param in query_types_list
+                            if query_type in query_param_dict['query_types'] ]
+                else:
+                    query_types_list = [ (query_type,cmd_line_param) for query_type,cmd_line_param in query_types_list
+                            if query_type not in [ 'bcf_generator_vcf', 'bcf_generator_checkpoint_vcf' ] ]
+                query_outputs = {}
                 for query_type,cmd_line_param in query_types_list:
-                    if(query_type == 'vcf' or query_type == 'batched_vcf' or query_type == 'java_vcf'):
-                        test_query_dict['query_attributes'] = vcf_query_attributes_order;
+                    if(query_type == 'vcf' or query_type == 'batched_vcf' or query_type == 'java_vcf'
+                            or query_type == 'bcf_generator_vcf' or query_type == 'bcf_generator_checkpoint_vcf'):
+                        test_query_dict['query_attributes'] = query_param_dict.get('query_attributes',
+                                vcf_query_attributes_order);
                     query_json_filename = tmpdir+os.path.sep+test_name+'_'+query_type+'.json'
                     with open(query_json_filename, 'wb') as fptr:
                         json.dump(test_query_dict, fptr, indent=4, separators=(',', ': '));
@@ -330,6 +628,9 @@ def main():
                             loader_argument = '""'
                         pid = subprocess.Popen('java TestGenomicsDB -query '+loader_argument+' '+query_json_filename,
                                 shell=True, stdout=subprocess.PIPE);
+                    elif(query_type == 'bcf_generator_vcf' or query_type == 'bcf_generator_checkpoint_vcf'):
+                        pid = subprocess.Popen(exe_path+os.path.sep+'test_genomicsdb_bcf_generator -l '+loader_json_filename
+                                +' -j '+query_json_filename+' '+cmd_line_param, shell=True, stdout=subprocess.PIPE);
                     else:
                         loader_argument = ' -l '+loader_json_filename;
                         if("query_without_loader" in query_param_dict and query_param_dict["query_without_loader"]):
@@ -342,6 +643,7 @@ def main():
                     if(pid.returncode != 0):
                         sys.stderr.write('Query test: '+test_name+'-'+query_type+' failed\n');
                         cleanup_and_exit(tmpdir, -1);
+                    query_outputs[query_type] = stdout_string;
                     md5sum_hash_str = str(hashlib.md5(stdout_string).hexdigest())
                     if('golden_output' in query_param_dict and query_type in query_param_dict['golden_output']):
                         golden_stdout, golden_md5sum = get_file_content_and_md5sum(query_param_dict['golden_output'][query_type]);
@@ -349,6 +651,63 @@ def main():
                             sys.stderr.write('Mismatch in query test: '+test_name+'-'+query_type+'\n');
                             print_diff(golden_stdout, stdout_string);
                             cleanup_and_exit(tmpdir, -1);
+                #Query types whose records (header excluded) must be identical
+                if('records_must_match' in query_param_dict):
+                    first_query_type = query_param_dict['records_must_match'][0];
+                    for query_type in query_param_dict['records_must_match'][1:]:
+                        if(get_vcf_records(query_outputs[first_query_type]) != get_vcf_records(query_outputs[query_type])):
+                            sys.stderr.write('Mismatch in query test: '+test_name+'-'+first_query_type+' vs '+query_type+'\n');
+                            print_diff(query_outputs[first_query_type], query_outputs[query_type]);
+                            cleanup_and_exit(tmpdir, -1);
+                #Records must match those of an earlier query (index into query_params) for every query type
+                if('records_must_match_query' in query_param_dict):
+                    other_query_outputs = all_query_outputs[query_param_dict['records_must_match_query']];
+                    for query_type in query_outputs:
+                        if(get_vcf_records(other_query_outputs[query_type]) != get_vcf_records(query_outputs[query_type])):
+                            sys.stderr.write('Mismatch in query test: '+test_name+'-'+query_type+' vs query '
+                                    +str(query_param_dict['records_must_match_query'])+'\n');
+                            print_diff(other_query_outputs[query_type], query_outputs[query_type]);
+                            cleanup_and_exit(tmpdir, -1);
+                all_query_outputs.append(query_outputs);
+        #Load again with TileDB writes in a background thread - the calls in the two arrays must be identical
+        if(not test_name.startswith('java') and 'append_callset_mapping_file' not in test_params_dict
+                and 'append_lb_callset_row_idx' not in test_params_dict and len(test_loader_dict.get('column_partitions', [])) == 1):
+            async_test_name = test_name+'_async'
+            async_loader_dict = create_loader_json(ws_dir, async_test_name, test_params_dict);
+            async_loader_dict['compress_tiledb_array'] = test_loader_dict['compress_tiledb_array'];
+            async_loader_dict['segment_size'] = load_segment_size;
+            async_loader_dict['produce_combined_vcf'] = False;
+            async_loader_dict['async_tiledb_writes'] = True;
+            async_loader_json_filename = tmpdir+os.path.sep+async_test_name+'.json'
+            with open(async_loader_json_filename, 'wb') as fptr:
+                json.dump(async_loader_dict, fptr, indent=4, separators=(',', ': '));
+                fptr.close();
+            pid = subprocess.Popen(exe_path+os.path.sep+'vcf2tiledb '+async_loader_json_filename, shell=True,
+                    stdout=subprocess.PIPE);
+            pid.communicate()
+            if(pid.returncode != 0):
+                sys.stderr.write('Loader test with async TileDB writes: '+test_name+' failed\n');
+                cleanup_and_exit(tmpdir, -1);
+            calls_outputs = []
+            for array_test_name,array_loader_json_filename in [ (test_name, loader_json_filename),
+                    (async_test_name, async_loader_json_filename) ]:
+                calls_query_dict = create_query_json(ws_dir, array_test_name, { "query_column_ranges" : [0, 1000000000] });
+                del calls_query_dict['query_row_ranges'];
+                calls_query_json_filename = tmpdir+os.path.sep+array_test_name+'_all_calls.json'
+                with open(calls_query_json_filename, 'wb') as fptr:
+                    json.dump(calls_query_dict, fptr, indent=4, separators=(',', ': '));
+                    fptr.close();
+                pid = subprocess.Popen((exe_path+os.path.sep+'gt_mpi_gather -s %d -l '+array_loader_json_filename
+                    +' -j '+calls_query_json_filename+' --print-calls')%(segment_size), shell=True,
+                    stdout=subprocess.PIPE);
+                calls_outputs.append(pid.communicate()[0]);
+                if(pid.returncode != 0):
+                    sys.stderr.write('Query test: '+array_test_name+'-calls failed\n');
+                    cleanup_and_exit(tmpdir, -1);
+            if(calls_outputs[0] != calls_outputs[1]):
+                sys.stderr.write('Mismatch in query test: '+test_name+'-calls vs load with async TileDB writes\n');
+                print_diff(calls_outputs[0], calls_outputs[1]);
+                cleanup_and_exit(tmpdir, -1);
     coverage_file='coverage.info'
     subprocess.call('lcov --directory ../ --capture --output-file '+coverage_file, shell=True);
     #Remove protocol buffer generated files from the coverage information
@@ -0,0 +1,83 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+ * Merges the fragments left by incremental loads (mode "a") of arrays in a workspace into a single fragment
+ * per array. With -c, only prints the #fragments in every array
+ */
+
+#include <iostream>
+#include <getopt.h>
+#include "variant_storage_manager.h"
+
+int main(int argc, char** argv)
+{
+  static struct option long_options[] =
+  {
+    {"count-only",0,0,'c'},
+    {0,0,0,0},
+  };
+  auto count_only = false;
+  int c;
+  while((c=getopt_long(argc, argv, "c", long_options, NULL)) >= 0)
+  {
+    switch(c)
+    {
+      case 'c':
+        count_only = true;
+        break;
+      default:
+        std::cerr << "Usage: "<<argv[0]<<" [-c] <workspace_directory> <array_name> [<array_name> ...]\n";
+        return -1;
+    }
+  }
+  if(optind+2 > argc)
+  {
+    std::cerr << "Usage: "<<argv[0]<<" [-c] <workspace_directory> <array_name> [<array_name> ...]\n";
+    return -1;
+  }
+  std::string workspace = argv[optind];
+  int returnval = 0;
+  VariantStorageManager sm(workspace);
+  for(auto i=optind+1;i<argc;++i)
+  {
+    std::string array_name = argv[i];
+    auto num_fragments = sm.get_num_fragments(array_name);
+    if(num_fragments < 0)
+    {
+      std::cerr << "Could not read array "<<workspace<<'/'<<array_name<<"\n";
+      returnval = -1;
+      continue;
+    }
+    std::cerr << "Array "<<array_name<<" #fragments "<<num_fragments<<"\n";
+    if(count_only || num_fragments <= 1)
+      continue;
+    if(sm.consolidate_array(array_name) != TILEDB_OK)
+    {
+      std::cerr << "Failed to consolidate array "<<workspace<<'/'<<array_name<<"\n";
+      returnval = -1;
+      continue;
+    }
+    std::cerr << "Consolidated array "<<array_name<<" #fragments "<<sm.get_num_fragments(array_name)<<"\n";
+  }
+  return returnval;
+}
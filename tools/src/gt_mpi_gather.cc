@@ -88,7 +88,8 @@ auto g_timer_names = std::vector<std::string>
 
 //id_mapper could be NULL - use for contig/callset name mapping only if non-NULL
 void run_range_query(const VariantQueryProcessor& qp, const VariantQueryConfig& query_config, const VidMapper& id_mapper,
-    const std::string& output_format, const bool is_partitioned_by_column, int num_mpi_processes, int my_world_mpi_rank, bool skip_query_on_root)
+    const std::string& output_format, const bool is_partitioned_by_column, int num_mpi_processes, int my_world_mpi_rank, bool skip_query_on_root,
+    const bool has_column_intervals)
 {
   //Check if id_mapper is initialized before using it
   //if(id_mapper.is_initialized())
@@ -103,46 +104,59 @@ void run_range_query(const VariantQueryProcessor& qp, const VariantQueryConfig&
 #endif
   //Variants vector
   std::vector<Variant> variants;
-  uint64_t num_column_intervals = query_config.get_num_column_intervals();
+  //Ranks without a share of the balanced column intervals do not query, but take part in the gathers
+  uint64_t num_column_intervals = has_column_intervals ? query_config.get_num_column_intervals() : 0ull;
   std::vector<uint64_t> queried_column_positions(num_column_intervals * 2, 0ull);
   std::vector<uint64_t> query_column_lengths(num_column_intervals, 0ull);
+  //serialized variant data
+  std::vector<uint8_t> serialized_buffer;
+  serialized_buffer.resize(1000000u);       //1MB, arbitrary value - will be resized if necessary by serialization functions
+  uint64_t serialized_length = 0ull;
+  uint64_t num_variants = 0ull;
   //Perform query if not root or !skip_query_on_root
-  if(my_world_mpi_rank != 0 || !skip_query_on_root)
+  if(has_column_intervals && (my_world_mpi_rank != 0 || !skip_query_on_root))
   {
 #ifdef DO_PROFILING
     timer.start();
+    Timer serialization_timer;
 #endif
-    for(auto i=0u;i<query_config.get_num_column_intervals();++i) {
-      qp.gt_get_column_interval(qp.get_array_descriptor(), query_config, i, variants, 0, stats_ptr);
-      query_column_lengths[i] = variants.size();
+    //Variants of an interval are serialized and handed back to the pool before the next interval is queried
+    VariantPool variant_pool;
+    for(auto i=0u;i<num_column_intervals;++i) {
+      qp.gt_get_column_interval(qp.get_array_descriptor(), query_config, i, variants, 0, stats_ptr, &variant_pool);
+      num_variants += variants.size();
+      query_column_lengths[i] = num_variants;
       queried_column_positions[i * 2] = query_config.get_column_begin(i);
       queried_column_positions[i * 2 + 1] = query_config.get_column_end(i);
+#ifdef DO_PROFILING
+      serialization_timer.start();
+#endif
+      for(const auto& variant : variants)
+        variant.binary_serialize(serialized_buffer, serialized_length);
+#ifdef DO_PROFILING
+      serialization_timer.stop();
+      timings[2u*TIMER_BINARY_SERIALIZATION_IDX] += serialization_timer.get_last_interval_cpu_time();
+      timings[2u*TIMER_BINARY_SERIALIZATION_IDX+1u] += serialization_timer.get_last_interval_wall_clock_time();
+#endif
+      variant_pool.release(variants);
     }
+    if(query_config.get_result_cache_size() > 0u)
+      qp.get_result_cache().print_stats(std::cerr);
 
 #ifdef DO_PROFILING
+    //Serialization is interleaved with the queries - reported separately
     timer.stop();
     timer.get_last_interval_times(timings, TIMER_TILEDB_QUERY_RANGE_IDX);
+    timings[2u*TIMER_TILEDB_QUERY_RANGE_IDX] -= timings[2u*TIMER_BINARY_SERIALIZATION_IDX];
+    timings[2u*TIMER_TILEDB_QUERY_RANGE_IDX+1u] -= timings[2u*TIMER_BINARY_SERIALIZATION_IDX+1u];
 #endif
   }
-#ifdef DO_PROFILING
-  timer.start();
-#endif
-#if VERBOSE>0
-  std::cerr << "[Rank "<< my_world_mpi_rank << " ]: Completed query, obtained "<<variants.size()<<" variants\n";
-#endif
-  //serialized variant data
-  std::vector<uint8_t> serialized_buffer;
-  serialized_buffer.resize(1000000u);       //1MB, arbitrary value - will be resized if necessary by serialization functions
-  uint64_t serialized_length = 0ull;
-  for(const auto& variant : variants)
-    variant.binary_serialize(serialized_buffer, serialized_length);
 #if VERBOSE>0
+  std::cerr << "[Rank "<< my_world_mpi_rank << " ]: Completed query, obtained "<<num_variants<<" variants\n";
   std::cerr << "[Rank "<< my_world_mpi_rank << " ]: Completed serialization, serialized data size "
     << std::fixed << std::setprecision(3) << ((double)serialized_length)/MegaByte  << " MBs\n";
 #endif
 #ifdef DO_PROFILING
-  timer.stop();
-  timer.get_last_interval_times(timings, TIMER_BINARY_SERIALIZATION_IDX);
   //Gather profiling data at root
   auto num_timing_values_per_mpi_process = 2*(TIMER_BINARY_SERIALIZATION_IDX+1);
   std::vector<double> gathered_timings(num_mpi_processes*num_timing_values_per_mpi_process);
@@ -219,12 +233,12 @@ void run_range_query(const VariantQueryProcessor& qp, const VariantQueryConfig&
 
   std::vector<uint64_t> gathered_query_column_lengths(total_columns);
 #ifdef USE_BIGMPI
-  ASSERT(MPIX_Gatherv_x(&(query_column_lengths[0]), num_column_intervals, MPI_UNSIGNED_LONG_LONG,
-    &(gathered_query_column_lengths[0]), &(recvcounts[0]), &(displs[0]), MPI_UNSIGNED_LONG_LONG,
+  ASSERT(MPIX_Gatherv_x(query_column_lengths.data(), num_column_intervals, MPI_UNSIGNED_LONG_LONG,
+    gathered_query_column_lengths.data(), &(recvcounts[0]), &(displs[0]), MPI_UNSIGNED_LONG_LONG,
     0, MPI_COMM_WORLD) == MPI_SUCCESS);
 #else
-  ASSERT(MPI_Gatherv(&(query_column_lengths[0]), num_column_intervals, MPI_UNSIGNED_LONG_LONG,
-    &(gathered_query_column_lengths[0]), &(recvcounts[0]), &(displs[0]), MPI_UNSIGNED_LONG_LONG,
+  ASSERT(MPI_Gatherv(query_column_lengths.data(), num_column_intervals, MPI_UNSIGNED_LONG_LONG,
+    gathered_query_column_lengths.data(), &(recvcounts[0]), &(displs[0]), MPI_UNSIGNED_LONG_LONG,
     0, MPI_COMM_WORLD) == MPI_SUCCESS);
 #endif
 
@@ -242,12 +256,12 @@ void run_range_query(const VariantQueryProcessor& qp, const VariantQueryConfig&
 
   std::vector<uint64_t> gathered_queried_column_positions(total_columns);
 #ifdef USE_BIGMPI
-  ASSERT(MPIX_Gatherv_x(&(queried_column_positions[0]), num_column_intervals * 2, MPI_UNSIGNED_LONG_LONG,
-    &(gathered_queried_column_positions[0]), &(recvcounts[0]), &(displs[0]), MPI_UNSIGNED_LONG_LONG,
+  ASSERT(MPIX_Gatherv_x(queried_column_positions.data(), num_column_intervals * 2, MPI_UNSIGNED_LONG_LONG,
+    gathered_queried_column_positions.data(), &(recvcounts[0]), &(displs[0]), MPI_UNSIGNED_LONG_LONG,
     0, MPI_COMM_WORLD) == MPI_SUCCESS);
 #else
-  ASSERT(MPI_Gatherv(&(queried_column_positions[0]), num_column_intervals * 2, MPI_UNSIGNED_LONG_LONG,
-    &(gathered_queried_column_positions[0]), &(recvcounts[0]), &(displs[0]), MPI_UNSIGNED_LONG_LONG,
+  ASSERT(MPI_Gatherv(queried_column_positions.data(), num_column_intervals * 2, MPI_UNSIGNED_LONG_LONG,
+    gathered_queried_column_positions.data(), &(recvcounts[0]), &(displs[0]), MPI_UNSIGNED_LONG_LONG,
     0, MPI_COMM_WORLD) == MPI_SUCCESS);
 #endif
 
@@ -317,22 +331,62 @@ void scan_and_produce_Broad_GVCF(const VariantQueryProcessor& qp, const VariantQ
   auto serialized_vcf_adapter_ptr = dynamic_cast<VCFSerializedBufferAdapter*>(&vcf_adapter);
   if(serialized_vcf_adapter_ptr)
     serialized_vcf_adapter_ptr->set_buffer(rw_buffer);
+  //Split column intervals so that a single large interval can be scanned by multiple threads
+  VariantQueryConfig split_query_config;
+  auto use_split_intervals = (query_config.get_num_parallel_column_intervals() > 1u && query_config.split_column_intervals()
+      && query_config.get_num_column_intervals() > 0u);
+  if(use_split_intervals)
+    qp.split_column_intervals(qp.get_array_descriptor(), query_config, query_config.get_num_parallel_column_intervals(),
+        split_query_config);
+  const auto& parallel_query_config = use_split_intervals ? split_query_config : query_config;
+  //Multiple column intervals scanned in parallel - per thread operators must be created before gvcf_op modifies the header
+  BroadCombinedGVCFOperatorSet* parallel_gvcf_ops = (query_config.get_num_parallel_column_intervals() > 1u)
+    ? new BroadCombinedGVCFOperatorSet(vcf_adapter, id_mapper, parallel_query_config, query_config.get_num_parallel_column_intervals(),
+        json_scan_config.get_max_diploid_alt_alleles_that_can_be_genotyped())
+    : 0;
   BroadCombinedGVCFOperator gvcf_op(vcf_adapter, id_mapper, query_config, json_scan_config.get_max_diploid_alt_alleles_that_can_be_genotyped());
   Timer timer;
   timer.start();
-  //At least 1 iteration
-  for(auto i=0u;i<std::max(1u, query_config.get_num_column_intervals());++i)
+  if(parallel_gvcf_ops)
   {
-    VariantQueryProcessorScanState scan_state;
-    while(!scan_state.end())
+    //Header
+    if(serialized_vcf_adapter_ptr)
     {
-      qp.scan_and_operate(qp.get_array_descriptor(), query_config, gvcf_op, i, true, &scan_state);
-      if(serialized_vcf_adapter_ptr)
+      serialized_vcf_adapter_ptr->do_output();
+      rw_buffer.m_num_valid_bytes = 0u;
+    }
+    VCFAdapterScanOutputWriter output_writer(vcf_adapter);
+    qp.scan_and_operate_parallel(qp.get_array_descriptor(), parallel_query_config, parallel_gvcf_ops->get_operators(),
+        parallel_gvcf_ops->get_buffers(), output_writer, 0u, std::max(1u, parallel_query_config.get_num_column_intervals()), true);
+    delete parallel_gvcf_ops;
+  }
+  else
+  {
+    //Nearby column intervals are served by a single forward scan
+    auto use_coalesced_intervals = (query_config.coalesce_column_intervals() && query_config.get_num_column_intervals() > 1u);
+    VariantQueryConfig coalesced_query_config;
+    std::vector<ColumnRange> target_intervals;
+    if(use_coalesced_intervals)
+      query_config.coalesce_column_intervals(coalesced_query_config, target_intervals);
+    const auto& scan_query_config = use_coalesced_intervals ? coalesced_query_config : query_config;
+    CoalescedColumnIntervalsOperator coalesced_op(gvcf_op, target_intervals);
+    SingleVariantOperatorBase& scan_op = use_coalesced_intervals
+      ? static_cast<SingleVariantOperatorBase&>(coalesced_op) : static_cast<SingleVariantOperatorBase&>(gvcf_op);
+    //At least 1 iteration
+    for(auto i=0u;i<std::max(1u, scan_query_config.get_num_column_intervals());++i)
+    {
+      VariantQueryProcessorScanState scan_state;
+      while(!scan_state.end())
       {
-        serialized_vcf_adapter_ptr->do_output();
-        rw_buffer.m_num_valid_bytes = 0u;
+        qp.scan_and_operate(qp.get_array_descriptor(), scan_query_config, scan_op, i, true, &scan_state);
+        if(serialized_vcf_adapter_ptr)
+        {
+          serialized_vcf_adapter_ptr->do_output();
+          rw_buffer.m_num_valid_bytes = 0u;
+        }
       }
     }
+    coalesced_op.finalize();
   }
   timer.stop();
   timer.print(std::string("Total scan_and_produce_Broad_GVCF time")+" for rank "+std::to_string(my_world_mpi_rank), std::cerr);
@@ -379,6 +433,57 @@ void print_calls(const VariantQueryProcessor& qp, const VariantQueryConfig& quer
   }
 }
 
+//Cost based distribution of the column intervals of all ranks - every rank counts the cells in an equal share of
+//the queried columns, the counts are summed up and every rank picks its part of the balanced plan
+//Returns false if this rank gets no column intervals
+bool select_balanced_column_intervals(const VariantQueryProcessor& qp, VariantQueryConfig& query_config,
+    int num_mpi_processes, int my_world_mpi_rank, bool skip_query_on_root)
+{
+  //Rank 0 does not query if skip_query_on_root is set
+  auto first_querying_rank = skip_query_on_root ? 1 : 0;
+  if(my_world_mpi_rank >= num_mpi_processes || num_mpi_processes <= first_querying_rank)
+  {
+    std::cerr << "Cannot balance column intervals across "<<num_mpi_processes<<" processes for rank "<<my_world_mpi_rank<<"\n";
+    exit(-1);
+  }
+  auto num_queried_columns = query_config.get_num_queried_columns();
+  if(num_queried_columns == 0ull)
+    return true;
+  auto num_parts = static_cast<unsigned>(num_mpi_processes - first_querying_rank);
+  auto num_bins = static_cast<unsigned>(std::min<uint64_t>(num_queried_columns,
+        static_cast<uint64_t>(DEFAULT_BALANCE_COLUMN_INTERVALS_NUM_BINS_PER_PART)*num_parts));
+  UniformHistogram histogram(0ull, num_queried_columns-1ull, num_bins);
+  auto num_columns_per_rank = num_queried_columns/num_mpi_processes;
+  qp.fill_cell_count_histogram(qp.get_array_descriptor(), query_config, histogram,
+      num_columns_per_rank*my_world_mpi_rank,
+      (my_world_mpi_rank+1 == num_mpi_processes) ? num_queried_columns : num_columns_per_rank*(my_world_mpi_rank+1));
+  //Histograms of all ranks have the same serialized size
+  uint8_t* serialized_histogram = 0;
+  auto serialized_length = histogram.serialize(serialized_histogram, 0ull);
+  std::vector<uint8_t> gathered_histograms(serialized_length*num_mpi_processes);
+  ASSERT(MPI_Allgather(serialized_histogram, serialized_length, MPI_UNSIGNED_CHAR, &(gathered_histograms[0]),
+        serialized_length, MPI_UNSIGNED_CHAR, MPI_COMM_WORLD) == MPI_SUCCESS);
+  free(serialized_histogram);
+  UniformHistogram combined_histogram(0ull, num_queried_columns-1ull, num_bins);
+  for(auto i=0;i<num_mpi_processes;++i)
+  {
+    UniformHistogram rank_histogram(0ull, num_queried_columns-1ull, num_bins);
+    rank_histogram.deserialize(&(gathered_histograms[0]), serialized_length*i);
+    combined_histogram.sum_up_histogram(rank_histogram);
+  }
+  std::vector<std::vector<ColumnRange>> parts;
+  qp.balance_column_intervals(qp.get_array_descriptor(), query_config, combined_histogram, num_parts, parts);
+  if(my_world_mpi_rank < first_querying_rank)
+    return true;
+  auto& my_column_intervals = parts[my_world_mpi_rank - first_querying_rank];
+#if VERBOSE>0
+  std::cerr << "[Rank "<< my_world_mpi_rank << " ]: Estimated #cells "<<combined_histogram.get_total()
+    <<" #column intervals after balancing "<<my_column_intervals.size()<<"\n";
+#endif
+  query_config.set_column_intervals_to_query(my_column_intervals);
+  return !(my_column_intervals.empty());
+}
+
 void produce_column_histogram(const VariantQueryProcessor& qp, const VariantQueryConfig& query_config, uint64_t bin_size,
     const std::vector<uint64_t>& num_equi_load_bins)
 {
@@ -507,6 +612,11 @@ int main(int argc, char *argv[]) {
   JSONVCFAdapterQueryConfig scan_config;
 #endif
   //If JSON file specified, read workspace, array_name, rows/columns/fields to query from JSON file
+  auto balance_column_intervals_across_ranks = false;
+  //With "merge_array_partitions", all the partitions are read through one merged iterator
+  std::vector<std::string> partition_array_names;
+  std::vector<ColumnRange> partition_column_ranges;
+  std::vector<RowRange> partition_row_ranges;
   if(json_config_file != "")
   {
     JSONBasicQueryConfig* json_config_ptr = 0;
@@ -528,8 +638,15 @@ int main(int argc, char *argv[]) {
         break;
     }
     ASSERT(json_config_ptr);
+    balance_column_intervals_across_ranks = json_config_ptr->balance_column_intervals_across_ranks();
     workspace = json_config_ptr->get_workspace(my_world_mpi_rank);
     array_name = json_config_ptr->get_array_name(my_world_mpi_rank);
+    if(json_config_ptr->merge_array_partitions())
+    {
+      partition_array_names = json_config_ptr->get_array_names();
+      partition_column_ranges = json_config_ptr->get_array_column_partitions();
+      partition_row_ranges = json_config_ptr->get_array_row_partitions();
+    }
   }
   else
   {
@@ -573,29 +690,44 @@ int main(int argc, char *argv[]) {
   /*Create storage manager*/
   VariantStorageManager sm(workspace, segment_size);
   /*Create query processor*/
-  VariantQueryProcessor qp(&sm, array_name);
+  if(partition_array_names.empty())
+    partition_array_names.push_back(array_name);
+  VariantQueryProcessor qp(&sm, partition_array_names);
+  for(auto i=0ull;i<partition_column_ranges.size();++i)
+    sm.set_column_partition(qp.get_partition_array_descriptors()[i], partition_column_ranges[i]);
+  for(auto i=0ull;i<partition_row_ranges.size();++i)
+    sm.set_row_partition(qp.get_partition_array_descriptors()[i], partition_row_ranges[i]);
   auto require_alleles = ((command_idx == COMMAND_RANGE_QUERY)
       || (command_idx == COMMAND_PRODUCE_BROAD_GVCF));
   qp.do_query_bookkeeping(qp.get_array_schema(), query_config, id_mapper, require_alleles);
+  //With no column intervals, scans cover the whole array - ranks without a share of the balanced column intervals
+  //only take part in the collective operations of the range query
+  auto has_column_intervals = true;
+  if(balance_column_intervals_across_ranks)
+    has_column_intervals = select_balanced_column_intervals(qp, query_config, num_mpi_processes, my_world_mpi_rank,
+        skip_query_on_root);
   switch(command_idx)
   {
     case COMMAND_RANGE_QUERY:
       run_range_query(qp, query_config, static_cast<const VidMapper&>(id_mapper), output_format,
           (loader_json_config_file.empty() || loader_config.is_partitioned_by_column()),
-          num_mpi_processes, my_world_mpi_rank, skip_query_on_root);
+          num_mpi_processes, my_world_mpi_rank, skip_query_on_root, has_column_intervals);
       break;
     case COMMAND_PRODUCE_BROAD_GVCF:
 #if defined(HTSDIR)
-      scan_and_produce_Broad_GVCF(qp, query_config, vcf_adapter, static_cast<const VidMapper&>(id_mapper), scan_config,
-          num_mpi_processes, my_world_mpi_rank, skip_query_on_root);
+      if(has_column_intervals)
+        scan_and_produce_Broad_GVCF(qp, query_config, vcf_adapter, static_cast<const VidMapper&>(id_mapper), scan_config,
+            num_mpi_processes, my_world_mpi_rank, skip_query_on_root);
 #endif
       break;
     case COMMAND_PRODUCE_HISTOGRAM:
-      produce_column_histogram(qp, query_config, 100, std::vector<uint64_t>({ 128, 64, 32, 16, 8, 4, 2 }));
+      if(has_column_intervals)
+        produce_column_histogram(qp, query_config, 100, std::vector<uint64_t>({ 128, 64, 32, 16, 8, 4, 2 }));
       break;
     case COMMAND_PRINT_CALLS:
     case COMMAND_PRINT_CSV:
-      print_calls(qp, query_config, command_idx, static_cast<const VidMapper&>(id_mapper));
+      if(has_column_intervals)
+        print_calls(qp, query_config, command_idx, static_cast<const VidMapper&>(id_mapper));
       break;
   }
 #ifdef USE_GPERFTOOLS